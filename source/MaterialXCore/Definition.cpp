@@ -163,7 +163,7 @@ ConstNodeDefPtr Implementation::getDeclaration(const string&) const
 vector<UnitDefPtr> UnitTypeDef::getUnitDefs() const
 {
     vector<UnitDefPtr> unitDefs;
-    for (UnitDefPtr unitDef : getDocument()->getChildrenOfType<UnitDef>())
+    for (UnitDefPtr unitDef : getDocument()->getUnitDefs())
     {
         if (unitDef->getUnitType() == _name)
         {
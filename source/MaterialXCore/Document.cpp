@@ -7,7 +7,10 @@
 
 #include <MaterialXCore/Util.h>
 
+#include <atomic>
 #include <mutex>
+#include <thread>
+#include <unordered_set>
 
 namespace MaterialX
 {
@@ -31,15 +34,43 @@ template<class T> shared_ptr<T> updateChildSubclass(ElementPtr parent, ElementPt
     return newChild;
 }
 
+// Copy the content of a top-level library element into the given element,
+// transferring any scoped attributes from the library document.
+void copyLibraryElement(ConstElementPtr child, ElementPtr childCopy, ConstDocumentPtr library,
+                        const CopyOptions* copyOptions = nullptr)
+{
+    childCopy->copyContentFrom(child, copyOptions);
+    if (!childCopy->hasFilePrefix() && library->hasFilePrefix())
+    {
+        childCopy->setFilePrefix(library->getFilePrefix());
+    }
+    if (!childCopy->hasGeomPrefix() && library->hasGeomPrefix())
+    {
+        childCopy->setGeomPrefix(library->getGeomPrefix());
+    }
+    if (!childCopy->hasColorSpace() && library->hasColorSpace())
+    {
+        childCopy->setColorSpace(library->getColorSpace());
+    }
+    if (!childCopy->hasNamespace() && library->hasNamespace())
+    {
+        childCopy->setNamespace(library->getNamespace());
+    }
+    if (!childCopy->hasSourceUri() && library->hasSourceUri())
+    {
+        childCopy->setSourceUri(library->getSourceUri());
+    }
+}
+
 } // anonymous namespace
 
 //
 // Document factory function
 //
 
-DocumentPtr createDocument()
+DocumentPtr createDocument(bool useArena)
 {
-    return Document::createDocument<Document>();
+    return Document::createDocument<Document>(useArena);
 }
 
 //
@@ -50,13 +81,77 @@ class Document::Cache
 {
   public:
     Cache() :
-        valid(false)
+        valid(false),
+        current(false)
     {
     }
     ~Cache() { }
 
+    // Mark the cache as requiring a full rebuild on its next refresh.
+    void invalidate()
+    {
+        valid = false;
+        current = false;
+        dirtyElements.clear();
+        dirtySet.clear();
+    }
+
+    // Mark the cache entries of the given element as requiring an update on
+    // the next refresh.
+    void markDirty(ElementPtr elem)
+    {
+        if (valid && dirtySet.insert(elem.get()).second)
+        {
+            dirtyElements.push_back(elem);
+            current = false;
+        }
+    }
+
+    // Mark the cache entries of the given element and all of its descendants
+    // as requiring an update on the next refresh.
+    void markSubtreeDirty(ElementPtr elem)
+    {
+        if (!valid)
+        {
+            return;
+        }
+        if (elem->isA<Document>())
+        {
+            invalidate();
+            return;
+        }
+        for (ElementPtr descendant : elem->traverseTree())
+        {
+            markDirty(descendant);
+        }
+    }
+
+    // Mark the cache entries affected by a change to the given attribute as
+    // requiring an update on the next refresh.
+    void markAttributeDirty(ElementPtr elem, const string& attrib)
+    {
+        if (attrib == PortElement::NODE_NAME_ATTRIBUTE ||
+            attrib == NodeDef::NODE_ATTRIBUTE ||
+            attrib == InterfaceElement::NODE_DEF_ATTRIBUTE)
+        {
+            markDirty(elem);
+        }
+        else if (attrib == Element::NAMESPACE_ATTRIBUTE)
+        {
+            markSubtreeDirty(elem);
+        }
+    }
+
     void refresh()
     {
+        // Skip synchronization when the cache is already up to date, allowing
+        // concurrent readers of an unmodified document to proceed without
+        // contention.
+        if (current.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
         // Thread synchronization for multiple concurrent readers of a single document.
         std::lock_guard<std::mutex> guard(mutex);
 
@@ -66,57 +161,157 @@ class Document::Cache
             portElementMap.clear();
             nodeDefMap.clear();
             implementationMap.clear();
+            entryKeys.clear();
 
             // Traverse the document to build a new cache.
             for (ElementPtr elem : doc.lock()->traverseTree())
             {
-                const string& nodeName = elem->getAttribute(PortElement::NODE_NAME_ATTRIBUTE);
-                const string& nodeString = elem->getAttribute(NodeDef::NODE_ATTRIBUTE);
-                const string& nodeDefString = elem->getAttribute(InterfaceElement::NODE_DEF_ATTRIBUTE);
+                addEntries(elem);
+            }
 
-                if (!nodeName.empty())
-                {
-                    PortElementPtr portElem = elem->asA<PortElement>();
-                    if (portElem)
-                    {
-                        portElementMap.insert(std::pair<string, PortElementPtr>(
-                            portElem->getQualifiedName(nodeName),
-                            portElem));
-                    }
-                }
-                if (!nodeString.empty())
-                {
-                    NodeDefPtr nodeDef = elem->asA<NodeDef>();
-                    if (nodeDef)
-                    {
-                        nodeDefMap.insert(std::pair<string, NodeDefPtr>(
-                            nodeDef->getQualifiedName(nodeString),
-                            nodeDef));
-                    }
-                }
-                if (!nodeDefString.empty())
+            valid = true;
+        }
+        else if (!dirtyElements.empty())
+        {
+            // Update only the entries of elements that have changed since
+            // the last refresh.
+            DocumentPtr document = doc.lock();
+            for (ElementPtr elem : dirtyElements)
+            {
+                removeEntries(elem);
+                if (isInDocument(elem, document))
                 {
-                    InterfaceElementPtr interface = elem->asA<InterfaceElement>();
-                    if (interface && (interface->isA<Implementation>() || interface->isA<NodeGraph>()))
-                    {
-                        implementationMap.insert(std::pair<string, InterfaceElementPtr>(
-                            interface->getQualifiedName(nodeDefString),
-                            interface));
-                    }
+                    addEntries(elem);
                 }
             }
+            dirtyElements.clear();
+            dirtySet.clear();
+        }
 
-            valid = true;
+        // Publish the updated cache to readers that skip synchronization.
+        current.store(true, std::memory_order_release);
+    }
+
+  private:
+    // The cache keys under which an element has been stored.
+    struct EntryKeys
+    {
+        string portElementKey;
+        string nodeDefKey;
+        string implementationKey;
+    };
+
+    // Add cache entries for the given element, based on its current content.
+    void addEntries(ElementPtr elem)
+    {
+        const string& nodeName = elem->getAttribute(PortElement::NODE_NAME_ATTRIBUTE);
+        const string& nodeString = elem->getAttribute(NodeDef::NODE_ATTRIBUTE);
+        const string& nodeDefString = elem->getAttribute(InterfaceElement::NODE_DEF_ATTRIBUTE);
+        if (nodeName.empty() && nodeString.empty() && nodeDefString.empty())
+        {
+            return;
+        }
+
+        EntryKeys keys;
+        if (!nodeName.empty())
+        {
+            PortElementPtr portElem = elem->asA<PortElement>();
+            if (portElem)
+            {
+                keys.portElementKey = portElem->getQualifiedName(nodeName);
+                portElementMap.insert(std::pair<string, PortElementPtr>(
+                    keys.portElementKey,
+                    portElem));
+            }
+        }
+        if (!nodeString.empty())
+        {
+            NodeDefPtr nodeDef = elem->asA<NodeDef>();
+            if (nodeDef)
+            {
+                keys.nodeDefKey = nodeDef->getQualifiedName(nodeString);
+                nodeDefMap.insert(std::pair<string, NodeDefPtr>(
+                    keys.nodeDefKey,
+                    nodeDef));
+            }
+        }
+        if (!nodeDefString.empty())
+        {
+            InterfaceElementPtr interface = elem->asA<InterfaceElement>();
+            if (interface && (interface->isA<Implementation>() || interface->isA<NodeGraph>()))
+            {
+                keys.implementationKey = interface->getQualifiedName(nodeDefString);
+                implementationMap.insert(std::pair<string, InterfaceElementPtr>(
+                    keys.implementationKey,
+                    interface));
+            }
+        }
+        if (!keys.portElementKey.empty() || !keys.nodeDefKey.empty() || !keys.implementationKey.empty())
+        {
+            entryKeys[elem.get()] = keys;
         }
     }
 
+    // Remove all cache entries previously added for the given element.
+    void removeEntries(ElementPtr elem)
+    {
+        auto it = entryKeys.find(elem.get());
+        if (it == entryKeys.end())
+        {
+            return;
+        }
+        removeEntry(portElementMap, it->second.portElementKey, elem);
+        removeEntry(nodeDefMap, it->second.nodeDefKey, elem);
+        removeEntry(implementationMap, it->second.implementationKey, elem);
+        entryKeys.erase(it);
+    }
+
+    template<class T> static void removeEntry(std::unordered_multimap<string, shared_ptr<T>>& map,
+                                              const string& key, ElementPtr elem)
+    {
+        if (key.empty())
+        {
+            return;
+        }
+        auto keyRange = map.equal_range(key);
+        for (auto it = keyRange.first; it != keyRange.second; ++it)
+        {
+            if (it->second == elem)
+            {
+                map.erase(it);
+                return;
+            }
+        }
+    }
+
+    // Return true if the given element is currently connected to the given
+    // document through its chain of parents.
+    static bool isInDocument(ConstElementPtr elem, ConstDocumentPtr document)
+    {
+        for (ConstElementPtr parent = elem->getParent(); parent; parent = parent->getParent())
+        {
+            if (parent->getChild(elem->getName()) != elem)
+            {
+                return false;
+            }
+            elem = parent;
+        }
+        return elem == document;
+    }
+
   public:
     weak_ptr<Document> doc;
     std::mutex mutex;
     bool valid;
+    std::atomic<bool> current;
     std::unordered_multimap<string, PortElementPtr> portElementMap;
     std::unordered_multimap<string, NodeDefPtr> nodeDefMap;
     std::unordered_multimap<string, InterfaceElementPtr> implementationMap;
+
+  private:
+    std::unordered_map<const Element*, EntryKeys> entryKeys;
+    vector<ElementPtr> dirtyElements;
+    std::unordered_set<const Element*> dirtySet;
 };
 
 //
@@ -125,12 +320,14 @@ class Document::Cache
 
 Document::Document(ElementPtr parent, const string& name) :
     GraphElement(parent, CATEGORY, name),
-    _cache(std::unique_ptr<Cache>(new Cache))
+    _cache(std::unique_ptr<Cache>(new Cache)),
+    _dataLibraryUseCount(0)
 {
 }
 
 Document::~Document()
 {
+    setDataLibrary(nullptr);
 }
 
 void Document::initialize()
@@ -164,27 +361,7 @@ void Document::importLibrary(const ConstDocumentPtr& library, const CopyOptions*
 
         // Create the imported element.
         ElementPtr childCopy = addChildOfCategory(child->getCategory(), childName, !previous);
-        childCopy->copyContentFrom(child, copyOptions);
-        if (!childCopy->hasFilePrefix() && library->hasFilePrefix())
-        {
-            childCopy->setFilePrefix(library->getFilePrefix());
-        }
-        if (!childCopy->hasGeomPrefix() && library->hasGeomPrefix())
-        {
-            childCopy->setGeomPrefix(library->getGeomPrefix());
-        }
-        if (!childCopy->hasColorSpace() && library->hasColorSpace())
-        {
-            childCopy->setColorSpace(library->getColorSpace());
-        }
-        if (!childCopy->hasNamespace() && library->hasNamespace())
-        {
-            childCopy->setNamespace(library->getNamespace());
-        }
-        if (!childCopy->hasSourceUri() && library->hasSourceUri())
-        {
-            childCopy->setSourceUri(library->getSourceUri());
-        }
+        copyLibraryElement(child, childCopy, library, copyOptions);
 
         // Check for conflicting elements.
         if (previous && *previous != *childCopy)
@@ -194,6 +371,33 @@ void Document::importLibrary(const ConstDocumentPtr& library, const CopyOptions*
     }
 }
 
+ElementPtr Document::localizeElement(const string& name)
+{
+    ElementPtr child = getChild(name);
+    if (child || !_dataLibrary)
+    {
+        return child;
+    }
+
+    // Find the library, possibly nested, that owns the named element.
+    ConstDocumentPtr library = _dataLibrary;
+    ConstElementPtr libraryChild = library->getChild(name);
+    while (!libraryChild && library->hasDataLibrary())
+    {
+        library = library->getDataLibrary();
+        libraryChild = library->getChild(name);
+    }
+    if (!libraryChild)
+    {
+        return ElementPtr();
+    }
+
+    // Copy the element into this document.
+    child = addChildOfCategory(libraryChild->getCategory(), name);
+    copyLibraryElement(libraryChild, child, library);
+    return child;
+}
+
 StringSet Document::getReferencedSourceUris() const
 {
     StringSet sourceUris;
@@ -264,6 +468,18 @@ vector<NodeDefPtr> Document::getMatchingNodeDefs(const string& nodeName) const
         nodeDefs.push_back(it->second);
     }
 
+    // Append matches from the data library that are not shadowed locally.
+    if (_dataLibrary)
+    {
+        for (NodeDefPtr nodeDef : _dataLibrary->getMatchingNodeDefs(nodeName))
+        {
+            if (!getChild(nodeDef->getName()))
+            {
+                nodeDefs.push_back(nodeDef);
+            }
+        }
+    }
+
     // Return the matches.
     return nodeDefs;
 }
@@ -281,15 +497,98 @@ vector<InterfaceElementPtr> Document::getMatchingImplementations(const string& n
         implementations.push_back(it->second);
     }
 
+    // Append matches from the data library that are not shadowed locally.
+    if (_dataLibrary)
+    {
+        for (InterfaceElementPtr implementation : _dataLibrary->getMatchingImplementations(nodeDef))
+        {
+            if (!getChild(implementation->getName()))
+            {
+                implementations.push_back(implementation);
+            }
+        }
+    }
+
     // Return the matches.
     return implementations;
 }
 
 bool Document::validate(string* message) const
+{
+    return validate(message, 1);
+}
+
+bool Document::validate(string* message, unsigned int threadCount) const
 {
     bool res = true;
     validateRequire(hasVersionString(), res, message, "Missing version string");
-    return GraphElement::validate(message) && res;
+
+    const vector<ElementPtr>& children = getChildren();
+    if (!threadCount)
+    {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    threadCount = (unsigned int) std::min((size_t) threadCount, children.size());
+    if (threadCount <= 1)
+    {
+        return GraphElement::validate(message) && res;
+    }
+
+    // Bring the caches of this document and its data libraries up to date,
+    // so that worker threads only read from them.
+    for (const Document* doc = this; doc; doc = doc->_dataLibrary.get())
+    {
+        doc->_cache->refresh();
+    }
+
+    // Validate top-level children across worker threads, with each child
+    // collecting its messages in its own buffer.
+    vector<char> childResults(children.size());
+    vector<string> childMessages(children.size());
+    vector<std::exception_ptr> childErrors(children.size());
+    std::atomic<size_t> nextChild(0);
+    auto validateChildren = [&]()
+    {
+        for (size_t i = nextChild++; i < children.size(); i = nextChild++)
+        {
+            try
+            {
+                childResults[i] = children[i]->validate(message ? &childMessages[i] : nullptr);
+            }
+            catch (...)
+            {
+                childErrors[i] = std::current_exception();
+            }
+        }
+    };
+    vector<std::thread> threads;
+    for (unsigned int i = 1; i < threadCount; i++)
+    {
+        threads.emplace_back(validateChildren);
+    }
+    validateChildren();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    for (const std::exception_ptr& error : childErrors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    // Merge the results in document order, matching the output of a serial
+    // validation.
+    return validateElement(message, [&](size_t index, string* childMessage)
+    {
+        if (childMessage)
+        {
+            *childMessage += childMessages[index];
+        }
+        return childResults[index] != 0;
+    }) && res;
 }
 
 void Document::upgradeVersion(int desiredMajorVersion, int desiredMinorVersion)
@@ -1025,34 +1324,34 @@ bool Document::convertMaterialsToNodes(bool replaceNodes)
     return modified;
 }
 
-void Document::onAddElement(ElementPtr, ElementPtr)
+void Document::onAddElement(ElementPtr, ElementPtr elem)
 {
-    _cache->valid = false;
+    _cache->markSubtreeDirty(elem);
 }
 
-void Document::onRemoveElement(ElementPtr, ElementPtr)
+void Document::onRemoveElement(ElementPtr, ElementPtr elem)
 {
-    _cache->valid = false;
+    _cache->markSubtreeDirty(elem);
 }
 
-void Document::onSetAttribute(ElementPtr, const string&, const string&)
+void Document::onSetAttribute(ElementPtr elem, const string& attrib, const string&)
 {
-    _cache->valid = false;
+    _cache->markAttributeDirty(elem, attrib);
 }
 
-void Document::onRemoveAttribute(ElementPtr, const string&)
+void Document::onRemoveAttribute(ElementPtr elem, const string& attrib)
 {
-    _cache->valid = false;
+    _cache->markAttributeDirty(elem, attrib);
 }
 
-void Document::onCopyContent(ElementPtr)
+void Document::onCopyContent(ElementPtr elem)
 {
-    _cache->valid = false;
+    _cache->markSubtreeDirty(elem);
 }
 
-void Document::onClearContent(ElementPtr)
+void Document::onClearContent(ElementPtr elem)
 {
-    _cache->valid = false;
+    _cache->markSubtreeDirty(elem);
 }
 
 } // namespace MaterialX
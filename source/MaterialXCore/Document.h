@@ -38,9 +38,26 @@ class Document : public GraphElement
     virtual ~Document();
 
     /// Create a new document of the given subclass.
-    template <class T> static shared_ptr<T> createDocument()
-    {
-        shared_ptr<T> doc = std::make_shared<T>(ElementPtr(), EMPTY_STRING);
+    /// @param useArena If true, then the document and all of its elements
+    ///    are allocated from a document-scoped ElementArena, packing element
+    ///    objects and their reference counts together in memory.  The child
+    ///    maps, child vectors and attributes of elements still use the
+    ///    default allocator, and elements are destroyed one by one, so the
+    ///    cost of releasing the document is unchanged.  Defaults to false.
+    template <class T> static shared_ptr<T> createDocument(bool useArena = false)
+    {
+        shared_ptr<T> doc;
+        if (useArena)
+        {
+            ElementArenaPtr arena = std::make_shared<ElementArena>();
+            doc = std::allocate_shared<T>(ElementAllocator<T>(arena), ElementPtr(), EMPTY_STRING);
+            static_cast<Document&>(*doc)._arena = arena;
+            static_cast<Document&>(*doc)._elementArena = arena.get();
+        }
+        else
+        {
+            doc = std::make_shared<T>(ElementPtr(), EMPTY_STRING);
+        }
         doc->initialize();
         return doc;
     }
@@ -51,23 +68,102 @@ class Document : public GraphElement
     /// Create a deep copy of the document.
     virtual DocumentPtr copy() const
     {
-        DocumentPtr doc = createDocument<Document>();
+        DocumentPtr doc = createDocument<Document>(_arena != nullptr);
         doc->copyContentFrom(getSelf());
+        doc->setDataLibrary(getDataLibrary());
         return doc;
     }
 
     /// Import the given document as a library within this document.
     /// The contents of the library document are copied into this one, and
     /// are assigned the source URI of the library.
+    /// To share a library between documents without copying its contents,
+    /// use setDataLibrary instead.
     /// @param library The library document to be imported.
     /// @param copyOptions An optional pointer to a CopyOptions object.
     ///    If provided, then the given options will affect the behavior of the
     ///    import function.  Defaults to a null pointer.
     void importLibrary(const ConstDocumentPtr& library, const CopyOptions* copyOptions = nullptr);
 
+    /// Return the element arena from which the elements of this document are
+    /// allocated, or an empty shared pointer if the document was created
+    /// without an arena.
+    const ElementArenaPtr& getElementArena() const
+    {
+        return _arena;
+    }
+
     /// Get a list of source URI's referenced by the document
     StringSet getReferencedSourceUris() const;
 
+    /// @name Data Library
+    /// @{
+
+    /// Set the data library for this document.
+    ///
+    /// A data library is a shared, read-only document whose definitions are
+    /// visible through this document without being copied into it.  Lookups
+    /// of nodegraphs, nodedefs, implementations, typedefs, unitdefs,
+    /// unittypedefs and geompropdefs fall through to the data library when
+    /// no local element with the requested name exists, so that a single
+    /// library document may be shared by any number of documents.  While a
+    /// document is in use as a data library, attempts to modify its elements
+    /// throw an exception; use localizeElement to edit a local copy.
+    /// @param dataLibrary The data library document, or an empty shared
+    ///    pointer to clear the current data library.
+    /// @throws Exception if the data library is this document, or has this
+    ///    document in its own chain of data libraries.
+    void setDataLibrary(ConstDocumentPtr dataLibrary)
+    {
+        for (ConstDocumentPtr library = dataLibrary; library; library = library->_dataLibrary)
+        {
+            if (library.get() == this)
+            {
+                throw Exception("Data library of document '" + getName() + "' would form a cycle");
+            }
+        }
+        if (dataLibrary)
+        {
+            dataLibrary->_dataLibraryUseCount++;
+        }
+        if (_dataLibrary)
+        {
+            _dataLibrary->_dataLibraryUseCount--;
+        }
+        _dataLibrary = dataLibrary;
+    }
+
+    /// Return the data library, if any, for this document.
+    ConstDocumentPtr getDataLibrary() const
+    {
+        return _dataLibrary;
+    }
+
+    /// Return true if this document has a data library.
+    bool hasDataLibrary() const
+    {
+        return _dataLibrary != nullptr;
+    }
+
+    /// Return true if this document is the data library of any other
+    /// document, in which case its elements may not be modified.
+    bool isSharedDataLibrary() const
+    {
+        return _dataLibraryUseCount > 0;
+    }
+
+    /// Copy the top-level element with the given name from the data library
+    /// into this document, so that it may be edited.  The local copy shadows
+    /// the element of the same name in the data library, which is left
+    /// unmodified.  If a local element with the given name already exists,
+    /// then it is returned without copying.
+    /// @param name The name of the element to be copied.
+    /// @return The local element, or an empty shared pointer if no element
+    ///    with the given name exists in this document or its data library.
+    ElementPtr localizeElement(const string& name);
+
+    /// @}
+
     /// @name NodeGraph Elements
     /// @{
 
@@ -84,13 +180,13 @@ class Document : public GraphElement
     /// Return the NodeGraph, if any, with the given name.
     NodeGraphPtr getNodeGraph(const string& name) const
     {
-        return getChildOfType<NodeGraph>(name);
+        return getLibraryChildOfType<NodeGraph>(name);
     }
 
     /// Return a vector of all NodeGraph elements in the document.
     vector<NodeGraphPtr> getNodeGraphs() const
     {
-        return getChildrenOfType<NodeGraph>();
+        return getLibraryChildrenOfType<NodeGraph>();
     }
 
     /// Remove the NodeGraph, if any, with the given name.
@@ -208,13 +304,13 @@ class Document : public GraphElement
     /// Return the GeomPropDef, if any, with the given name.
     GeomPropDefPtr getGeomPropDef(const string& name) const
     {
-        return getChildOfType<GeomPropDef>(name);
+        return getLibraryChildOfType<GeomPropDef>(name);
     }
 
     /// Return a vector of all GeomPropDef elements in the document.
     vector<GeomPropDefPtr> getGeomPropDefs() const
     {
-        return getChildrenOfType<GeomPropDef>();
+        return getLibraryChildrenOfType<GeomPropDef>();
     }
 
     /// Remove the GeomPropDef, if any, with the given name.
@@ -336,13 +432,13 @@ class Document : public GraphElement
     /// Return the TypeDef, if any, with the given name.
     TypeDefPtr getTypeDef(const string& name) const
     {
-        return getChildOfType<TypeDef>(name);
+        return getLibraryChildOfType<TypeDef>(name);
     }
 
     /// Return a vector of all TypeDef elements in the document.
     vector<TypeDefPtr> getTypeDefs() const
     {
-        return getChildrenOfType<TypeDef>();
+        return getLibraryChildrenOfType<TypeDef>();
     }
 
     /// Remove the TypeDef, if any, with the given name.
@@ -381,13 +477,13 @@ class Document : public GraphElement
     /// Return the NodeDef, if any, with the given name.
     NodeDefPtr getNodeDef(const string& name) const
     {
-        return getChildOfType<NodeDef>(name);
+        return getLibraryChildOfType<NodeDef>(name);
     }
 
     /// Return a vector of all NodeDef elements in the document.
     vector<NodeDefPtr> getNodeDefs() const
     {
-        return getChildrenOfType<NodeDef>();
+        return getLibraryChildrenOfType<NodeDef>();
     }
 
     /// Remove the NodeDef, if any, with the given name.
@@ -480,13 +576,13 @@ class Document : public GraphElement
     /// Return the Implementation, if any, with the given name.
     ImplementationPtr getImplementation(const string& name) const
     {
-        return getChildOfType<Implementation>(name);
+        return getLibraryChildOfType<Implementation>(name);
     }
 
     /// Return a vector of all Implementation elements in the document.
     vector<ImplementationPtr> getImplementations() const
     {
-        return getChildrenOfType<Implementation>();
+        return getLibraryChildrenOfType<Implementation>();
     }
 
     /// Remove the Implementation, if any, with the given name.
@@ -516,13 +612,13 @@ class Document : public GraphElement
     /// Return the UnitDef, if any, with the given name.
     UnitDefPtr getUnitDef(const string& name) const
     {
-        return getChildOfType<UnitDef>(name);
+        return getLibraryChildOfType<UnitDef>(name);
     }
 
     /// Return a vector of all Member elements in the TypeDef.
     vector<UnitDefPtr> getUnitDefs() const
     {
-        return getChildrenOfType<UnitDef>();
+        return getLibraryChildrenOfType<UnitDef>();
     }
 
     /// Remove the UnitDef, if any, with the given name.
@@ -547,13 +643,13 @@ class Document : public GraphElement
     /// Return the UnitTypeDef, if any, with the given name.
     UnitTypeDefPtr getUnitTypeDef(const string& name) const
     {
-        return getChildOfType<UnitTypeDef>(name);
+        return getLibraryChildOfType<UnitTypeDef>(name);
     }
 
     /// Return a vector of all UnitTypeDef elements in the document.
     vector<UnitTypeDefPtr> getUnitTypeDefs() const
     {
-        return getChildrenOfType<UnitTypeDef>();
+        return getLibraryChildrenOfType<UnitTypeDef>();
     }
 
     /// Remove the UnitTypeDef, if any, with the given name.
@@ -631,6 +727,18 @@ class Document : public GraphElement
     /// @return True if the document passes all tests, false otherwise.
     bool validate(string* message = nullptr) const override;
 
+    /// Validate that the given document is consistent with the MaterialX
+    /// specification, distributing the validation of top-level elements
+    /// across the given number of threads.  The document must not be
+    /// modified during validation, and the output message is identical
+    /// to that of a serial validation.
+    /// @param message An optional output string, to which a description of
+    ///    each error will be appended.
+    /// @param threadCount The number of threads to use, where zero selects
+    ///    the number of hardware threads available.
+    /// @return True if the document passes all tests, false otherwise.
+    bool validate(string* message, unsigned int threadCount) const;
+
     /// @}
     /// @name Callbacks
     /// @{
@@ -678,9 +786,43 @@ class Document : public GraphElement
     static const string CMS_ATTRIBUTE;
     static const string CMS_CONFIG_ATTRIBUTE;
 
+  protected:
+    // Return the child element, if any, with the given name and subclass,
+    // falling through to the data library if no local child exists.
+    template<class T> shared_ptr<T> getLibraryChildOfType(const string& name) const
+    {
+        ElementPtr child = getChild(name);
+        if (!child && _dataLibrary)
+        {
+            return _dataLibrary->getLibraryChildOfType<T>(name);
+        }
+        return child ? child->asA<T>() : shared_ptr<T>();
+    }
+
+    // Return all child elements of the given subclass, followed by those of
+    // the data library that are not shadowed by local children.
+    template<class T> vector<shared_ptr<T>> getLibraryChildrenOfType() const
+    {
+        vector<shared_ptr<T>> children = getChildrenOfType<T>();
+        if (_dataLibrary)
+        {
+            for (shared_ptr<T> child : _dataLibrary->getLibraryChildrenOfType<T>())
+            {
+                if (!getChild(child->getName()))
+                {
+                    children.push_back(child);
+                }
+            }
+        }
+        return children;
+    }
+
   private:
     class Cache;
     std::unique_ptr<Cache> _cache;
+    ConstDocumentPtr _dataLibrary;
+    mutable std::atomic<unsigned int> _dataLibraryUseCount;
+    ElementArenaPtr _arena;
 };
 
 /// @class ScopedUpdate
@@ -728,8 +870,11 @@ class ScopedDisableCallbacks
 };
 
 /// Create a new Document.
+/// @param useArena If true, then all elements of the document are allocated
+///    from a document-scoped arena, improving the locality of traversals.
+///    Defaults to false.
 /// @relates Document
-DocumentPtr createDocument();
+DocumentPtr createDocument(bool useArena = false);
 
 } // namespace MaterialX
 
@@ -9,6 +9,12 @@
 #include <MaterialXCore/Node.h>
 #include <MaterialXCore/Util.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <mutex>
+#include <unordered_set>
+
 namespace MaterialX
 {
 
@@ -42,24 +48,195 @@ const string ValueElement::UNITTYPE_ATTRIBUTE = "unittype";
 
 Element::CreatorMap Element::_creatorMap;
 
+namespace {
+
+const uint64_t HASH_OFFSET_BASIS = 0xcbf29ce484222325ull;
+const uint64_t HASH_PRIME = 0x100000001b3ull;
+
+// Combine the given string into a 64-bit FNV-1a hash, followed by its length
+// to separate adjacent strings.
+uint64_t hashString(uint64_t hash, const string& str)
+{
+    for (char c : str)
+    {
+        hash = (hash ^ (uint64_t) (unsigned char) c) * HASH_PRIME;
+    }
+    return (hash ^ (uint64_t) str.size()) * HASH_PRIME;
+}
+
+// Combine the given 64-bit value into a hash, with a final avalanche step
+// so that child hashes affect all bits of their parent hash.
+uint64_t hashValue(uint64_t hash, uint64_t value)
+{
+    hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+    return hash ^ (hash >> 31);
+}
+
+const size_t ARENA_BLOCK_SIZE = 256 * 1024;
+const size_t ARENA_ALIGNMENT = alignof(std::max_align_t);
+
+// Return the size of the arena chunk holding an allocation of the given size.
+size_t getArenaChunkSize(size_t size)
+{
+    return (std::max(size, sizeof(void*)) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+}
+
+// Attribute names that are common in MaterialX documents, which are
+// interned ahead of time.
+const char* const SEEDED_ATTRIBUTE_NAMES[] =
+{
+    "type", "value", "nodedef", "nodename", "nodegraph", "output", "interfacename",
+    "channels", "colorspace", "doc", "xpos", "ypos", "version", "isdefaultversion",
+    "inherit", "namespace", "fileprefix", "geomprefix", "cms", "cmsconfig",
+    "uiname", "uifolder", "uimin", "uimax", "uisoftmin", "uisoftmax", "uistep",
+    "uiadvanced", "unit", "unittype", "enum", "enumvalues", "default", "defaultinput",
+    "defaultgeomprop", "semantic", "context", "node", "nodegroup", "target",
+    "file", "function", "language", "implname", "geom", "geomprop", "collection",
+    "includegeom", "excludegeom", "includecollection", "material", "look", "looks",
+    "variantset", "variant", "active", "property", "propertyset", "space", "index",
+    "visible", "vistype", "viewergeom", "viewercollection", "xmlns:xi"
+};
+
+// Return the interned copy of the given attribute name.  Interned names
+// are never released, so the returned pointer remains valid for the
+// lifetime of the process.
+const string* internAttributeName(const string& attrib)
+{
+    // Seeded names are held in a table that is never modified after its
+    // construction, so they are found without locking.
+    static const std::unordered_set<string> seededNames(std::begin(SEEDED_ATTRIBUTE_NAMES),
+                                                        std::end(SEEDED_ATTRIBUTE_NAMES));
+    auto it = seededNames.find(attrib);
+    if (it != seededNames.end())
+    {
+        return &*it;
+    }
+
+    static std::mutex internMutex;
+    static std::unordered_set<string> internedNames;
+
+    std::lock_guard<std::mutex> lock(internMutex);
+    return &*internedNames.insert(attrib).first;
+}
+
+// Return the document of an element that is about to be modified,
+// throwing an exception if the document is a shared data library.
+DocumentPtr getModifiableDocument(Element& elem)
+{
+    DocumentPtr doc = elem.getDocument();
+    if (doc->isSharedDataLibrary())
+    {
+        throw Exception("Cannot modify an element of a shared data library: " + elem.getNamePath() +
+                        ". Use Document::localizeElement to edit a local copy.");
+    }
+    return doc;
+}
+
+} // anonymous namespace
+
+//
+// ElementArena methods
+//
+
+ElementArena::~ElementArena()
+{
+    for (char* block : _blocks)
+    {
+        delete[] block;
+    }
+}
+
+void* ElementArena::allocate(size_t size, size_t alignment)
+{
+    if (alignment > ARENA_ALIGNMENT)
+    {
+        throw Exception("Unsupported alignment in element arena: " + std::to_string(alignment));
+    }
+
+    // Round each allocation up to the arena alignment, so that chunks of
+    // equal size are interchangeable and the current block stays aligned.
+    size = getArenaChunkSize(size);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _allocatedSize += size;
+
+    // Reuse a released chunk of the same size if one is available.
+    auto it = _freeLists.find(size);
+    if (it != _freeLists.end() && it->second)
+    {
+        FreeChunk* chunk = it->second;
+        it->second = chunk->next;
+        return chunk;
+    }
+
+    // Allocations larger than a fraction of the block size receive their
+    // own block, leaving the current block in place.
+    if (size > ARENA_BLOCK_SIZE / 4)
+    {
+        char* block = new char[size];
+        _blocks.push_back(block);
+        _reservedSize += size;
+        return block;
+    }
+
+    if (size > _remaining)
+    {
+        _current = new char[ARENA_BLOCK_SIZE];
+        _blocks.push_back(_current);
+        _reservedSize += ARENA_BLOCK_SIZE;
+        _remaining = ARENA_BLOCK_SIZE;
+    }
+
+    char* ptr = _current;
+    _current += size;
+    _remaining -= size;
+    return ptr;
+}
+
+void ElementArena::deallocate(void* ptr, size_t size)
+{
+    size = getArenaChunkSize(size);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _allocatedSize -= size;
+    FreeChunk*& head = _freeLists[size];
+    FreeChunk* chunk = static_cast<FreeChunk*>(ptr);
+    chunk->next = head;
+    head = chunk;
+}
+
 //
 // Element methods
 //
 
 bool Element::operator==(const Element& rhs) const
 {
+    if (this == &rhs)
+    {
+        return true;
+    }
+
+    // Element trees with differing content hashes cannot be equal.
+    if (getContentHash() != rhs.getContentHash())
+    {
+        return false;
+    }
+
     if (getCategory() != rhs.getCategory() ||
         getName() != rhs.getName())
     {
         return false;
     }
 
-    // Compare attributes.
-    if (getAttributeNames() != rhs.getAttributeNames())
+    // Compare attributes, whose interned names may be compared by address.
+    if (_attributes.size() != rhs._attributes.size())
         return false;
-    for (const string& attr : rhs.getAttributeNames())
+    for (size_t i = 0; i < _attributes.size(); i++)
     {
-        if (getAttribute(attr) != rhs.getAttribute(attr))
+        if (_attributes[i].name != rhs._attributes[i].name ||
+            _attributes[i].value != rhs._attributes[i].value)
             return false;
     }
 
@@ -81,9 +258,57 @@ bool Element::operator!=(const Element& rhs) const
     return !(*this == rhs);
 }
 
+uint64_t Element::getContentHash() const
+{
+    uint64_t hash = _contentHash.load(std::memory_order_relaxed);
+    if (hash)
+    {
+        return hash;
+    }
+
+    hash = hashString(HASH_OFFSET_BASIS, _category);
+    hash = hashString(hash, _name);
+    hash = hashValue(hash, _attributes.size());
+    for (const Attribute& attr : _attributes)
+    {
+        hash = hashString(hash, *attr.name);
+        hash = hashString(hash, attr.value);
+    }
+    hash = hashValue(hash, _childOrder.size());
+    for (const ElementPtr& child : _childOrder)
+    {
+        hash = hashValue(hash, child->getContentHash());
+    }
+
+    // Reserve zero as the invalid hash.
+    if (!hash)
+    {
+        hash = 1;
+    }
+    _contentHash.store(hash, std::memory_order_relaxed);
+    return hash;
+}
+
+void Element::invalidateContentHash()
+{
+    // Since computing the hash of an element computes the hashes of all of
+    // its descendants, an invalid hash implies that all ancestors are invalid.
+    if (!_contentHash.exchange(0, std::memory_order_relaxed))
+    {
+        return;
+    }
+    for (ElementPtr parent = getParent(); parent; parent = parent->getParent())
+    {
+        if (!parent->_contentHash.exchange(0, std::memory_order_relaxed))
+        {
+            break;
+        }
+    }
+}
+
 void Element::setName(const string& name)
 {
-    DocumentPtr doc = getDocument();
+    DocumentPtr doc = getModifiableDocument(*this);
     ElementPtr parent = getParent();
     if (parent && parent->_childMap.count(name) && name != getName())
     {
@@ -100,6 +325,7 @@ void Element::setName(const string& name)
         parent->_childMap[name] = getSelf();
     }
     _name = name;
+    invalidateContentHash();
 }
 
 string Element::getNamePath(ConstElementPtr relativeTo) const
@@ -162,7 +388,7 @@ std::pair<int, int> Element::getVersionIntegers() const
 
 void Element::registerChildElement(ElementPtr child)
 {
-    DocumentPtr doc = getDocument();
+    DocumentPtr doc = getModifiableDocument(*this);
 
     // Handle change notifications.
     ScopedUpdate update(doc);
@@ -170,11 +396,12 @@ void Element::registerChildElement(ElementPtr child)
 
     _childMap[child->getName()] = child;
     _childOrder.push_back(child);
+    invalidateContentHash();
 }
 
 void Element::unregisterChildElement(ElementPtr child)
 {
-    DocumentPtr doc = getDocument();
+    DocumentPtr doc = getModifiableDocument(*this);
 
     // Handle change notifications.
     ScopedUpdate update(doc);
@@ -183,6 +410,7 @@ void Element::unregisterChildElement(ElementPtr child)
     _childMap.erase(child->getName());
     _childOrder.erase(
         std::find(_childOrder.begin(), _childOrder.end(), child));
+    invalidateContentHash();
 }
 
 int Element::getChildIndex(const string& name) const
@@ -212,6 +440,7 @@ void Element::setChildIndex(const string& name, int index)
 
     _childOrder.erase(it);
     _childOrder.insert(_childOrder.begin() + (size_t) index, child);
+    invalidateContentHash();
 }
 
 void Element::removeChild(const string& name)
@@ -227,33 +456,37 @@ void Element::removeChild(const string& name)
 
 void Element::setAttribute(const string& attrib, const string& value)
 {
-    DocumentPtr doc = getDocument();
+    DocumentPtr doc = getModifiableDocument(*this);
 
     // Handle change notifications.
     ScopedUpdate update(doc);
     doc->onSetAttribute(getSelf(), attrib, value);
 
-    if (!_attributeMap.count(attrib))
+    Attribute* attr = const_cast<Attribute*>(findAttribute(attrib));
+    if (attr)
     {
-        _attributeOrder.push_back(attrib);
+        attr->value = value;
     }
-    _attributeMap[attrib] = value;
+    else
+    {
+        _attributes.push_back({ internAttributeName(attrib), value });
+    }
+    invalidateContentHash();
 }
 
 void Element::removeAttribute(const string& attrib)
 {
-    StringMap::iterator it = _attributeMap.find(attrib);
-    if (it != _attributeMap.end())
+    const Attribute* attr = findAttribute(attrib);
+    if (attr)
     {
-        DocumentPtr doc = getDocument();
+        DocumentPtr doc = getModifiableDocument(*this);
 
         // Handle change notifications.
         ScopedUpdate update(doc);
         doc->onRemoveAttribute(getSelf(), attrib);
 
-        _attributeMap.erase(it);
-        _attributeOrder.erase(
-            std::find(_attributeOrder.begin(), _attributeOrder.end(), attrib));
+        _attributes.erase(_attributes.begin() + (attr - _attributes.data()));
+        invalidateContentHash();
     }
 }
 
@@ -331,6 +564,23 @@ ConstElementPtr Element::getRoot() const
     return root;
 }
 
+ElementPtr Element::getRootChild(const string& name) const
+{
+    ConstElementPtr root = getRoot();
+    ElementPtr child = root->getChild(name);
+    if (!child)
+    {
+        ConstDocumentPtr doc = root->asA<Document>();
+        ConstDocumentPtr library = doc ? doc->getDataLibrary() : ConstDocumentPtr();
+        while (library && !child)
+        {
+            child = library->getChild(name);
+            library = library->getDataLibrary();
+        }
+    }
+    return child;
+}
+
 bool Element::hasInheritedBase(ConstElementPtr base) const
 {
     for (ConstElementPtr elem : traverseInheritance())
@@ -383,7 +633,7 @@ InheritanceIterator Element::traverseInheritance() const
 
 void Element::copyContentFrom(const ConstElementPtr& source, const CopyOptions* copyOptions)
 {
-    DocumentPtr doc = getDocument();
+    DocumentPtr doc = getModifiableDocument(*this);
     bool skipConflictingElements = copyOptions && copyOptions->skipConflictingElements;
 
     // Handle change notifications.
@@ -391,8 +641,8 @@ void Element::copyContentFrom(const ConstElementPtr& source, const CopyOptions*
     doc->onCopyContent(getSelf());
 
     _sourceUri = source->_sourceUri;
-    _attributeMap = source->_attributeMap;
-    _attributeOrder = source->_attributeOrder;
+    _attributes = source->_attributes;
+    invalidateContentHash();
 
     for (const ConstElementPtr& child : source->getChildren())
     {
@@ -419,15 +669,15 @@ void Element::copyContentFrom(const ConstElementPtr& source, const CopyOptions*
 
 void Element::clearContent()
 {
-    DocumentPtr doc = getDocument();
+    DocumentPtr doc = getModifiableDocument(*this);
 
     // Handle change notifications.
     ScopedUpdate update(doc);
     doc->onClearContent(getSelf());
 
     _sourceUri = EMPTY_STRING;
-    _attributeMap.clear();
-    _attributeOrder.clear();
+    _attributes.clear();
+    invalidateContentHash();
 
     vector<ElementPtr> children = getChildren();
     for (ElementPtr child : children)
@@ -438,19 +688,10 @@ void Element::clearContent()
 
 bool Element::validate(string* message) const
 {
-    bool res = true;
-    validateRequire(isValidName(getName()), res, message, "Invalid element name");
-    if (hasInheritString())
-    {
-        bool validInherit = getInheritsFrom() && getInheritsFrom()->getCategory() == getCategory();
-        validateRequire(validInherit, res, message, "Invalid element inheritance");
-    }
-    for (ElementPtr child : getChildren())
+    return validateElement(message, [this](size_t index, string* childMessage)
     {
-        res = child->validate(message) && res;
-    }
-    validateRequire(!hasInheritanceCycle(), res, message, "Cycle in element inheritance chain");
-    return res;
+        return _childOrder[index]->validate(childMessage);
+    });
 }
 
 StringResolverPtr Element::createStringResolver(const string& geom,
@@ -505,14 +746,31 @@ string Element::asString() const
     {
         res += " name=\"" + getName() + "\"";
     }
-    for (const string& attrName : getAttributeNames())
+    for (const Attribute& attr : _attributes)
     {
-        res += " " + attrName + "=\"" + getAttribute(attrName) + "\"";
+        res += " " + attr.getName() + "=\"" + attr.getValue() + "\"";
     }
     res += ">";
     return res;
 }
 
+bool Element::validateElement(string* message, const ChildValidator& validateChild) const
+{
+    bool res = true;
+    validateRequire(isValidName(getName()), res, message, "Invalid element name");
+    if (hasInheritString())
+    {
+        bool validInherit = getInheritsFrom() && getInheritsFrom()->getCategory() == getCategory();
+        validateRequire(validInherit, res, message, "Invalid element inheritance");
+    }
+    for (size_t i = 0; i < _childOrder.size(); i++)
+    {
+        res = validateChild(i, message) && res;
+    }
+    validateRequire(!hasInheritanceCycle(), res, message, "Cycle in element inheritance chain");
+    return res;
+}
+
 void Element::validateRequire(bool expression, bool& res, string* message, string errorDesc) const
 {
     if (!expression)
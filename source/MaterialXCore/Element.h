@@ -15,6 +15,9 @@
 #include <MaterialXCore/Util.h>
 #include <MaterialXCore/Value.h>
 
+#include <atomic>
+#include <mutex>
+
 namespace MaterialX
 {
 
@@ -26,6 +29,7 @@ class StringResolver;
 class Document;
 class Material;
 class CopyOptions;
+class ElementArena;
 
 /// A shared pointer to an Element
 using ElementPtr = shared_ptr<Element>;
@@ -50,12 +54,125 @@ using ConstTokenPtr = shared_ptr<const Token>;
 /// A shared pointer to a StringResolver
 using StringResolverPtr = shared_ptr<StringResolver>;
 
+/// A shared pointer to an ElementArena
+using ElementArenaPtr = shared_ptr<ElementArena>;
+
 /// A hash map from strings to elements
 using ElementMap = std::unordered_map<string, ElementPtr>;
 
 /// A standard function taking an ElementPtr and returning a boolean.
 using ElementPredicate = std::function<bool(ConstElementPtr)>;
 
+/// @class ElementArena
+/// A memory arena for the elements of a Document.
+///
+/// Memory is handed out from large blocks, which are freed together when
+/// the arena is destroyed.  Memory released by destroyed elements is kept
+/// on free lists by size, and is reused by later elements of the same size,
+/// so that documents with frequent edits do not grow without bound.  Each
+/// element allocated from an arena holds a reference to it, so the arena
+/// outlives every element drawn from it.
+///
+/// Only element objects and their reference counts are drawn from the
+/// arena; the containers held by each element use the default allocator.
+/// Elements are still destroyed individually, so the arena improves the
+/// locality of traversals rather than the cost of teardown.
+///
+/// Since elements may be released on any thread, allocation and
+/// deallocation are guarded by a mutex, which adds a lock to the creation
+/// and destruction of each element.
+class ElementArena : public std::enable_shared_from_this<ElementArena>
+{
+  public:
+    ElementArena() :
+        _current(nullptr),
+        _remaining(0),
+        _allocatedSize(0),
+        _reservedSize(0)
+    {
+    }
+    ~ElementArena();
+    ElementArena(const ElementArena&) = delete;
+    ElementArena& operator=(const ElementArena&) = delete;
+
+    /// Allocate a block of memory with the given size and alignment.
+    void* allocate(size_t size, size_t alignment);
+
+    /// Return a block of memory with the given size to the arena for reuse.
+    void deallocate(void* ptr, size_t size);
+
+    /// Return the number of bytes currently allocated from this arena.
+    size_t getAllocatedSize() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _allocatedSize;
+    }
+
+    /// Return the total number of bytes in the blocks held by this arena.
+    size_t getReservedSize() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _reservedSize;
+    }
+
+  private:
+    struct FreeChunk
+    {
+        FreeChunk* next;
+    };
+
+    vector<char*> _blocks;
+    std::unordered_map<size_t, FreeChunk*> _freeLists;
+    char* _current;
+    size_t _remaining;
+    size_t _allocatedSize;
+    size_t _reservedSize;
+    mutable std::mutex _mutex;
+};
+
+/// @class ElementAllocator
+/// A standard allocator that draws memory from an ElementArena, allowing
+/// elements and their reference counts to be created with
+/// std::allocate_shared.  Deallocated memory is returned to the arena for
+/// reuse.
+template <class T> class ElementAllocator
+{
+  public:
+    using value_type = T;
+
+    explicit ElementAllocator(ElementArenaPtr arena) :
+        _arena(std::move(arena))
+    {
+    }
+    template <class U> ElementAllocator(const ElementAllocator<U>& other) :
+        _arena(other._arena)
+    {
+    }
+
+    T* allocate(size_t count)
+    {
+        return static_cast<T*>(_arena->allocate(count * sizeof(T), alignof(T)));
+    }
+    void deallocate(T* ptr, size_t count)
+    {
+        _arena->deallocate(ptr, count * sizeof(T));
+    }
+
+    template <class U> bool operator==(const ElementAllocator<U>& rhs) const
+    {
+        return _arena == rhs._arena;
+    }
+    template <class U> bool operator!=(const ElementAllocator<U>& rhs) const
+    {
+        return _arena != rhs._arena;
+    }
+
+  private:
+    template <class U> friend class ElementAllocator;
+
+    ElementArenaPtr _arena;
+};
+
 /// @class Element
 /// The base class for MaterialX elements.
 ///
@@ -68,7 +185,9 @@ class Element : public std::enable_shared_from_this<Element>
         _category(category),
         _name(name),
         _parent(parent),
-        _root(parent ? parent->getRoot() : nullptr)
+        _root(parent ? parent->getRoot() : nullptr),
+        _contentHash(0),
+        _elementArena(parent ? parent->_elementArena : nullptr)
     {
     }
   public:
@@ -92,6 +211,15 @@ class Element : public std::enable_shared_from_this<Element>
     /// differs from this one.
     bool operator!=(const Element& rhs) const;
 
+    /// Return a 64-bit hash of the content of this element tree, including
+    /// its category, name, attributes, and all descendants.  Element trees
+    /// that compare as equal are guaranteed to have equal content hashes.
+    ///
+    /// The hash is computed lazily and cached, and the cached value is
+    /// invalidated for this element and its ancestors whenever their
+    /// content is modified.
+    uint64_t getContentHash() const;
+
     /// @name Category
     /// @{
 
@@ -99,6 +227,7 @@ class Element : public std::enable_shared_from_this<Element>
     void setCategory(const string& category)
     {
         _category = category;
+        invalidateContentHash();
     }
 
     /// Return the element's category string.  The category of a MaterialX
@@ -526,27 +655,64 @@ class Element : public std::enable_shared_from_this<Element>
     /// @name Attributes
     /// @{
 
+    /// A stored attribute, whose name is an interned string that is shared
+    /// by all elements with an attribute of that name.
+    struct Attribute
+    {
+        /// Return the name of the attribute.
+        const string& getName() const
+        {
+            return *name;
+        }
+
+        /// Return the value string of the attribute.
+        const string& getValue() const
+        {
+            return value;
+        }
+
+        const string* name;
+        string value;
+    };
+
     /// Set the value string of the given attribute.
     void setAttribute(const string& attrib, const string& value);
 
     /// Return true if the given attribute is present.
     bool hasAttribute(const string& attrib) const
     {
-        return _attributeMap.count(attrib) != 0;
+        return findAttribute(attrib) != nullptr;
     }
 
     /// Return the value string of the given attribute.  If the given attribute
     /// is not present, then an empty string is returned.
     const string& getAttribute(const string& attrib) const
     {
-        StringMap::const_iterator it = _attributeMap.find(attrib);
-        return (it != _attributeMap.end()) ? it->second : EMPTY_STRING;
+        const Attribute* attr = findAttribute(attrib);
+        return attr ? attr->value : EMPTY_STRING;
     }
 
-    /// Return a vector of stored attribute names, in the order they were set.
-    const StringVec& getAttributeNames() const
+    /// Return the stored attributes, in the order they were set.  Unlike
+    /// getAttributeNames, this allocates nothing, and gives access to each
+    /// name and value without a further lookup.
+    const vector<Attribute>& getAttributes() const
     {
-        return _attributeOrder;
+        return _attributes;
+    }
+
+    /// Return a vector of stored attribute names, in the order they were set.
+    /// Since names are no longer stored in a vector of their own, the names
+    /// are returned by value, copied on each call; use getAttributes to
+    /// iterate over attributes without allocating.
+    StringVec getAttributeNames() const
+    {
+        StringVec names;
+        names.reserve(_attributes.size());
+        for (const Attribute& attr : _attributes)
+        {
+            names.push_back(*attr.name);
+        }
+        return names;
     }
 
     /// Set the value of an implicitly typed attribute.  Since an attribute
@@ -836,11 +1002,45 @@ class Element : public std::enable_shared_from_this<Element>
     // taking the namespace at the scope of this element into account.
     template<class T> shared_ptr<T> resolveRootNameReference(const string& name) const
     {
-        ConstElementPtr root = getRoot();
-        shared_ptr<T> child = root->getChildOfType<T>(getQualifiedName(name));
-        return child ? child : root->getChildOfType<T>(name);
+        ElementPtr child = getRootChild(getQualifiedName(name));
+        shared_ptr<T> typedChild = child ? child->asA<T>() : shared_ptr<T>();
+        if (typedChild)
+        {
+            return typedChild;
+        }
+        child = getRootChild(name);
+        return child ? child->asA<T>() : shared_ptr<T>();
     }
 
+    // Return the child of the root element with the given name, falling
+    // through to the data library of the root document if present.
+    ElementPtr getRootChild(const string& name) const;
+
+    // Return the stored attribute with the given name, or nullptr if no
+    // such attribute is present.  Since elements carry few attributes,
+    // a linear search is faster than a hashed lookup.
+    const Attribute* findAttribute(const string& attrib) const
+    {
+        for (const Attribute& attr : _attributes)
+        {
+            if (*attr.name == attrib)
+            {
+                return &attr;
+            }
+        }
+        return nullptr;
+    }
+
+    // Invalidate the cached content hash of this element and its ancestors.
+    void invalidateContentHash();
+
+    // A function that validates the child element at the given index.
+    using ChildValidator = std::function<bool(size_t, string*)>;
+
+    // Validate this element, calling the given function to validate each
+    // of its children in order.
+    bool validateElement(string* message, const ChildValidator& validateChild) const;
+
     // Enforce a requirement within a validate method, updating the validation
     // state and optional output text if the requirement is not met.
     void validateRequire(bool expression, bool& res, string* message, string errorDesc) const;
@@ -876,18 +1076,41 @@ class Element : public std::enable_shared_from_this<Element>
     ElementMap _childMap;
     vector<ElementPtr> _childOrder;
 
-    StringMap _attributeMap;
-    StringVec _attributeOrder;
+    vector<Attribute> _attributes;
 
     weak_ptr<Element> _parent;
     weak_ptr<Element> _root;
 
+    // The cached content hash, where zero represents an invalid hash.
+    mutable std::atomic<uint64_t> _contentHash;
+
+    // The arena of the owning document, if any, from which children of
+    // this element are allocated.
+    ElementArena* _elementArena;
+
   private:
-    template <class T> static ElementPtr createElement(ElementPtr parent, const string& name)
+    template <class T> static shared_ptr<T> allocateElement(ElementPtr parent, const string& name)
     {
+        ElementArenaPtr arena = getElementArena(parent);
+        if (arena)
+        {
+            return std::allocate_shared<T>(ElementAllocator<T>(arena), parent, name);
+        }
         return std::make_shared<T>(parent, name);
     }
 
+    template <class T> static ElementPtr createElement(ElementPtr parent, const string& name)
+    {
+        return allocateElement<T>(parent, name);
+    }
+
+    // Return the element arena, if any, from which children of the given
+    // parent are allocated.
+    static ElementArenaPtr getElementArena(const ElementPtr& parent)
+    {
+        return (parent && parent->_elementArena) ? parent->_elementArena->shared_from_this() : nullptr;
+    }
+
   private:
     using CreatorFunction = ElementPtr (*)(ElementPtr, const string&);
     using CreatorMap = std::unordered_map<string, CreatorFunction>;
@@ -1392,7 +1615,7 @@ template<class T> shared_ptr<T> Element::addChild(const string& name)
     if (_childMap.count(childName))
         throw Exception("Child name is not unique: " + childName);
 
-    shared_ptr<T> child = std::make_shared<T>(getSelf(), childName);
+    shared_ptr<T> child = allocateElement<T>(getSelf(), childName);
     registerChildElement(child);
 
     return child;
@@ -368,7 +368,7 @@ GeomPropDefPtr Input::getDefaultGeomProp() const
     if (!defaultGeomProp.empty())
     {
         ConstDocumentPtr doc = getDocument();
-        return doc->getChildOfType<GeomPropDef>(defaultGeomProp);
+        return doc->getGeomPropDef(defaultGeomProp);
     }
     return nullptr;
 }
@@ -139,8 +139,9 @@ class ObservedDocument : public Document
 
     DocumentPtr copy() const override
     {
-        DocumentPtr doc = createDocument<ObservedDocument>();
+        DocumentPtr doc = createDocument<ObservedDocument>(getElementArena() != nullptr);
         doc->copyContentFrom(getSelf());
+        doc->setDataLibrary(getDataLibrary());
         return doc;
     }
 
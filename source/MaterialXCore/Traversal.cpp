@@ -7,6 +7,8 @@
 
 #include <MaterialXCore/Node.h>
 
+#include <cstdint>
+
 namespace MaterialX
 {
 
@@ -16,6 +18,18 @@ const TreeIterator NULL_TREE_ITERATOR(nullptr);
 const GraphIterator NULL_GRAPH_ITERATOR(nullptr, nullptr);
 const InheritanceIterator NULL_INHERITANCE_ITERATOR(nullptr);
 
+namespace {
+
+// Return the home slot of the given element in a path table with the given
+// mask, using Fibonacci hashing to spread aligned pointer values.
+size_t getPathSlot(const Element* elem, size_t mask)
+{
+    uint64_t hash = (uint64_t) reinterpret_cast<uintptr_t>(elem) * 0x9e3779b97f4a7c15ull;
+    return (size_t) (hash >> 32) & mask;
+}
+
+} // anonymous namespace
+
 //
 // Edge methods
 //
@@ -79,6 +93,127 @@ TreeIterator& TreeIterator::operator++()
     }
 }
 
+//
+// ElementPathSet methods
+//
+
+bool ElementPathSet::insert(const Element* elem)
+{
+    if (!elem || contains(elem))
+    {
+        return false;
+    }
+
+    if (_table.empty())
+    {
+        if (_size < INLINE_CAPACITY)
+        {
+            _inline[_size++] = elem;
+            return true;
+        }
+
+        // Move the inline elements into a hash table.
+        _table.assign(INLINE_CAPACITY * 4, nullptr);
+        for (const Element* inlineElem : _inline)
+        {
+            insertSlot(inlineElem);
+        }
+    }
+    else if ((_size + 1) * 2 > _table.size())
+    {
+        // Grow the table to keep its load factor at or below one half.
+        vector<const Element*> oldTable(_table.size() * 2, nullptr);
+        oldTable.swap(_table);
+        for (const Element* oldElem : oldTable)
+        {
+            if (oldElem)
+            {
+                insertSlot(oldElem);
+            }
+        }
+    }
+
+    insertSlot(elem);
+    _size++;
+    return true;
+}
+
+void ElementPathSet::erase(const Element* elem)
+{
+    if (!elem)
+    {
+        return;
+    }
+
+    if (_table.empty())
+    {
+        for (size_t i = 0; i < _size; i++)
+        {
+            if (_inline[i] == elem)
+            {
+                _inline[i] = _inline[--_size];
+                return;
+            }
+        }
+        return;
+    }
+
+    size_t slot = findSlot(elem);
+    if (!_table[slot])
+    {
+        return;
+    }
+    _table[slot] = nullptr;
+    _size--;
+
+    // Shift later entries of the probe sequence back into the freed slot,
+    // so that lookups never stop early at a gap.
+    const size_t mask = _table.size() - 1;
+    for (size_t next = (slot + 1) & mask; _table[next]; next = (next + 1) & mask)
+    {
+        size_t home = getPathSlot(_table[next], mask);
+        bool inRange = (slot <= next) ? (slot < home && home <= next) : (slot < home || home <= next);
+        if (!inRange)
+        {
+            _table[slot] = _table[next];
+            _table[next] = nullptr;
+            slot = next;
+        }
+    }
+}
+
+bool ElementPathSet::contains(const Element* elem) const
+{
+    if (_table.empty())
+    {
+        for (size_t i = 0; i < _size; i++)
+        {
+            if (_inline[i] == elem)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    return _table[findSlot(elem)] == elem;
+}
+
+size_t ElementPathSet::findSlot(const Element* elem) const
+{
+    const size_t mask = _table.size() - 1;
+    size_t slot = getPathSlot(elem, mask);
+    while (_table[slot] && _table[slot] != elem)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void ElementPathSet::insertSlot(const Element* elem)
+{
+    _table[findSlot(elem)] = elem;
+}
+
 //
 // GraphIterator methods
 //
@@ -86,7 +221,7 @@ TreeIterator& TreeIterator::operator++()
 size_t GraphIterator::getNodeDepth() const
 {
     size_t nodeDepth = 0;
-    for (ElementPtr elem : _pathElems)
+    for (const Element* elem : _pathElems)
     {
         if (elem->isA<Node>())
         {
@@ -157,23 +292,30 @@ GraphIterator& GraphIterator::operator++()
     return *this;
 }
 
-void GraphIterator::extendPathUpstream(ElementPtr upstreamElem, ElementPtr connectingElem)
+void GraphIterator::extendPathUpstream(const ElementPtr& upstreamElem, const ElementPtr& connectingElem)
 {
     // Check for cycles.
-    if (_pathElems.count(upstreamElem))
+    if (!_pathSet.insert(upstreamElem.get()))
     {
         throw ExceptionFoundCycle("Encountered cycle at element: " + upstreamElem->asString());
     }
 
     // Extend the current path to the new element.
-    _pathElems.insert(upstreamElem);
+    _pathElems.push_back(upstreamElem.get());
     _upstreamElem = upstreamElem;
     _connectingElem = connectingElem;
 }
 
-void GraphIterator::returnPathDownstream(ElementPtr upstreamElem)
+void GraphIterator::returnPathDownstream(const ElementPtr& upstreamElem)
 {
-    _pathElems.erase(upstreamElem);
+    // Elements leave the path in the reverse order of their arrival, so the
+    // search begins at the end of the path.
+    ElementPath::reverse_iterator it = std::find(_pathElems.rbegin(), _pathElems.rend(), upstreamElem.get());
+    if (it != _pathElems.rend())
+    {
+        _pathElems.erase(std::next(it).base());
+        _pathSet.erase(upstreamElem.get());
+    }
     _upstreamElem = ElementPtr();
     _connectingElem = ElementPtr();
 }
@@ -205,11 +347,10 @@ InheritanceIterator& InheritanceIterator::operator++()
         if (super)
         {
             // Check for cycles.
-            if (_pathElems.count(super))
+            if (!_pathSet.insert(super.get()))
             {
                 throw ExceptionFoundCycle("Encountered cycle at element: " + super->asString());
             }
-            _pathElems.insert(super);
         }
         _elem = super;
     }
@@ -11,6 +11,8 @@
 
 #include <MaterialXCore/Library.h>
 
+#include <array>
+
 namespace MaterialX
 {
 
@@ -187,6 +189,42 @@ class TreeIterator
     size_t _holdCount;
 };
 
+/// @class ElementPathSet
+/// A flat set of the elements along a traversal path, used to detect cycles.
+///
+/// Shallow paths are stored in a small inline array, which is searched
+/// linearly without allocation, while deeper paths move to an open-addressing
+/// hash table, so that each check takes constant time on paths of any depth.
+class ElementPathSet
+{
+  public:
+    ElementPathSet() :
+        _size(0)
+    {
+    }
+
+    /// Add the given element to the set, returning false if it was already
+    /// present.
+    bool insert(const Element* elem);
+
+    /// Remove the given element from the set, if present.
+    void erase(const Element* elem);
+
+    /// Return true if the given element is present in the set.
+    bool contains(const Element* elem) const;
+
+  private:
+    size_t findSlot(const Element* elem) const;
+    void insertSlot(const Element* elem);
+
+  private:
+    static const size_t INLINE_CAPACITY = 8;
+
+    std::array<const Element*, INLINE_CAPACITY> _inline;
+    vector<const Element*> _table;
+    size_t _size;
+};
+
 /// @class GraphIterator
 /// An iterator object representing the state of an upstream graph traversal.
 ///
@@ -200,12 +238,13 @@ class GraphIterator
         _prune(false),
         _holdCount(0)
     {
-        _pathElems.insert(elem);
+        _pathElems.push_back(elem.get());
+        _pathSet.insert(elem.get());
     }
     ~GraphIterator() { }
 
   private:
-    using ElementSet = std::set<ElementPtr>;
+    using ElementPath = vector<const Element*>;
     using StackFrame = std::pair<ElementPtr, size_t>;
 
   public:
@@ -319,13 +358,14 @@ class GraphIterator
     /// @}
 
   private:
-    void extendPathUpstream(ElementPtr upstreamElem, ElementPtr connectingElem);
-    void returnPathDownstream(ElementPtr upstreamElem);
+    void extendPathUpstream(const ElementPtr& upstreamElem, const ElementPtr& connectingElem);
+    void returnPathDownstream(const ElementPtr& upstreamElem);
 
   private:
     ElementPtr _upstreamElem;
     ElementPtr _connectingElem;
-    ElementSet _pathElems;
+    ElementPath _pathElems;
+    ElementPathSet _pathSet;
     ConstMaterialPtr _material;
     vector<StackFrame> _stack;
     bool _prune;
@@ -343,13 +383,10 @@ class InheritanceIterator
         _elem(elem),
         _holdCount(0)
     {
-        _pathElems.insert(elem);
+        _pathSet.insert(elem.get());
     }
     ~InheritanceIterator() { }
 
-  private:
-    using ConstElementSet = std::set<ConstElementPtr>;
-
   public:
     bool operator==(const InheritanceIterator& rhs) const
     {
@@ -384,7 +421,7 @@ class InheritanceIterator
 
   private:
     ConstElementPtr _elem;
-    ConstElementSet _pathElems;
+    ElementPathSet _pathSet;
     size_t _holdCount;
 };
 
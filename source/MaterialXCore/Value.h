@@ -91,6 +91,8 @@ class Value
     /// Set float formatting for converting values to strings.
     /// Formats to use are FloatFormatFixed, FloatFormatScientific 
     /// or FloatFormatDefault to set default format.
+    /// Float formatting is stored per thread, so concurrent shader
+    /// generation on multiple threads does not interfere.
     static void setFloatFormat(FloatFormat format)
     {
         _floatFormat = format;
@@ -122,8 +124,8 @@ class Value
 
   private:
     static CreatorMap _creatorMap;
-    static FloatFormat _floatFormat;
-    static int _floatPrecision;
+    static thread_local FloatFormat _floatFormat;
+    static thread_local int _floatPrecision;
 };
 
 /// The class template for typed subclasses of Value
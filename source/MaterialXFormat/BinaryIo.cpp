@@ -0,0 +1,494 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <MaterialXFormat/BinaryIo.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+
+namespace MaterialX
+{
+
+const string MTLX_BINARY_EXTENSION = "mtlxb";
+
+namespace {
+
+// The binary container consists of a header, followed by a table of string
+// offsets, an array of elements in depth-first order, an array of attributes,
+// and the string data referenced by the offset table.  All values are stored
+// as 32-bit unsigned integers in native byte order.
+
+const char BINARY_MAGIC[8] = { 'M', 'T', 'L', 'X', 'B', 'I', 'N', '\0' };
+const uint32_t BINARY_VERSION = 1;
+const uint32_t NO_PARENT = std::numeric_limits<uint32_t>::max();
+
+struct BinaryHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t stringCount;
+    uint32_t stringDataSize;
+    uint32_t elementCount;
+    uint32_t attributeCount;
+    uint32_t reserved;
+};
+
+struct BinaryElement
+{
+    uint32_t category;
+    uint32_t name;
+    uint32_t sourceUri;
+    uint32_t parent;
+    uint32_t firstAttribute;
+    uint32_t attributeCount;
+};
+
+struct BinaryAttribute
+{
+    uint32_t name;
+    uint32_t value;
+};
+
+// Flattened tables of a document, built during writing.
+class BinaryTables
+{
+  public:
+    BinaryTables()
+    {
+        addString(EMPTY_STRING);
+    }
+
+    uint32_t addString(const string& str)
+    {
+        auto it = stringIndices.find(str);
+        if (it != stringIndices.end())
+        {
+            return it->second;
+        }
+        uint32_t index = (uint32_t) strings.size();
+        stringIndices[str] = index;
+        strings.push_back(str);
+        return index;
+    }
+
+    void addElement(ConstElementPtr elem, uint32_t parent)
+    {
+        BinaryElement binaryElem;
+        binaryElem.category = addString(elem->getCategory());
+        binaryElem.name = addString(elem->getName());
+        binaryElem.sourceUri = addString(elem->getSourceUri());
+        binaryElem.parent = parent;
+        binaryElem.firstAttribute = (uint32_t) attributes.size();
+        binaryElem.attributeCount = (uint32_t) elem->getAttributes().size();
+        for (const Element::Attribute& attr : elem->getAttributes())
+        {
+            attributes.push_back({ addString(attr.getName()), addString(attr.getValue()) });
+        }
+
+        uint32_t index = (uint32_t) elements.size();
+        elements.push_back(binaryElem);
+        for (ElementPtr child : elem->getChildren())
+        {
+            addElement(child, index);
+        }
+    }
+
+  public:
+    StringVec strings;
+    vector<BinaryElement> elements;
+    vector<BinaryAttribute> attributes;
+
+  private:
+    std::unordered_map<string, uint32_t> stringIndices;
+};
+
+// A read-only memory mapping of a file.
+class MappedFile
+{
+  public:
+    explicit MappedFile(const FilePath& filename) :
+        _data(nullptr),
+        _size(0)
+    {
+#if defined(_WIN32)
+        _file = CreateFileA(filename.asString().c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        _mapping = NULL;
+        if (_file == INVALID_HANDLE_VALUE)
+        {
+            throw ExceptionFileMissing("Failed to open file for reading: " + filename.asString());
+        }
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(_file, &fileSize) && fileSize.QuadPart > 0)
+        {
+            _size = (size_t) fileSize.QuadPart;
+            _mapping = CreateFileMapping(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (_mapping)
+            {
+                _data = (const char*) MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+            }
+        }
+#else
+        int fd = open(filename.asString().c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw ExceptionFileMissing("Failed to open file for reading: " + filename.asString());
+        }
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+        {
+            _size = (size_t) fileStat.st_size;
+            void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+            _data = (data != MAP_FAILED) ? (const char*) data : nullptr;
+        }
+        close(fd);
+#endif
+        if (!_data)
+        {
+            _size = 0;
+        }
+    }
+
+    ~MappedFile()
+    {
+#if defined(_WIN32)
+        if (_data)
+        {
+            UnmapViewOfFile(_data);
+        }
+        if (_mapping)
+        {
+            CloseHandle(_mapping);
+        }
+        CloseHandle(_file);
+#else
+        if (_data)
+        {
+            munmap((void*) _data, _size);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* getData() const
+    {
+        return _data;
+    }
+
+    size_t getSize() const
+    {
+        return _size;
+    }
+
+  private:
+    const char* _data;
+    size_t _size;
+#if defined(_WIN32)
+    HANDLE _file;
+    HANDLE _mapping;
+#endif
+};
+
+template<class T> T readValue(const char* data, size_t index)
+{
+    T value;
+    std::memcpy(&value, data + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+void documentFromBinary(DocumentPtr doc, const char* buffer, size_t size, const CopyOptions* copyOptions)
+{
+    // Validate the header and table sizes.
+    BinaryHeader header;
+    if (!buffer || size < sizeof(header))
+    {
+        throw ExceptionParseError("Binary document is truncated");
+    }
+    std::memcpy(&header, buffer, sizeof(header));
+    if (std::memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)))
+    {
+        throw ExceptionParseError("Buffer is not a MaterialX binary document");
+    }
+    if (header.version != BINARY_VERSION)
+    {
+        throw ExceptionParseError("Unsupported MaterialX binary version: " + std::to_string(header.version));
+    }
+    const uint64_t offsetTableSize = ((uint64_t) header.stringCount + 1) * sizeof(uint32_t);
+    const uint64_t elementTableSize = (uint64_t) header.elementCount * sizeof(BinaryElement);
+    const uint64_t attributeTableSize = (uint64_t) header.attributeCount * sizeof(BinaryAttribute);
+    if (sizeof(header) + offsetTableSize + elementTableSize + attributeTableSize + header.stringDataSize > size ||
+        header.stringCount == 0 || header.elementCount == 0)
+    {
+        throw ExceptionParseError("Binary document is truncated");
+    }
+    const char* offsetTable = buffer + sizeof(header);
+    const char* elementTable = offsetTable + offsetTableSize;
+    const char* attributeTable = elementTable + elementTableSize;
+    const char* stringData = attributeTable + attributeTableSize;
+
+    // Build the string table.
+    StringVec strings(header.stringCount);
+    uint32_t start = readValue<uint32_t>(offsetTable, 0);
+    for (uint32_t i = 0; i < header.stringCount; i++)
+    {
+        uint32_t end = readValue<uint32_t>(offsetTable, i + 1);
+        if (start > end || end > header.stringDataSize)
+        {
+            throw ExceptionParseError("Invalid string table in binary document");
+        }
+        strings[i].assign(stringData + start, end - start);
+        start = end;
+    }
+    auto getString = [&strings](uint32_t index) -> const string&
+    {
+        if (index >= strings.size())
+        {
+            throw ExceptionParseError("Invalid string index in binary document");
+        }
+        return strings[index];
+    };
+
+    // Validate the element table before the document is modified.
+    vector<uint32_t> parents(header.elementCount);
+    for (uint32_t i = 0; i < header.elementCount; i++)
+    {
+        BinaryElement binaryElem = readValue<BinaryElement>(elementTable, i);
+        if ((uint64_t) binaryElem.firstAttribute + binaryElem.attributeCount > header.attributeCount)
+        {
+            throw ExceptionParseError("Invalid attribute range in binary document");
+        }
+        if (i == 0)
+        {
+            if (binaryElem.parent != NO_PARENT || getString(binaryElem.category) != Document::CATEGORY)
+            {
+                throw ExceptionParseError("Invalid root element in binary document");
+            }
+        }
+        else if (binaryElem.parent >= i)
+        {
+            throw ExceptionParseError("Invalid parent index in binary document");
+        }
+        getString(binaryElem.category);
+        getString(binaryElem.name);
+        getString(binaryElem.sourceUri);
+        for (uint32_t j = 0; j < binaryElem.attributeCount; j++)
+        {
+            BinaryAttribute attr = readValue<BinaryAttribute>(attributeTable, binaryElem.firstAttribute + j);
+            getString(attr.name);
+            getString(attr.value);
+        }
+        parents[i] = binaryElem.parent;
+    }
+
+    // Find elements whose names conflict with a top-level element of the
+    // document or with an earlier sibling.  Conflicting elements and their
+    // descendants are never added to the document.  Since the writer stores
+    // each distinct string once, sibling names are compared by string index.
+    bool skipConflictingElements = copyOptions && copyOptions->skipConflictingElements;
+    vector<char> skipped(header.elementCount, 0);
+    vector<std::pair<uint32_t, ConstElementPtr>> documentConflicts;
+    vector<std::pair<uint32_t, uint32_t>> siblingConflicts;
+    std::unordered_map<uint64_t, uint32_t> siblingNames;
+    siblingNames.reserve(header.elementCount);
+    for (uint32_t i = 1; i < header.elementCount; i++)
+    {
+        if (skipped[parents[i]])
+        {
+            skipped[i] = 1;
+            continue;
+        }
+        uint32_t nameIndex = readValue<BinaryElement>(elementTable, i).name;
+        ConstElementPtr previous = parents[i] ? nullptr : doc->getChild(getString(nameIndex));
+        if (previous)
+        {
+            skipped[i] = 1;
+            if (!skipConflictingElements)
+            {
+                documentConflicts.emplace_back(i, previous);
+            }
+            continue;
+        }
+        auto result = siblingNames.emplace(((uint64_t) parents[i] << 32) | nameIndex, i);
+        if (!result.second)
+        {
+            skipped[i] = 1;
+            if (!skipConflictingElements)
+            {
+                siblingConflicts.emplace_back(i, result.first->second);
+            }
+        }
+    }
+
+    // Create the given element and its attributes within a parent.
+    auto createElement = [&](ElementPtr parent, uint32_t index) -> ElementPtr
+    {
+        BinaryElement binaryElem = readValue<BinaryElement>(elementTable, index);
+        ElementPtr elem = parent->addChildOfCategory(getString(binaryElem.category), getString(binaryElem.name));
+        elem->setSourceUri(getString(binaryElem.sourceUri));
+        for (uint32_t j = 0; j < binaryElem.attributeCount; j++)
+        {
+            BinaryAttribute attr = readValue<BinaryAttribute>(attributeTable, binaryElem.firstAttribute + j);
+            elem->setAttribute(getString(attr.name), getString(attr.value));
+        }
+        return elem;
+    };
+
+    // Create a standalone copy of the subtree at the given index, which is
+    // stored contiguously in depth-first order.
+    auto createSubtree = [&](uint32_t index) -> ElementPtr
+    {
+        DocumentPtr scratch = createDocument();
+        vector<ElementPtr> subtree(1, createElement(scratch, index));
+        for (uint32_t i = index + 1; i < header.elementCount && parents[i] >= index; i++)
+        {
+            subtree.push_back(createElement(subtree[parents[i] - index], i));
+        }
+        return subtree[0];
+    };
+
+    // Verify that conflicting elements match the elements they duplicate.
+    for (const auto& conflict : documentConflicts)
+    {
+        if (*createSubtree(conflict.first) != *conflict.second)
+        {
+            throw Exception("Duplicate element with conflicting content: " + conflict.second->getName());
+        }
+    }
+    for (const auto& conflict : siblingConflicts)
+    {
+        ElementPtr previous = createSubtree(conflict.second);
+        if (*createSubtree(conflict.first) != *previous)
+        {
+            throw Exception("Duplicate element with conflicting content: " + previous->getName());
+        }
+    }
+
+    ScopedUpdate update(doc);
+    doc->onRead();
+
+    // Create each element, whose parent always precedes it in the array.
+    BinaryElement rootElem = readValue<BinaryElement>(elementTable, 0);
+    for (uint32_t j = 0; j < rootElem.attributeCount; j++)
+    {
+        BinaryAttribute attr = readValue<BinaryAttribute>(attributeTable, rootElem.firstAttribute + j);
+        doc->setAttribute(getString(attr.name), getString(attr.value));
+    }
+    vector<ElementPtr> elements(header.elementCount);
+    elements[0] = doc;
+    for (uint32_t i = 1; i < header.elementCount; i++)
+    {
+        if (!skipped[i])
+        {
+            elements[i] = createElement(elements[parents[i]], i);
+        }
+    }
+
+    std::tuple<int, int, int> versionIntegers = getVersionIntegers();
+    doc->upgradeVersion(std::get<0>(versionIntegers), std::get<1>(versionIntegers));
+}
+
+} // anonymous namespace
+
+//
+// Reading
+//
+
+void readFromBinaryBuffer(DocumentPtr doc, const char* buffer, size_t size, const CopyOptions* copyOptions)
+{
+    documentFromBinary(doc, buffer, size, copyOptions);
+}
+
+void readFromBinaryFile(DocumentPtr doc, const FilePath& filename, const FileSearchPath& searchPath, const CopyOptions* copyOptions)
+{
+    FileSearchPath fullSearchPath = searchPath;
+    fullSearchPath.append(getEnvironmentPath());
+    FilePath resolvedFilename = fullSearchPath.find(filename);
+
+    MappedFile mappedFile(resolvedFilename);
+    documentFromBinary(doc, mappedFile.getData(), mappedFile.getSize(), copyOptions);
+    doc->setSourceUri(filename);
+}
+
+//
+// Writing
+//
+
+void writeToBinaryStream(DocumentPtr doc, std::ostream& stream)
+{
+    ScopedUpdate update(doc);
+    doc->onWrite();
+
+    BinaryTables tables;
+    tables.addElement(doc, NO_PARENT);
+
+    // Compute the string offset table.
+    vector<uint32_t> stringOffsets;
+    stringOffsets.reserve(tables.strings.size() + 1);
+    uint64_t stringDataSize = 0;
+    for (const string& str : tables.strings)
+    {
+        stringOffsets.push_back((uint32_t) stringDataSize);
+        stringDataSize += str.size();
+    }
+    stringOffsets.push_back((uint32_t) stringDataSize);
+    if (stringDataSize > std::numeric_limits<uint32_t>::max())
+    {
+        throw Exception("Document is too large for the MaterialX binary format");
+    }
+
+    BinaryHeader header;
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.version = BINARY_VERSION;
+    header.stringCount = (uint32_t) tables.strings.size();
+    header.stringDataSize = (uint32_t) stringDataSize;
+    header.elementCount = (uint32_t) tables.elements.size();
+    header.attributeCount = (uint32_t) tables.attributes.size();
+    header.reserved = 0;
+
+    stream.write((const char*) &header, sizeof(header));
+    stream.write((const char*) stringOffsets.data(), stringOffsets.size() * sizeof(uint32_t));
+    stream.write((const char*) tables.elements.data(), tables.elements.size() * sizeof(BinaryElement));
+    stream.write((const char*) tables.attributes.data(), tables.attributes.size() * sizeof(BinaryAttribute));
+    for (const string& str : tables.strings)
+    {
+        stream.write(str.data(), str.size());
+    }
+    if (!stream)
+    {
+        throw Exception("Failed to write binary document to stream");
+    }
+}
+
+void writeToBinaryFile(DocumentPtr doc, const FilePath& filename)
+{
+    std::ofstream ofs(filename.asString(), std::ios::binary);
+    if (!ofs)
+    {
+        throw ExceptionFileMissing("Failed to open file for writing: " + filename.asString());
+    }
+    writeToBinaryStream(doc, ofs);
+    ofs.close();
+    if (ofs.fail())
+    {
+        throw Exception("Failed to write binary document to file: " + filename.asString());
+    }
+}
+
+} // namespace MaterialX
@@ -0,0 +1,86 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#ifndef MATERIALX_BINARYIO_H
+#define MATERIALX_BINARYIO_H
+
+/// @file
+/// Support for a compact binary representation of MaterialX documents
+///
+/// The binary container stores a document as a shared string table, a flat
+/// array of elements in depth-first order, and a flat array of attributes,
+/// allowing files to be memory-mapped and converted to a Document without
+/// text parsing.  Binary files are intended as a cache of MaterialX content,
+/// such as data libraries, and are not a replacement for the MTLX format.
+
+#include <MaterialXCore/Library.h>
+
+#include <MaterialXCore/Document.h>
+
+#include <MaterialXFormat/XmlIo.h>
+
+namespace MaterialX
+{
+
+extern const string MTLX_BINARY_EXTENSION;
+
+/// @name Read Functions
+/// @{
+
+/// Read a Document from the given buffer in the MaterialX binary format.
+/// @param doc The Document into which data is read.
+/// @param buffer The buffer from which data is read.
+/// @param size The size of the buffer in bytes.
+/// @param copyOptions An optional pointer to a CopyOptions object.
+///    If provided, then the given options will affect the handling of
+///    top-level elements that already exist in the document.  Defaults to a
+///    null pointer.
+/// @throws ExceptionParseError if the buffer cannot be parsed.
+/// @throws Exception if a top-level element conflicts with an existing
+///    element, in which case the document is left unmodified.
+void readFromBinaryBuffer(DocumentPtr doc, const char* buffer, size_t size, const CopyOptions* copyOptions = nullptr);
+
+/// Read a Document from the given filename in the MaterialX binary format.
+/// The file is memory-mapped for the duration of the read.
+/// @param doc The Document into which data is read.
+/// @param filename The filename from which data is read.
+/// @param searchPath An optional sequence of file paths that will be applied
+///    in order when searching for the given file.
+/// @param copyOptions An optional pointer to a CopyOptions object.
+///    If provided, then the given options will affect the handling of
+///    top-level elements that already exist in the document.  Defaults to a
+///    null pointer.
+/// @throws ExceptionParseError if the file cannot be parsed.
+/// @throws ExceptionFileMissing if the file cannot be opened.
+/// @throws Exception if a top-level element conflicts with an existing
+///    element, in which case the document is left unmodified.
+void readFromBinaryFile(DocumentPtr doc,
+                        const FilePath& filename,
+                        const FileSearchPath& searchPath = FileSearchPath(),
+                        const CopyOptions* copyOptions = nullptr);
+
+/// @}
+/// @name Write Functions
+/// @{
+
+/// Write a Document in the MaterialX binary format to the given output stream.
+/// All elements are written as explicit data, with their source URIs preserved.
+/// @param doc The Document to be written.
+/// @param stream The output stream to which data is written.
+/// @throws Exception if the stream enters a failed state.
+void writeToBinaryStream(DocumentPtr doc, std::ostream& stream);
+
+/// Write a Document in the MaterialX binary format to the given filename.
+/// @param doc The Document to be written.
+/// @param filename The filename to which data is written.
+/// @throws ExceptionFileMissing if the file cannot be opened for writing.
+/// @throws Exception if the file cannot be written.
+void writeToBinaryFile(DocumentPtr doc, const FilePath& filename);
+
+/// @}
+
+} // namespace MaterialX
+
+#endif
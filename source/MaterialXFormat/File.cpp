@@ -138,6 +138,24 @@ bool FilePath::isDirectory() const
 #endif
 }
 
+int64_t FilePath::getModificationTime() const
+{
+#if defined(_WIN32)
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesEx(asString().c_str(), GetFileExInfoStandard, &data))
+        return 0;
+    ULARGE_INTEGER time;
+    time.LowPart = data.ftLastWriteTime.dwLowDateTime;
+    time.HighPart = data.ftLastWriteTime.dwHighDateTime;
+    return (int64_t) (time.QuadPart / 10000000ULL) - 11644473600LL;
+#else
+    struct stat sb;
+    if (stat(asString().c_str(), &sb))
+        return 0;
+    return (int64_t) sb.st_mtime;
+#endif
+}
+
 FilePathVec FilePath::getFilesInDirectory(const string& extension) const
 {
     FilePathVec files;
@@ -266,6 +284,21 @@ FilePath FilePath::getCurrentPath()
 #endif
 }
 
+FilePath FilePath::getTempPath()
+{
+#if defined(_WIN32)
+    std::array<char, MAX_PATH + 1> buf;
+    if (!GetTempPath(MAX_PATH + 1, buf.data()))
+    {
+        throw Exception("Error in getTempPath: " + std::to_string(GetLastError()));
+    }
+    return FilePath(buf.data());
+#else
+    string tempDir = getEnviron("TMPDIR");
+    return FilePath(tempDir.empty() ? "/tmp" : tempDir);
+#endif
+}
+
 FileSearchPath getEnvironmentPath(const string& sep)
 {
     string searchPathEnv = getEnviron(MATERIALX_SEARCH_PATH_ENV_VAR);
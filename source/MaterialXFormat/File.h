@@ -11,6 +11,8 @@
 
 #include <MaterialXCore/Util.h>
 
+#include <cstdint>
+
 namespace MaterialX
 {
 
@@ -144,6 +146,10 @@ class FilePath
     /// Return true if the given path is a directory on the file system.
     bool isDirectory() const;
 
+    /// Return the last modification time of the file at the given path, in
+    /// seconds since the epoch, or zero if the path does not exist.
+    int64_t getModificationTime() const;
+
     /// Return a vector of all files in the given directory with the given extension.
     FilePathVec getFilesInDirectory(const string& extension) const;
 
@@ -158,6 +164,9 @@ class FilePath
     /// Return the current working directory of the file system.
     static FilePath getCurrentPath();
 
+    /// Return the directory for temporary files on the file system.
+    static FilePath getTempPath();
+
   private:
     StringVec _vec;
     Type _type;
@@ -9,9 +9,12 @@
 
 #include <MaterialXCore/Types.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <fstream>
 #include <sstream>
+#include <thread>
 
 using namespace pugi;
 
@@ -25,6 +28,8 @@ namespace {
 const string XINCLUDE_TAG = "xi:include";
 const string XINCLUDE_NAMESPACE = "xmlns:xi";
 const string XINCLUDE_URL = "http://www.w3.org/2001/XInclude";
+const string XML_DECLARATION = "<?xml version=\"1.0\"?>\n";
+const string XML_ANONYMOUS_TAG = ":anonymous";
 
 void elementFromXml(const xml_node& xmlNode, ElementPtr elem, const XmlReadOptions* readOptions)
 {
@@ -72,52 +77,170 @@ void elementFromXml(const xml_node& xmlNode, ElementPtr elem, const XmlReadOptio
     }
 }
 
-void elementToXml(ConstElementPtr elem, xml_node& xmlNode, const XmlWriteOptions* writeOptions)
+// A buffered writer that emits XML text directly from the element tree,
+// matching the indented output format of pugixml.
+class XmlStreamWriter
 {
-    bool writeXIncludeEnable = writeOptions ? writeOptions->writeXIncludeEnable : true;
-    ElementPredicate elementPredicate = writeOptions ? writeOptions->elementPredicate : nullptr;
+  public:
+    explicit XmlStreamWriter(std::ostream& stream) :
+        _stream(stream)
+    {
+        _buffer.reserve(BUFFER_SIZE);
+    }
 
-    // Store attributes in XML.
-    if (!elem->getName().empty())
+    ~XmlStreamWriter()
     {
-        xmlNode.append_attribute(Element::NAME_ATTRIBUTE.c_str()) = elem->getName().c_str();
+        flush();
     }
-    for (const string& attrName : elem->getAttributeNames())
+
+    void write(const string& str)
     {
-        xml_attribute xmlAttr = xmlNode.append_attribute(attrName.c_str());
-        xmlAttr.set_value(elem->getAttribute(attrName).c_str());
+        _buffer.append(str);
+        flushIfFull();
     }
 
-    // Create child nodes and recurse.
-    StringSet writtenSourceFiles;
-    for (const ConstElementPtr& child : elem->getChildren())
+    void write(const char* str)
+    {
+        _buffer.append(str);
+        flushIfFull();
+    }
+
+    void writeIndent(size_t depth)
+    {
+        _buffer.append(depth * XML_INDENT_WIDTH, ' ');
+    }
+
+    // Write an attribute value, escaping special characters.
+    void writeEscaped(const string& str)
+    {
+        for (char c : str)
+        {
+            switch (c)
+            {
+                case '&':
+                    _buffer.append("&amp;");
+                    break;
+                case '"':
+                    _buffer.append("&quot;");
+                    break;
+                default:
+                    if ((unsigned char) c < 32 && c != '\t')
+                    {
+                        _buffer.append("&#");
+                        _buffer.push_back((char) ('0' + c / 10));
+                        _buffer.push_back((char) ('0' + c % 10));
+                        _buffer.push_back(';');
+                    }
+                    else
+                    {
+                        _buffer.push_back(c);
+                    }
+            }
+        }
+        flushIfFull();
+    }
+
+    void writeAttribute(const string& name, const string& value)
+    {
+        _buffer.push_back(' ');
+        _buffer.append(name);
+        _buffer.append("=\"");
+        writeEscaped(value);
+        _buffer.push_back('"');
+    }
+
+    void flush()
+    {
+        _stream.write(_buffer.data(), _buffer.size());
+        _buffer.clear();
+    }
+
+  private:
+    void flushIfFull()
+    {
+        if (_buffer.size() >= BUFFER_SIZE)
+        {
+            flush();
+        }
+    }
+
+  private:
+    static const size_t BUFFER_SIZE = 64 * 1024;
+    static const size_t XML_INDENT_WIDTH = 2;
+
+    std::ostream& _stream;
+    string _buffer;
+};
+
+void elementToXml(ConstElementPtr elem, const string& tag, XmlStreamWriter& writer, size_t depth, const XmlWriteOptions* writeOptions)
+{
+    bool writeXIncludeEnable = writeOptions ? writeOptions->writeXIncludeEnable : true;
+    const ElementPredicate& elementPredicate = writeOptions ? writeOptions->elementPredicate : nullptr;
+    const string& docSourceUri = elem->getDocument()->getSourceUri();
+
+    // Determine which children will be written, and whether any of them
+    // will be written as XInclude references.
+    vector<ConstElementPtr> children;
+    bool hasXIncludes = false;
+    for (const ElementPtr& child : elem->getChildren())
     {
         if (elementPredicate && !elementPredicate(child))
         {
             continue;
         }
+        children.push_back(child);
+        if (writeXIncludeEnable && child->hasSourceUri() && child->getSourceUri() != docSourceUri)
+        {
+            hasXIncludes = true;
+        }
+    }
+
+    // Write the start tag and attributes.
+    writer.writeIndent(depth);
+    writer.write("<");
+    writer.write(tag);
+    if (!elem->getName().empty())
+    {
+        writer.writeAttribute(Element::NAME_ATTRIBUTE, elem->getName());
+    }
+    for (const Element::Attribute& attr : elem->getAttributes())
+    {
+        writer.writeAttribute(attr.getName(), attr.getValue());
+    }
+    if (hasXIncludes && !elem->hasAttribute(XINCLUDE_NAMESPACE))
+    {
+        writer.writeAttribute(XINCLUDE_NAMESPACE, XINCLUDE_URL);
+    }
+    if (children.empty())
+    {
+        writer.write(" />\n");
+        return;
+    }
+    writer.write(">\n");
 
+    // Write child elements and recurse.
+    StringSet writtenSourceFiles;
+    for (const ConstElementPtr& child : children)
+    {
         // Write XInclude references if requested.
         if (writeXIncludeEnable && child->hasSourceUri())
         {
-            string sourceUri = child->getSourceUri();
-            if (sourceUri != elem->getDocument()->getSourceUri())
+            const string& sourceUri = child->getSourceUri();
+            if (sourceUri != docSourceUri)
             {
                 if (!writtenSourceFiles.count(sourceUri))
                 {
-                    if (!xmlNode.attribute(XINCLUDE_NAMESPACE.c_str()))
-                    {
-                        xmlNode.append_attribute(XINCLUDE_NAMESPACE.c_str()) = XINCLUDE_URL.c_str();
-                    }
-                    xml_node includeNode = xmlNode.append_child(XINCLUDE_TAG.c_str());
-                    xml_attribute includeAttr = includeNode.append_attribute("href");
-                    FilePath includePath(sourceUri);
-
                     // Write relative include paths in Posix format, and absolute
                     // include paths in native format.
+                    FilePath includePath(sourceUri);
                     FilePath::Format includeFormat = includePath.isAbsolute() ?
                         FilePath::FormatNative : FilePath::FormatPosix;
-                    includeAttr.set_value(includePath.asString(includeFormat).c_str());
+
+                    writer.writeIndent(depth + 1);
+                    writer.write("<");
+                    writer.write(XINCLUDE_TAG);
+                    writer.writeAttribute("href", includePath.asString(includeFormat));
+                    writer.write(" />\n");
 
                     writtenSourceFiles.insert(sourceUri);
                 }
@@ -125,9 +248,15 @@ void elementToXml(ConstElementPtr elem, xml_node& xmlNode, const XmlWriteOptions
             }
         }
 
-        xml_node xmlChild = xmlNode.append_child(child->getCategory().c_str());
-        elementToXml(child, xmlChild, writeOptions);
+        const string& category = child->getCategory();
+        elementToXml(child, category.empty() ? XML_ANONYMOUS_TAG : category, writer, depth + 1, writeOptions);
     }
+
+    // Write the end tag.
+    writer.writeIndent(depth);
+    writer.write("</");
+    writer.write(tag);
+    writer.write(">\n");
 }
 
 void xmlDocumentFromFile(xml_document& xmlDoc, FilePath filename, FileSearchPath searchPath)
@@ -153,12 +282,41 @@ void xmlDocumentFromFile(xml_document& xmlDoc, FilePath filename, FileSearchPath
     }
 }
 
-void processXIncludes(DocumentPtr doc, xml_node& xmlNode, const FileSearchPath& searchPath, const XmlReadOptions* readOptions)
+// Read a single XInclude reference into a new library document.
+DocumentPtr readXInclude(const string& filename,
+                         const FileSearchPath& includeSearchPath,
+                         const XmlReadFunction& readXIncludeFunction,
+                         const XmlReadOptions* readOptions)
 {
-    // Search path for includes. Set empty and then evaluated once in the iteration through xml includes.
-    FileSearchPath includeSearchPath;
+    // Check for XInclude cycles.
+    if (readOptions)
+    {
+        const StringVec& parents = readOptions->parentXIncludes;
+        if (std::find(parents.begin(), parents.end(), filename) != parents.end())
+        {
+            throw ExceptionParseError("XInclude cycle detected.");
+        }
+    }
+
+    // Read the included file into a library document.
+    DocumentPtr library = createDocument();
+    XmlReadOptions xiReadOptions = readOptions ? *readOptions : XmlReadOptions();
+    xiReadOptions.parentXIncludes.push_back(filename);
+
+    // Nested references are read serially on the calling thread, so that
+    // the thread count is bounded by the top-level read.
+    xiReadOptions.parallelXIncludes = false;
+    readXIncludeFunction(library, filename, includeSearchPath, &xiReadOptions);
+    return library;
+}
 
+void processXIncludes(DocumentPtr doc, xml_node& xmlNode, const FileSearchPath& searchPath, const XmlReadOptions* readOptions)
+{
     XmlReadFunction readXIncludeFunction = readOptions ? readOptions->readXIncludeFunction : readFromXmlFile;
+
+    // Gather XInclude references in document order, removing the include
+    // directives from the XML tree.
+    StringVec filenames;
     xml_node xmlChild = xmlNode.first_child();
     while (xmlChild)
     {
@@ -167,48 +325,7 @@ void processXIncludes(DocumentPtr doc, xml_node& xmlNode, const FileSearchPath&
             // Read XInclude references if requested.
             if (readXIncludeFunction)
             {
-                string filename = xmlChild.attribute("href").value();
-
-                // Check for XInclude cycles.
-                if (readOptions)
-                {
-                    const StringVec& parents = readOptions->parentXIncludes;
-                    if (std::find(parents.begin(), parents.end(), filename) != parents.end())
-                    {
-                        throw ExceptionParseError("XInclude cycle detected.");
-                    }
-                }
-
-                // Read the included file into a library document.
-                DocumentPtr library = createDocument();
-                XmlReadOptions xiReadOptions = readOptions ? *readOptions : XmlReadOptions();
-                xiReadOptions.parentXIncludes.push_back(filename);
-
-                // Prepend the directory of the parent to accommodate
-                // includes relative to the parent file location.
-                if (includeSearchPath.isEmpty())
-                {
-                    string parentUri = doc->getSourceUri();
-                    if (!parentUri.empty())
-                    {
-                        FilePath filePath = searchPath.find(parentUri);
-                        if (!filePath.isEmpty())
-                        {
-                            // Remove the file name from the path as we want the path to the containing folder.
-                            includeSearchPath = searchPath;
-                            includeSearchPath.prepend(filePath.getParentPath());
-                        }
-                    }
-                    // Set default search path if no parent path found
-                    if (includeSearchPath.isEmpty())
-                    {
-                        includeSearchPath = searchPath;
-                    }
-                }
-                readXIncludeFunction(library, filename, includeSearchPath, &xiReadOptions);
-
-                // Import the library document.
-                doc->importLibrary(library, readOptions);
+                filenames.push_back(xmlChild.attribute("href").value());
             }
 
             // Remove include directive.
@@ -221,6 +338,83 @@ void processXIncludes(DocumentPtr doc, xml_node& xmlNode, const FileSearchPath&
             xmlChild = xmlChild.next_sibling();
         }
     }
+    if (filenames.empty())
+    {
+        return;
+    }
+
+    // Prepend the directory of the parent to accommodate includes relative
+    // to the parent file location.
+    FileSearchPath includeSearchPath;
+    string parentUri = doc->getSourceUri();
+    if (!parentUri.empty())
+    {
+        FilePath filePath = searchPath.find(parentUri);
+        if (!filePath.isEmpty())
+        {
+            // Remove the file name from the path as we want the path to the containing folder.
+            includeSearchPath = searchPath;
+            includeSearchPath.prepend(filePath.getParentPath());
+        }
+    }
+    // Set default search path if no parent path found
+    if (includeSearchPath.isEmpty())
+    {
+        includeSearchPath = searchPath;
+    }
+
+    if (readOptions && readOptions->parallelXIncludes && filenames.size() > 1)
+    {
+        // Read all references concurrently on a bounded set of threads,
+        // each of which claims the next unread reference in turn.
+        vector<DocumentPtr> libraries(filenames.size());
+        vector<std::exception_ptr> errors(filenames.size());
+        std::atomic<size_t> nextIndex(0);
+        auto readReferences = [&]()
+        {
+            for (size_t i = nextIndex++; i < filenames.size(); i = nextIndex++)
+            {
+                try
+                {
+                    libraries[i] = readXInclude(filenames[i], includeSearchPath, readXIncludeFunction, readOptions);
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            }
+        };
+        size_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+        threadCount = std::min(threadCount, filenames.size());
+        vector<std::thread> threads;
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            threads.emplace_back(readReferences);
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        // Import the library documents in document order, reporting the
+        // first error as a serial read would.
+        for (size_t i = 0; i < filenames.size(); i++)
+        {
+            if (errors[i])
+            {
+                std::rethrow_exception(errors[i]);
+            }
+            doc->importLibrary(libraries[i], readOptions);
+        }
+    }
+    else
+    {
+        for (const string& filename : filenames)
+        {
+            DocumentPtr library = readXInclude(filename, includeSearchPath, readXIncludeFunction, readOptions);
+            doc->importLibrary(library, readOptions);
+        }
+    }
 }
 
 void documentFromXml(DocumentPtr doc,
@@ -258,7 +452,8 @@ void documentFromXml(DocumentPtr doc,
 //
 
 XmlReadOptions::XmlReadOptions() :
-    readXIncludeFunction(readFromXmlFile)
+    readXIncludeFunction(readFromXmlFile),
+    parallelXIncludes(false)
 {
     std::tuple<int, int, int> versionIntegers = getVersionIntegers();
     desiredMajorVersion = std::get<0>(versionIntegers);
@@ -335,10 +530,9 @@ void writeToXmlStream(DocumentPtr doc, std::ostream& stream, const XmlWriteOptio
     ScopedUpdate update(doc);
     doc->onWrite();
 
-    xml_document xmlDoc;
-    xml_node xmlRoot = xmlDoc.append_child("materialx");
-    elementToXml(doc, xmlRoot, writeOptions);
-    xmlDoc.save(stream, "  ");
+    XmlStreamWriter writer(stream);
+    writer.write(XML_DECLARATION);
+    elementToXml(doc, Document::CATEGORY, writer, 0, writeOptions);
 }
 
 void writeToXmlFile(DocumentPtr doc, const FilePath& filename, const XmlWriteOptions* writeOptions)
@@ -42,6 +42,15 @@ class XmlReadOptions : public CopyOptions
     /// Defaults to an empty vector.
     StringVec parentXIncludes;
 
+    /// If true, then the XInclude references of the top-level document are
+    /// read concurrently on up to std::thread::hardware_concurrency()
+    /// threads, and are then imported in document order, with the same
+    /// handling of conflicting elements as a serial read.  Nested references
+    /// are read serially by the thread that reads their parent.  When enabled,
+    /// readXIncludeFunction must be safe to call from multiple threads.
+    /// Defaults to false.
+    bool parallelXIncludes;
+
     /// Desired major version on read. By default this is the same as the library version
     int desiredMajorVersion;
 
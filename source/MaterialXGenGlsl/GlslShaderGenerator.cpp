@@ -283,6 +283,8 @@ GlslShaderGenerator::GlslShaderGenerator() :
 
 ShaderPtr GlslShaderGenerator::generate(const string& name, ElementPtr element, GenContext& context) const
 {
+    ScopedGenTimer timer(context, "generate", name);
+
     ShaderPtr shader = createShader(name, element, context);
 
     // Turn on fixed float formatting to make sure float values are
@@ -293,12 +295,12 @@ ShaderPtr GlslShaderGenerator::generate(const string& name, ElementPtr element,
     // Emit code for vertex shader stage
     ShaderStage& vs = shader->getStage(Stage::VERTEX);
     emitVertexStage(shader->getGraph(), context, vs);
-    replaceTokens(_tokenSubstitutions, vs);
+    replaceTokens(_tokenSubstitutions, context, vs);
 
     // Emit code for pixel shader stage
     ShaderStage& ps = shader->getStage(Stage::PIXEL);
     emitPixelStage(shader->getGraph(), context, ps);
-    replaceTokens(_tokenSubstitutions, ps);
+    replaceTokens(_tokenSubstitutions, context, ps);
 
     return shader;
 }
@@ -487,11 +489,11 @@ void GlslShaderGenerator::emitPixelStage(const ShaderGraph& graph, GenContext& c
     // depending on the vertical flip flag.
     if (context.getOptions().fileTextureVerticalFlip)
     {
-        _tokenSubstitutions[ShaderGenerator::T_FILE_TRANSFORM_UV] = "stdlib/" + GlslShaderGenerator::LANGUAGE + "/lib/mx_transform_uv_vflip.glsl";
+        context.setTokenSubstitution(ShaderGenerator::T_FILE_TRANSFORM_UV, "stdlib/" + GlslShaderGenerator::LANGUAGE + "/lib/mx_transform_uv_vflip.glsl");
     }
     else
     {
-        _tokenSubstitutions[ShaderGenerator::T_FILE_TRANSFORM_UV] = "stdlib/" + GlslShaderGenerator::LANGUAGE + "/lib/mx_transform_uv.glsl";
+        context.setTokenSubstitution(ShaderGenerator::T_FILE_TRANSFORM_UV, "stdlib/" + GlslShaderGenerator::LANGUAGE + "/lib/mx_transform_uv.glsl");
     }
 
     // Emit uv transform code globally if needed.
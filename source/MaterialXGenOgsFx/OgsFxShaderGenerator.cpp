@@ -90,6 +90,8 @@ ShaderGeneratorPtr OgsFxShaderGenerator::create()
 
 ShaderPtr OgsFxShaderGenerator::generate(const string& name, ElementPtr element, GenContext& context) const
 {
+    ScopedGenTimer timer(context, "generate", name);
+
     ShaderPtr shader = createShader(name, element, context);
 
     // Turn on fixed formatting since OgsFx doesn't support scientific values
@@ -102,9 +104,9 @@ ShaderPtr OgsFxShaderGenerator::generate(const string& name, ElementPtr element,
 
     // Emit code for vertex and pixel shader stages
     emitVertexStage(graph, context, vs);
-    replaceTokens(_tokenSubstitutions, vs);
+    replaceTokens(_tokenSubstitutions, context, vs);
     emitPixelStage(graph, context, ps);
-    replaceTokens(_tokenSubstitutions, ps);
+    replaceTokens(_tokenSubstitutions, context, ps);
 
     //
     // Assemble the final effects shader
@@ -244,7 +246,7 @@ ShaderPtr OgsFxShaderGenerator::generate(const string& name, ElementPtr element,
     emitScopeEnd(fx);
     emitLineBreak(fx);
 
-    replaceTokens(_tokenSubstitutions, fx);
+    replaceTokens(_tokenSubstitutions, context, fx);
 
     return shader;
 }
@@ -317,11 +319,11 @@ void OgsFxShaderGenerator::emitPixelStage(const ShaderGraph& graph, GenContext&
     // depending on the vertical flip flag.
     if (context.getOptions().fileTextureVerticalFlip)
     {
-        _tokenSubstitutions[ShaderGenerator::T_FILE_TRANSFORM_UV] = "stdlib/" + GlslShaderGenerator::LANGUAGE + "/lib/mx_transform_uv_vflip.glsl";
+        context.setTokenSubstitution(ShaderGenerator::T_FILE_TRANSFORM_UV, "stdlib/" + GlslShaderGenerator::LANGUAGE + "/lib/mx_transform_uv_vflip.glsl");
     }
     else
     {
-        _tokenSubstitutions[ShaderGenerator::T_FILE_TRANSFORM_UV] = "stdlib/" + GlslShaderGenerator::LANGUAGE + "/lib/mx_transform_uv.glsl";
+        context.setTokenSubstitution(ShaderGenerator::T_FILE_TRANSFORM_UV, "stdlib/" + GlslShaderGenerator::LANGUAGE + "/lib/mx_transform_uv.glsl");
     }
 
     // Emit environment lighting functions
@@ -70,6 +70,8 @@ ShaderPtr GlslFragmentGenerator::createShader(const string& name, ElementPtr ele
 
 ShaderPtr GlslFragmentGenerator::generate(const string& fragmentName, ElementPtr element, GenContext& context) const
 {
+    ScopedGenTimer timer(context, "generate", fragmentName);
+
     ShaderPtr shader = createShader(fragmentName, element, context);
 
     ShaderStage& pixelStage = shader->getStage(Stage::PIXEL);
@@ -161,8 +163,8 @@ ShaderPtr GlslFragmentGenerator::generate(const string& fragmentName, ElementPtr
 
     // Set the include file to use for uv transformations,
     // depending on the vertical flip flag.
-    _tokenSubstitutions[ShaderGenerator::T_FILE_TRANSFORM_UV] = "stdlib/" + GlslShaderGenerator::LANGUAGE +
-        (context.getOptions().fileTextureVerticalFlip ? "/lib/mx_transform_uv_vflip.glsl": "/lib/mx_transform_uv.glsl");
+    context.setTokenSubstitution(ShaderGenerator::T_FILE_TRANSFORM_UV, "stdlib/" + GlslShaderGenerator::LANGUAGE +
+        (context.getOptions().fileTextureVerticalFlip ? "/lib/mx_transform_uv_vflip.glsl": "/lib/mx_transform_uv.glsl"));
 
     // Add all functions for node implementations
     emitFunctionDefinitions(graph, context, pixelStage);
@@ -343,7 +345,7 @@ ShaderPtr GlslFragmentGenerator::generate(const string& fragmentName, ElementPtr
     emitScopeEnd(pixelStage);
 
     // Replace all tokens with real identifier names
-    replaceTokens(_tokenSubstitutions, pixelStage);
+    replaceTokens(_tokenSubstitutions, context, pixelStage);
 
     // Now emit uniform definitions to a special stage which is only
     // consumed by the HLSL cross-compiler.
@@ -400,7 +402,7 @@ ShaderPtr GlslFragmentGenerator::generate(const string& fragmentName, ElementPtr
     emitUniformBlock(pixelStage.getUniformBlock(HW::PRIVATE_UNIFORMS));
     emitUniformBlock(pixelStage.getUniformBlock(HW::PUBLIC_UNIFORMS));
 
-    replaceTokens(_tokenSubstitutions, uniformsStage);
+    replaceTokens(_tokenSubstitutions, context, uniformsStage);
 
     return shader;
 }
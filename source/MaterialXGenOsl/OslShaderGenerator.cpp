@@ -190,6 +190,8 @@ OslShaderGenerator::OslShaderGenerator() :
 
 ShaderPtr OslShaderGenerator::generate(const string& name, ElementPtr element, GenContext& context) const
 {
+    ScopedGenTimer timer(context, "generate", name);
+
     ShaderPtr shader = createShader(name, element, context);
 
     ShaderGraph& graph = shader->getGraph();
@@ -213,11 +215,11 @@ ShaderPtr OslShaderGenerator::generate(const string& name, ElementPtr element, G
     // depending on the vertical flip flag.
     if (context.getOptions().fileTextureVerticalFlip)
     {
-        _tokenSubstitutions[ShaderGenerator::T_FILE_TRANSFORM_UV] = "stdlib/" + OslShaderGenerator::LANGUAGE + "/lib/mx_transform_uv_vflip.osl";
+        context.setTokenSubstitution(ShaderGenerator::T_FILE_TRANSFORM_UV, "stdlib/" + OslShaderGenerator::LANGUAGE + "/lib/mx_transform_uv_vflip.osl");
     }
     else
     {
-        _tokenSubstitutions[ShaderGenerator::T_FILE_TRANSFORM_UV] = "stdlib/" + OslShaderGenerator::LANGUAGE + "/lib/mx_transform_uv.osl";
+        context.setTokenSubstitution(ShaderGenerator::T_FILE_TRANSFORM_UV, "stdlib/" + OslShaderGenerator::LANGUAGE + "/lib/mx_transform_uv.osl");
     }
 
     // Emit function definitions for all nodes
@@ -283,7 +285,7 @@ ShaderPtr OslShaderGenerator::generate(const string& name, ElementPtr element, G
     emitScopeEnd(stage);
 
     // Perform token substitution
-    replaceTokens(_tokenSubstitutions, stage);
+    replaceTokens(_tokenSubstitutions, context, stage);
 
     return shader;
 }
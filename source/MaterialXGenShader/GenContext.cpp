@@ -5,10 +5,115 @@
 
 #include <MaterialXGenShader/GenContext.h>
 #include <MaterialXGenShader/ShaderGenerator.h>
+#include <MaterialXGenShader/UnitSystem.h>
+
+#include <map>
+#include <sstream>
 
 namespace MaterialX
 {
 
+namespace {
+
+// Return the key of the given implementation in a shared implementation
+// cache, combining the state of the context that affects its initialization.
+string getImplementationKey(const string& name, GenContext& context)
+{
+    const ShaderGenerator& generator = context.getShaderGenerator();
+    const GenOptions& options = context.getOptions();
+    std::ostringstream key;
+    key << generator.getTarget() << '|'
+        << options.shaderInterfaceType << '|'
+        << options.fileTextureVerticalFlip << '|'
+        << options.targetColorSpaceOverride << '|'
+        << options.targetDistanceUnit << '|'
+        << options.hwTransparency << '|'
+        << options.hwSpecularEnvironmentMethod << '|'
+        << options.hwWriteDepthMoments << '|'
+        << options.hwShadowMap << '|'
+        << options.hwAmbientOcclusion << '|'
+        << options.hwMaxActiveLightSources << '|'
+        << options.hwNormalizeUdimTexCoords << '|'
+        << context.getSourceCodeSearchPath().asString() << '|';
+
+    // Color and unit transforms inserted into compound implementations
+    // depend on the color management and unit systems of the generator.
+    ColorManagementSystemPtr cms = generator.getColorManagementSystem();
+    key << (cms ? cms->getName() : EMPTY_STRING) << '|';
+    UnitSystemPtr unitSystem = generator.getUnitSystem();
+    key << (unitSystem ? unitSystem->getName() : EMPTY_STRING) << '|';
+    UnitConverterRegistryPtr unitRegistry = unitSystem ? unitSystem->getUnitConverterRegistry() : nullptr;
+    if (unitRegistry)
+    {
+        // Registered unit scales, sorted since registries are unordered.
+        std::map<string, float> unitScales;
+        for (const auto& it : unitRegistry->getUnitConverters())
+        {
+            LinearUnitConverterPtr linearConverter = std::dynamic_pointer_cast<LinearUnitConverter>(it.second);
+            if (linearConverter)
+            {
+                for (const auto& scale : linearConverter->getUnitScale())
+                {
+                    unitScales[it.first + ':' + scale.first] = scale.second;
+                }
+            }
+        }
+        for (const auto& scale : unitScales)
+        {
+            key << scale.first << '=' << scale.second << ',';
+        }
+        key << '|';
+    }
+
+    key << name;
+    return key.str();
+}
+
+} // anonymous namespace
+
+//
+// ShaderNodeImplCache methods
+//
+
+ShaderNodeImplPtr ShaderNodeImplCache::getOrCreate(const string& name, GenContext& context, const CreatorFunction& creator)
+{
+    const string key = getImplementationKey(name, context);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _nodeImpls.find(key);
+        if (it != _nodeImpls.end())
+        {
+            return it->second;
+        }
+    }
+
+    // Create the implementation outside of the lock, since its creation
+    // may request further implementations, then keep the first one stored.
+    ShaderNodeImplPtr impl = creator();
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _nodeImpls.emplace(key, impl).first->second;
+}
+
+ShaderNodeImplPtr ShaderNodeImplCache::find(const string& name, GenContext& context) const
+{
+    const string key = getImplementationKey(name, context);
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _nodeImpls.find(key);
+    return it != _nodeImpls.end() ? it->second : nullptr;
+}
+
+size_t ShaderNodeImplCache::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _nodeImpls.size();
+}
+
+void ShaderNodeImplCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _nodeImpls.clear();
+}
+
 //
 // GenContext methods
 //
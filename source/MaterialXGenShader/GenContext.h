@@ -12,14 +12,18 @@
 #include <MaterialXGenShader/Library.h>
 
 #include <MaterialXGenShader/GenOptions.h>
+#include <MaterialXGenShader/GenProfiler.h>
 #include <MaterialXGenShader/ShaderNode.h>
 
 #include <MaterialXFormat/File.h>
 
+#include <mutex>
+
 namespace MaterialX
 {
 
 class GenUserData;
+class ShaderNodeImplCache;
 
 /// Shared pointer to a GenUserData
 using GenUserDataPtr = std::shared_ptr<GenUserData>;
@@ -27,6 +31,9 @@ using GenUserDataPtr = std::shared_ptr<GenUserData>;
 /// Shared pointer to a constant GenUserData
 using ConstGenUserDataPtr = std::shared_ptr<const GenUserData>;
 
+/// Shared pointer to a ShaderNodeImplCache
+using ShaderNodeImplCachePtr = std::shared_ptr<ShaderNodeImplCache>;
+
 /// @class GenUserData 
 /// Base class for custom user data needed during shader generation.
 class GenUserData : public std::enable_shared_from_this<GenUserData>
@@ -62,6 +69,54 @@ class GenUserData : public std::enable_shared_from_this<GenUserData>
     GenUserData() { }
 };
 
+/// @class ShaderNodeImplCache
+/// A thread-safe cache of initialized shader node implementations, which
+/// may be shared between generation contexts to avoid initializing the same
+/// implementations in each context.
+///
+/// Implementations are keyed by implementation name, along with the shader
+/// generator target, color management system, unit system and registered
+/// unit converters, and the generation options and source code search path
+/// of the requesting context, since these affect the initialization of
+/// implementations.  All contexts sharing a cache are expected to use the
+/// same data libraries.  Cached implementations are immutable once
+/// initialized, and may be used concurrently from multiple threads, each with
+/// its own GenContext.
+class ShaderNodeImplCache
+{
+  public:
+    /// A function that creates and initializes an implementation.
+    using CreatorFunction = std::function<ShaderNodeImplPtr()>;
+
+    /// Create a new implementation cache.
+    static ShaderNodeImplCachePtr create()
+    {
+        return std::make_shared<ShaderNodeImplCache>();
+    }
+
+    /// Return the cached implementation with the given name for the given
+    /// context, calling the given function to create it if it is not yet
+    /// cached.  Creation runs without holding the cache lock, so that
+    /// threads creating different implementations proceed concurrently.  If
+    /// two threads create the same implementation, the first one to be
+    /// stored is returned to both.
+    ShaderNodeImplPtr getOrCreate(const string& name, GenContext& context, const CreatorFunction& creator);
+
+    /// Return the cached implementation with the given name for the given
+    /// context, or nullptr if no implementation is cached.
+    ShaderNodeImplPtr find(const string& name, GenContext& context) const;
+
+    /// Return the number of cached implementations.
+    size_t size() const;
+
+    /// Clear all cached implementations.
+    void clear();
+
+  protected:
+    mutable std::mutex _mutex;
+    std::unordered_map<string, ShaderNodeImplPtr> _nodeImpls;
+};
+
 /// @class GenContext 
 /// A context class for shader generation.
 /// Used for thread local storage of data needed during shader generation.
@@ -101,6 +156,12 @@ class GenContext
         _sourceCodeSearchPath.append(path);
     }
 
+    /// Return the search path used for finding source code.
+    const FileSearchPath& getSourceCodeSearchPath() const
+    {
+        return _sourceCodeSearchPath;
+    }
+
     /// Resolve a file using the registered search paths.
     FilePath resolveSourceFile(const FilePath& filename) const
     {
@@ -129,8 +190,52 @@ class GenContext
     ShaderNodeImplPtr findNodeImplementation(const string& name) const;
 
     /// Clear all cached shader node implementation.
+    /// Implementations held by a shared implementation cache are unaffected.
     void clearNodeImplementations();
 
+    /// Set a shared implementation cache for this context.  Implementations
+    /// that are not yet cached by this context are taken from the shared
+    /// cache, or created and added to it, allowing contexts on multiple
+    /// threads to share the cost of initializing implementations.
+    void setNodeImplementationCache(ShaderNodeImplCachePtr cache)
+    {
+        _nodeImplCache = cache;
+    }
+
+    /// Return the shared implementation cache for this context, if any.
+    ShaderNodeImplCachePtr getNodeImplementationCache() const
+    {
+        return _nodeImplCache;
+    }
+
+    /// Set a profiler for this context, recording the timing of generation
+    /// phases and generation counters.  The profiler may be shared between
+    /// contexts on multiple threads.  Set to nullptr to disable profiling.
+    void setProfiler(GenProfilerPtr profiler)
+    {
+        _profiler = profiler;
+    }
+
+    /// Return the profiler for this context, if any.
+    const GenProfilerPtr& getProfiler() const
+    {
+        return _profiler;
+    }
+
+    /// Set a token substitution for this context.  Context substitutions
+    /// are applied to include filenames ahead of those of the shader
+    /// generator, and hold substitutions that depend on generation options.
+    void setTokenSubstitution(const string& token, const string& substitution)
+    {
+        _tokenSubstitutions[token] = substitution;
+    }
+
+    /// Return the token substitutions for this context.
+    const StringMap& getTokenSubstitutions() const
+    {
+        return _tokenSubstitutions;
+    }
+
     /// Add user data to the context to make it
     /// available during shader generator.
     void pushUserData(const string& name, GenUserDataPtr data)
@@ -209,9 +314,18 @@ class GenContext
     // Set of globally reserved words.
     StringSet _reservedWords;
 
+    // Token substitutions for this context.
+    StringMap _tokenSubstitutions;
+
     // Cached shader node implementations.
     std::unordered_map<string, ShaderNodeImplPtr> _nodeImpls;
 
+    // Shared cache of shader node implementations.
+    ShaderNodeImplCachePtr _nodeImplCache;
+
+    // Profiler for generation phases and counters.
+    GenProfilerPtr _profiler;
+
     // User data
     std::unordered_map<string, vector<GenUserDataPtr>> _userData;
 
@@ -0,0 +1,205 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <MaterialXGenShader/GenProfiler.h>
+
+#include <MaterialXGenShader/GenContext.h>
+
+#include <fstream>
+
+namespace MaterialX
+{
+
+const string GenProfiler::NODES = "nodes";
+const string GenProfiler::INCLUDE_FILES = "includeFiles";
+const string GenProfiler::BYTES_EMITTED = "bytesEmitted";
+const string GenProfiler::IMPL_CACHE_HITS = "implCacheHits";
+const string GenProfiler::IMPL_CACHE_MISSES = "implCacheMisses";
+
+namespace
+{
+
+// Write a string as a quoted JSON string.
+void writeJsonString(std::ostream& stream, const string& str)
+{
+    stream << '"';
+    for (char c : str)
+    {
+        if (c == '"' || c == '\\')
+        {
+            stream << '\\' << c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            stream << ' ';
+        }
+        else
+        {
+            stream << c;
+        }
+    }
+    stream << '"';
+}
+
+} // anonymous namespace
+
+//
+// GenProfiler methods
+//
+
+GenProfiler::GenProfiler() :
+    _startTime(std::chrono::steady_clock::now())
+{
+}
+
+int64_t GenProfiler::getTime() const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _startTime).count();
+}
+
+void GenProfiler::addEvent(const string& name, const string& detail, int64_t start, int64_t end)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _events.push_back({ name, detail, start, end - start, getThreadIndex() });
+}
+
+void GenProfiler::incrementCounter(const string& name, int64_t amount)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _counters[name] += amount;
+}
+
+int64_t GenProfiler::getCounter(const string& name) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _counters.find(name);
+    return it != _counters.end() ? it->second : 0;
+}
+
+std::map<string, int64_t> GenProfiler::getCounters() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _counters;
+}
+
+size_t GenProfiler::getEventCount(const string& name) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t count = 0;
+    for (const Event& event : _events)
+    {
+        count += event.name == name ? 1 : 0;
+    }
+    return count;
+}
+
+double GenProfiler::getTotalTime(const string& name) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    int64_t total = 0;
+    for (const Event& event : _events)
+    {
+        total += event.name == name ? event.duration : 0;
+    }
+    return total * 1.0e-6;
+}
+
+vector<GenProfiler::Event> GenProfiler::getEvents() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _events;
+}
+
+void GenProfiler::writeChromeTrace(std::ostream& stream) const
+{
+    const int64_t endTime = getTime();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    stream << "{\"traceEvents\":[";
+    string separator = "\n";
+    for (const Event& event : _events)
+    {
+        stream << separator << "{\"name\":";
+        writeJsonString(stream, event.name);
+        stream << ",\"cat\":\"MaterialXGenShader\",\"ph\":\"X\",\"ts\":" << event.start <<
+                  ",\"dur\":" << event.duration << ",\"pid\":0,\"tid\":" << event.thread;
+        if (!event.detail.empty())
+        {
+            stream << ",\"args\":{\"detail\":";
+            writeJsonString(stream, event.detail);
+            stream << "}";
+        }
+        stream << "}";
+        separator = ",\n";
+    }
+
+    // Counters are written with their final values.
+    for (const auto& counter : _counters)
+    {
+        stream << separator << "{\"name\":";
+        writeJsonString(stream, counter.first);
+        stream << ",\"cat\":\"MaterialXGenShader\",\"ph\":\"C\",\"ts\":" << endTime <<
+                  ",\"pid\":0,\"tid\":0,\"args\":{\"value\":" << counter.second << "}}";
+        separator = ",\n";
+    }
+    stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void GenProfiler::writeChromeTrace(const FilePath& filename) const
+{
+    std::ofstream stream(filename.asString());
+    if (!stream)
+    {
+        throw ExceptionShaderGenError("Could not open trace file for writing: '" + filename.asString() + "'");
+    }
+    writeChromeTrace(stream);
+}
+
+void GenProfiler::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _events.clear();
+    _counters.clear();
+    _threads.clear();
+    _startTime = std::chrono::steady_clock::now();
+}
+
+size_t GenProfiler::getThreadIndex()
+{
+    auto it = _threads.find(std::this_thread::get_id());
+    if (it != _threads.end())
+    {
+        return it->second;
+    }
+    const size_t index = _threads.size();
+    _threads[std::this_thread::get_id()] = index;
+    return index;
+}
+
+//
+// ScopedGenTimer methods
+//
+
+ScopedGenTimer::ScopedGenTimer(const GenContext& context, const char* name, const string& detail) :
+    _profiler(context.getProfiler().get()),
+    _name(name),
+    _start(0)
+{
+    if (_profiler)
+    {
+        _detail = detail;
+        _start = _profiler->getTime();
+    }
+}
+
+ScopedGenTimer::~ScopedGenTimer()
+{
+    if (_profiler)
+    {
+        _profiler->addEvent(_name, _detail, _start, _profiler->getTime());
+    }
+}
+
+} // namespace MaterialX
@@ -0,0 +1,155 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#ifndef MATERIALX_GENPROFILER_H
+#define MATERIALX_GENPROFILER_H
+
+/// @file
+/// Timing and counters for shader generation
+
+#include <MaterialXGenShader/Library.h>
+
+#include <MaterialXCore/Util.h>
+
+#include <MaterialXFormat/File.h>
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+namespace MaterialX
+{
+
+class GenContext;
+class GenProfiler;
+
+/// Shared pointer to a GenProfiler
+using GenProfilerPtr = shared_ptr<GenProfiler>;
+
+/// @class GenProfiler
+/// A thread-safe recorder of timed events and counters for shader generation.
+///
+/// A profiler is enabled by assigning it to a GenContext, after which the
+/// phases of generation run with that context are recorded as timed events,
+/// and the named counters below are accumulated.  Events may be inspected
+/// as totals per phase, or written as a Chrome trace for viewing in
+/// chrome://tracing or compatible tools.  Without a profiler assigned, the
+/// instrumentation reduces to a null check.
+class GenProfiler
+{
+  public:
+    /// @struct Event
+    /// A timed event, with times given in microseconds from the
+    /// creation or last clearing of the profiler.
+    struct Event
+    {
+        string name;
+        string detail;
+        int64_t start;
+        int64_t duration;
+        size_t thread;
+    };
+
+  public:
+    GenProfiler();
+    ~GenProfiler() { }
+
+    /// Create a new profiler.
+    static GenProfilerPtr create()
+    {
+        return std::make_shared<GenProfiler>();
+    }
+
+    /// Return the time in microseconds since the creation or
+    /// last clearing of the profiler.
+    int64_t getTime() const;
+
+    /// Record a timed event.
+    /// @param name Name of the generation phase.
+    /// @param detail Additional detail, such as the name of the node
+    ///    being processed, or an empty string.
+    /// @param start Start time of the event in microseconds.
+    /// @param end End time of the event in microseconds.
+    void addEvent(const string& name, const string& detail, int64_t start, int64_t end);
+
+    /// Add the given amount to a named counter.
+    void incrementCounter(const string& name, int64_t amount = 1);
+
+    /// Return the value of a named counter, or zero if it has not been set.
+    int64_t getCounter(const string& name) const;
+
+    /// Return all counters by name.
+    std::map<string, int64_t> getCounters() const;
+
+    /// Return the number of events recorded for the given phase.
+    size_t getEventCount(const string& name) const;
+
+    /// Return the total time in seconds of events recorded for the given
+    /// phase.  Nested events of the same phase are counted separately.
+    double getTotalTime(const string& name) const;
+
+    /// Return a copy of all recorded events.
+    vector<Event> getEvents() const;
+
+    /// Write all events and counters to a stream in the Chrome trace
+    /// event format.
+    void writeChromeTrace(std::ostream& stream) const;
+
+    /// Write all events and counters to a file in the Chrome trace
+    /// event format.
+    void writeChromeTrace(const FilePath& filename) const;
+
+    /// Clear all events and counters, and restart the profiler clock.
+    void clear();
+
+  public:
+    /// Counter for nodes in finalized shader graphs.
+    static const string NODES;
+    /// Counter for include files added to shader stages.
+    static const string INCLUDE_FILES;
+    /// Counter for bytes of source code emitted in shader stages.
+    static const string BYTES_EMITTED;
+    /// Counter for implementations found in implementation caches.
+    static const string IMPL_CACHE_HITS;
+    /// Counter for implementations created and initialized.
+    static const string IMPL_CACHE_MISSES;
+
+  protected:
+    size_t getThreadIndex();
+
+  protected:
+    mutable std::mutex _mutex;
+    std::chrono::steady_clock::time_point _startTime;
+    vector<Event> _events;
+    std::map<string, int64_t> _counters;
+    std::map<std::thread::id, size_t> _threads;
+};
+
+/// @class ScopedGenTimer
+/// An RAII class recording the lifetime of a scope as an event in the
+/// profiler of a generation context, if the context has one.
+class ScopedGenTimer
+{
+  public:
+    /// Start timing the given phase of generation.
+    /// @param context The context whose profiler records the event.
+    /// @param name Name of the generation phase.
+    /// @param detail Additional detail for the event.
+    ScopedGenTimer(const GenContext& context, const char* name, const string& detail = EMPTY_STRING);
+    ~ScopedGenTimer();
+
+  private:
+    GenProfiler* _profiler;
+    const char* _name;
+    string _detail;
+    int64_t _start;
+};
+
+} // namespace MaterialX
+
+#endif
@@ -407,6 +407,7 @@ void HwShaderGenerator::emitFunctionCall(const ShaderNode& node, GenContext& con
         {
             // A match between closure context and node classification was found.
             // So emit the function call in this context.
+            ScopedGenTimer timer(context, "emitFunctionCall", node.getName());
             node.getImplementation().emitFunctionCall(node, context, stage);
         }
         else
@@ -512,18 +513,27 @@ void HwShaderGenerator::bindLightShader(const NodeDef& nodeDef, unsigned int lig
             "' has already been bound");
     }
 
-    ShaderNodePtr shader = ShaderNode::create(nullptr, nodeDef.getNodeString(), nodeDef, context);
-
     // Check if this is a graph implementation.
     // If so prepend the light struct instance name on all input socket variables,
     // since in generated code these inputs will be members of the light struct.
-    ShaderGraph* graph = shader->getImplementation().getGraph();
-    if (graph)
+    // The graph is renamed in a private implementation, since cached
+    // implementations may be shared with other nodes and other contexts.
+    ShaderNodePtr shader;
+    const HwShaderGenerator& shadergen = static_cast<const HwShaderGenerator&>(context.getShaderGenerator());
+    InterfaceElementPtr impl = nodeDef.getImplementation(shadergen.getTarget(), shadergen.getLanguage());
+    if (impl && impl->isA<NodeGraph>())
     {
-        for (ShaderGraphInputSocket* inputSockets : graph->getInputSockets())
+        ShaderNodeImplPtr lightImpl = shadergen.createCompoundImplementation(*impl->asA<NodeGraph>());
+        lightImpl->initialize(*impl, context);
+        for (ShaderGraphInputSocket* inputSockets : lightImpl->getGraph()->getInputSockets())
         {
             inputSockets->setVariable("light." + inputSockets->getVariable());
         }
+        shader = ShaderNode::create(nullptr, nodeDef.getNodeString(), nodeDef, context, lightImpl);
+    }
+    else
+    {
+        shader = ShaderNode::create(nullptr, nodeDef.getNodeString(), nodeDef, context);
     }
 
     lightShaders->bind(lightTypeId, shader);
@@ -8,6 +8,7 @@
 #include <MaterialXGenShader/ShaderNode.h>
 #include <MaterialXGenShader/ShaderStage.h>
 #include <MaterialXGenShader/ShaderGenerator.h>
+#include <MaterialXGenShader/SourceCodeCache.h>
 #include <MaterialXGenShader/Util.h>
 
 namespace MaterialX
@@ -47,11 +48,13 @@ void SourceCodeNode::initialize(const InterfaceElement& element, GenContext& con
     }
     context.getShaderGenerator().getSyntax().makeValidName(_functionName);
 
-    if (!readFile(context.resolveSourceFile(file), _functionSource))
+    SourceCodeCache::ContentPtr content = SourceCodeCache::get().getContent(context.resolveSourceFile(file));
+    if (!content)
     {
         throw ExceptionShaderGenError("Can't find source file '" + file.asString() +
                                       "' used by implementation '" + impl.getName() + "'");
     }
+    _functionSource = *content;
 
     if (_inlined)
     {
@@ -109,6 +109,7 @@ class Shader
     std::unordered_map<string, ValuePtr> _attributeMap;
 
     friend class ShaderGenerator;
+    friend class ShaderCache;
 };
 
 } // namespace MaterialX
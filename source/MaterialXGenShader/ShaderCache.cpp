@@ -0,0 +1,564 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <MaterialXGenShader/ShaderCache.h>
+
+#include <MaterialXGenShader/GenContext.h>
+#include <MaterialXGenShader/HwShaderGenerator.h>
+#include <MaterialXGenShader/Shader.h>
+#include <MaterialXGenShader/ShaderGenerator.h>
+#include <MaterialXGenShader/SourceCodeCache.h>
+#include <MaterialXGenShader/TypeDesc.h>
+#include <MaterialXGenShader/UnitSystem.h>
+#include <MaterialXGenShader/Util.h>
+
+#include <MaterialXCore/Document.h>
+#include <MaterialXCore/Util.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <thread>
+
+namespace MaterialX
+{
+
+const string ShaderCache::FILE_EXTENSION = "mxshader";
+
+namespace
+{
+
+// Identifier and version of the cache entry format, which is written at the
+// start of each entry and is part of every key.
+const string CACHE_FORMAT = "MaterialXShaderCache 2";
+
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+uint64_t hashString(const string& str)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (char c : str)
+    {
+        hash ^= (uint64_t) (unsigned char) c;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+void hashCombine(uint64_t& hash, uint64_t value)
+{
+    uint64_t x = hash + 0x9e3779b97f4a7c15ULL + value;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    hash = x ^ (x >> 31);
+}
+
+void hashCombine(uint64_t& hash, const string& str)
+{
+    hashCombine(hash, hashString(str));
+}
+
+ConstElementPtr getTopLevelElement(ConstElementPtr elem)
+{
+    while (elem->getParent() && !elem->getParent()->isA<Document>())
+    {
+        elem = elem->getParent();
+    }
+    return elem;
+}
+
+// Combine the resolved path and modification time of the given source file,
+// and of each file that it includes, into the hash.
+void hashSourceFile(uint64_t& hash, const string& file, GenContext& context, StringSet& visitedFiles)
+{
+    const ShaderGenerator& generator = context.getShaderGenerator();
+    string resolvedFile = file;
+    tokenSubstitution(context.getTokenSubstitutions(), resolvedFile);
+    tokenSubstitution(generator.getTokenSubstitutions(), resolvedFile);
+    const FilePath path = context.resolveSourceFile(resolvedFile);
+    if (!visitedFiles.insert(path.asString()).second)
+    {
+        return;
+    }
+
+    hashCombine(hash, path.asString());
+    hashCombine(hash, (uint64_t) path.getModificationTime());
+    SourceCodeCache::SegmentVecPtr segments = SourceCodeCache::get().getSegments(path, generator.getSyntax());
+    if (segments)
+    {
+        for (const SourceCodeCache::Segment& segment : *segments)
+        {
+            if (!segment.include.empty())
+            {
+                hashSourceFile(hash, segment.include, context, visitedFiles);
+            }
+        }
+    }
+}
+
+// Combine the source files of the implementation of the given node into the
+// hash, descending into the nodes of graph implementations.
+void hashImplementationSources(uint64_t& hash, ConstNodePtr node, GenContext& context,
+                               StringSet& visitedImpls, StringSet& visitedFiles)
+{
+    const ShaderGenerator& generator = context.getShaderGenerator();
+    NodeDefPtr nodeDef = node->getNodeDef(generator.getTarget());
+    InterfaceElementPtr impl = nodeDef ? nodeDef->getImplementation(generator.getTarget(), generator.getLanguage()) : nullptr;
+    if (!impl || !visitedImpls.insert(impl->getNamePath()).second)
+    {
+        return;
+    }
+
+    ImplementationPtr implementation = impl->asA<Implementation>();
+    NodeGraphPtr graph = impl->asA<NodeGraph>();
+    if (implementation && !implementation->getFile().empty())
+    {
+        hashSourceFile(hash, implementation->getFile(), context, visitedFiles);
+    }
+    else if (graph)
+    {
+        for (NodePtr child : graph->getNodes())
+        {
+            hashImplementationSources(hash, child, context, visitedImpls, visitedFiles);
+        }
+    }
+}
+
+//
+// Entry serialization, using length-prefixed strings so that source code
+// is stored verbatim.
+//
+
+void writeString(std::ostream& stream, const string& str)
+{
+    stream << str.size() << ' ';
+    stream.write(str.data(), str.size());
+    stream << '\n';
+}
+
+void writeCount(std::ostream& stream, size_t count)
+{
+    stream << count << '\n';
+}
+
+string readString(std::istream& stream)
+{
+    // Entries are read from memory, so the characters available in the
+    // stream buffer are the remainder of the entry.
+    size_t size = 0;
+    if (!(stream >> size) || stream.get() != ' ' || size > (size_t) stream.rdbuf()->in_avail())
+    {
+        throw ExceptionShaderGenError("Invalid string in shader cache entry");
+    }
+    string str(size, '\0');
+    if (!stream.read(&str[0], size) || stream.get() != '\n')
+    {
+        throw ExceptionShaderGenError("Invalid string in shader cache entry");
+    }
+    return str;
+}
+
+size_t readCount(std::istream& stream)
+{
+    size_t count = 0;
+    if (!(stream >> count) || stream.get() != '\n')
+    {
+        throw ExceptionShaderGenError("Invalid count in shader cache entry");
+    }
+    return count;
+}
+
+void writeValue(std::ostream& stream, ConstValuePtr value)
+{
+    writeString(stream, value ? value->getTypeString() : EMPTY_STRING);
+    writeString(stream, value ? value->getValueString() : EMPTY_STRING);
+}
+
+ValuePtr readValue(std::istream& stream)
+{
+    const string type = readString(stream);
+    const string value = readString(stream);
+    return type.empty() ? nullptr : Value::createValueFromStrings(value, type);
+}
+
+void writeBlock(std::ostream& stream, const VariableBlock& block)
+{
+    writeString(stream, block.getName());
+    writeString(stream, block.getInstance());
+    writeCount(stream, block.size());
+    for (const ShaderPort* port : block.getVariableOrder())
+    {
+        writeString(stream, port->getType()->getName());
+        writeString(stream, port->getName());
+        writeString(stream, port->getVariable());
+        writeString(stream, port->getSemantic());
+        writeString(stream, port->getPath());
+        writeString(stream, port->getUnit());
+        writeString(stream, port->getGeomProp());
+        writeCount(stream, port->getFlags());
+        writeValue(stream, port->getValue());
+    }
+}
+
+void readBlockVariables(std::istream& stream, VariableBlock& block)
+{
+    const size_t count = readCount(stream);
+    for (size_t i = 0; i < count; i++)
+    {
+        const string typeName = readString(stream);
+        const TypeDesc* type = TypeDesc::get(typeName);
+        if (!type)
+        {
+            throw ExceptionShaderGenError("Unknown type '" + typeName + "' in shader cache entry");
+        }
+        const string name = readString(stream);
+        ShaderPort* port = block.add(type, name);
+        port->setVariable(readString(stream));
+        port->setSemantic(readString(stream));
+        port->setPath(readString(stream));
+        port->setUnit(readString(stream));
+        port->setGeomProp(readString(stream));
+        port->setFlags((unsigned int) readCount(stream));
+        port->setValue(readValue(stream));
+    }
+}
+
+void writeBlockMap(std::ostream& stream, const VariableBlockMap& blocks)
+{
+    // Write blocks in name order, so that identical shaders produce
+    // identical entries.
+    std::map<string, VariableBlockPtr> orderedBlocks(blocks.begin(), blocks.end());
+    writeCount(stream, orderedBlocks.size());
+    for (const auto& it : orderedBlocks)
+    {
+        writeString(stream, it.first);
+        writeBlock(stream, *it.second);
+    }
+}
+
+template<class CreateFunction> void readBlockMap(std::istream& stream, CreateFunction createBlock)
+{
+    const size_t count = readCount(stream);
+    for (size_t i = 0; i < count; i++)
+    {
+        readString(stream);
+        const string name = readString(stream);
+        const string instance = readString(stream);
+        VariableBlockPtr block = createBlock(name, instance);
+        readBlockVariables(stream, *block);
+    }
+}
+
+} // anonymous namespace
+
+//
+// ShaderCache methods
+//
+
+ShaderPtr ShaderCache::generate(const string& name, ElementPtr element, GenContext& context) const
+{
+    const string key = computeKey(name, element, context);
+    ShaderPtr shader = read(key, context);
+    if (!shader)
+    {
+        shader = context.getShaderGenerator().generate(name, element, context);
+
+        // Adding the shader to the cache is best-effort, so a cache directory
+        // that cannot be written does not prevent generation.
+        try
+        {
+            write(key, *shader);
+        }
+        catch (std::exception&)
+        {
+        }
+    }
+    return shader;
+}
+
+string ShaderCache::computeKey(const string& name, ConstElementPtr element, GenContext& context) const
+{
+    const ShaderGenerator& generator = context.getShaderGenerator();
+    uint64_t hash = hashString(CACHE_FORMAT);
+
+    // Generator and shader identity.
+    hashCombine(hash, getVersionString());
+    hashCombine(hash, generator.getLanguage());
+    hashCombine(hash, generator.getTarget());
+    hashCombine(hash, name);
+    ColorManagementSystemPtr cms = generator.getColorManagementSystem();
+    hashCombine(hash, cms ? cms->getName() : EMPTY_STRING);
+    UnitSystemPtr unitSystem = generator.getUnitSystem();
+    hashCombine(hash, unitSystem ? unitSystem->getName() : EMPTY_STRING);
+    UnitConverterRegistryPtr unitRegistry = unitSystem ? unitSystem->getUnitConverterRegistry() : nullptr;
+    if (unitRegistry)
+    {
+        // Registered unit converters, combined independently of their order.
+        uint64_t unitHash = 0;
+        for (const auto& it : unitRegistry->getUnitConverters())
+        {
+            uint64_t converterHash = hashString(it.first);
+            LinearUnitConverterPtr linearConverter = std::dynamic_pointer_cast<LinearUnitConverter>(it.second);
+            if (linearConverter)
+            {
+                for (const auto& scale : linearConverter->getUnitScale())
+                {
+                    uint64_t scaleHash = hashString(scale.first);
+                    hashCombine(scaleHash, std::to_string(scale.second));
+                    converterHash += scaleHash;
+                }
+            }
+            unitHash += converterHash;
+        }
+        hashCombine(hash, unitHash);
+    }
+
+    // Generation options.
+    const GenOptions& options = context.getOptions();
+    hashCombine(hash, (uint64_t) options.shaderInterfaceType);
+    hashCombine(hash, (uint64_t) options.fileTextureVerticalFlip);
+    hashCombine(hash, options.targetColorSpaceOverride);
+    hashCombine(hash, options.targetDistanceUnit);
+    hashCombine(hash, (uint64_t) options.hwTransparency);
+    hashCombine(hash, (uint64_t) options.hwSpecularEnvironmentMethod);
+    hashCombine(hash, (uint64_t) options.hwWriteDepthMoments);
+    hashCombine(hash, (uint64_t) options.hwShadowMap);
+    hashCombine(hash, (uint64_t) options.hwAmbientOcclusion);
+    hashCombine(hash, (uint64_t) options.hwMaxActiveLightSources);
+    hashCombine(hash, (uint64_t) options.hwNormalizeUdimTexCoords);
+    hashCombine(hash, context.getSourceCodeSearchPath().asString());
+
+    // Bound light shaders, combined independently of their binding order.
+    HwLightShadersPtr lightShaders = context.getUserData<HwLightShaders>(HW::USER_DATA_LIGHT_SHADERS);
+    if (lightShaders)
+    {
+        uint64_t lightHash = 0;
+        for (const auto& it : lightShaders->get())
+        {
+            uint64_t bindingHash = hashString(it.second->getName());
+            hashCombine(bindingHash, (uint64_t) it.first);
+            lightHash += bindingHash;
+        }
+        hashCombine(hash, lightHash);
+    }
+
+    // The upstream element graph, represented by the element path and the
+    // content of each top-level element that the graph passes through, along
+    // with the source files of the implementations of its nodes.
+    StringSet visitedImpls;
+    StringSet visitedFiles;
+    hashCombine(hash, element->getNamePath());
+    ConstElementPtr topLevel = getTopLevelElement(element);
+    hashCombine(hash, topLevel->getContentHash());
+    if (element->isA<Node>())
+    {
+        hashImplementationSources(hash, element->asA<Node>(), context, visitedImpls, visitedFiles);
+    }
+    for (Edge edge : element->traverseGraph())
+    {
+        ElementPtr upstreamElem = edge.getUpstreamElement();
+        if (upstreamElem->isA<Node>())
+        {
+            hashImplementationSources(hash, upstreamElem->asA<Node>(), context, visitedImpls, visitedFiles);
+        }
+        ConstElementPtr upstream = getTopLevelElement(upstreamElem);
+        if (upstream != topLevel)
+        {
+            hashCombine(hash, upstream->getNamePath());
+            hashCombine(hash, upstream->getContentHash());
+        }
+    }
+
+    // Root attributes, definitions and geometric properties of the document
+    // and its data libraries.
+    for (ConstDocumentPtr doc = element->getDocument(); doc; doc = doc->getDataLibrary())
+    {
+        for (const Element::Attribute& attr : doc->getAttributes())
+        {
+            hashCombine(hash, attr.getName());
+            hashCombine(hash, attr.getValue());
+        }
+        for (ElementPtr child : doc->getChildren())
+        {
+            if (isDefinitionElement(child) || child->isA<GeomPropDef>())
+            {
+                hashCombine(hash, child->getContentHash());
+            }
+        }
+    }
+
+    std::ostringstream key;
+    key << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return key.str();
+}
+
+ShaderPtr ShaderCache::read(const string& key, GenContext& context) const
+{
+    std::ifstream file(getEntryPath(key).asString(), std::ios::binary);
+    if (!file)
+    {
+        return nullptr;
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    std::istringstream stream(content.str());
+
+    try
+    {
+        string format;
+        std::getline(stream, format);
+        if (format != CACHE_FORMAT || readString(stream) != key)
+        {
+            return nullptr;
+        }
+
+        // Reject the entry if any file included by its stages has changed.
+        const size_t includeCount = readCount(stream);
+        for (size_t i = 0; i < includeCount; i++)
+        {
+            const FilePath file = readString(stream);
+            if (readString(stream) != std::to_string(file.getModificationTime()))
+            {
+                return nullptr;
+            }
+        }
+
+        const string name = readString(stream);
+        ShaderGraphPtr graph = std::make_shared<ShaderGraph>(nullptr, name, nullptr, context.getReservedWords());
+        ShaderPtr shader = std::make_shared<Shader>(name, graph);
+
+        const size_t attributeCount = readCount(stream);
+        for (size_t i = 0; i < attributeCount; i++)
+        {
+            const string attrib = readString(stream);
+            shader->setAttribute(attrib, readValue(stream));
+        }
+
+        const ShaderGenerator& generator = context.getShaderGenerator();
+        const size_t stageCount = readCount(stream);
+        for (size_t i = 0; i < stageCount; i++)
+        {
+            ShaderStagePtr stage = generator.createStage(readString(stream), *shader);
+            stage->setFunctionName(readString(stream));
+            stage->_code.assign(readString(stream));
+
+            readString(stream);
+            readString(stream);
+            readBlockVariables(stream, stage->getConstantBlock());
+            readBlockMap(stream, [&stage](const string& n, const string& instance)
+            {
+                return stage->createUniformBlock(n, instance);
+            });
+            readBlockMap(stream, [&stage](const string& n, const string& instance)
+            {
+                return stage->createInputBlock(n, instance);
+            });
+            readBlockMap(stream, [&stage](const string& n, const string& instance)
+            {
+                return stage->createOutputBlock(n, instance);
+            });
+        }
+
+        return shader;
+    }
+    catch (std::exception&)
+    {
+        return nullptr;
+    }
+}
+
+void ShaderCache::write(const string& key, const Shader& shader) const
+{
+    // Write values with enough precision to restore them exactly.
+    ScopedFloatFormatting fmt(Value::FloatFormatDefault, 9);
+
+    std::ostringstream stream;
+    stream << CACHE_FORMAT << '\n';
+    writeString(stream, key);
+
+    // Record the modification time of each file included by the stages, so
+    // that entries are invalidated when an include file changes.
+    StringSet includes;
+    for (size_t i = 0; i < shader.numStages(); i++)
+    {
+        const StringSet& stageIncludes = shader.getStage(i)._includes;
+        includes.insert(stageIncludes.begin(), stageIncludes.end());
+    }
+    writeCount(stream, includes.size());
+    for (const string& include : includes)
+    {
+        writeString(stream, include);
+        writeString(stream, std::to_string(FilePath(include).getModificationTime()));
+    }
+
+    writeString(stream, shader.getName());
+
+    std::map<string, ValuePtr> attributes(shader._attributeMap.begin(), shader._attributeMap.end());
+    writeCount(stream, attributes.size());
+    for (const auto& it : attributes)
+    {
+        writeString(stream, it.first);
+        writeValue(stream, it.second);
+    }
+
+    writeCount(stream, shader.numStages());
+    for (size_t i = 0; i < shader.numStages(); i++)
+    {
+        const ShaderStage& stage = shader.getStage(i);
+        writeString(stream, stage.getName());
+        writeString(stream, stage.getFunctionName());
+        writeString(stream, stage.getSourceCode());
+        writeBlock(stream, stage.getConstantBlock());
+        writeBlockMap(stream, stage.getUniformBlocks());
+        writeBlockMap(stream, stage.getInputBlocks());
+        writeBlockMap(stream, stage.getOutputBlocks());
+    }
+
+    // Write to a temporary file that is then renamed, so that concurrent
+    // readers never observe a partial entry.
+    if (!_directory.exists())
+    {
+        _directory.createDirectory();
+    }
+    const FilePath entryPath = getEntryPath(key);
+    std::ostringstream tempName;
+    tempName << entryPath.asString() << ".tmp" << std::hash<std::thread::id>()(std::this_thread::get_id());
+    {
+        std::ofstream file(tempName.str(), std::ios::binary);
+        if (!file)
+        {
+            throw ExceptionShaderGenError("Could not write shader cache entry: " + entryPath.asString());
+        }
+        const string content = stream.str();
+        file.write(content.data(), content.size());
+    }
+    if (std::rename(tempName.str().c_str(), entryPath.asString().c_str()) != 0)
+    {
+        std::remove(entryPath.asString().c_str());
+        if (std::rename(tempName.str().c_str(), entryPath.asString().c_str()) != 0)
+        {
+            std::remove(tempName.str().c_str());
+            throw ExceptionShaderGenError("Could not write shader cache entry: " + entryPath.asString());
+        }
+    }
+}
+
+void ShaderCache::clear() const
+{
+    for (const FilePath& file : _directory.getFilesInDirectory(FILE_EXTENSION))
+    {
+        std::remove((_directory / file).asString().c_str());
+    }
+}
+
+FilePath ShaderCache::getEntryPath(const string& key) const
+{
+    return _directory / FilePath(key + "." + FILE_EXTENSION);
+}
+
+} // namespace MaterialX
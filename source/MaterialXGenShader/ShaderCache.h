@@ -0,0 +1,111 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#ifndef MATERIALX_SHADERCACHE_H
+#define MATERIALX_SHADERCACHE_H
+
+/// @file
+/// A persistent cache of generated shaders
+
+#include <MaterialXGenShader/Library.h>
+
+#include <MaterialXCore/Element.h>
+
+#include <MaterialXFormat/File.h>
+
+namespace MaterialX
+{
+
+class ShaderCache;
+
+/// Shared pointer to a ShaderCache
+using ShaderCachePtr = shared_ptr<ShaderCache>;
+
+/// @class ShaderCache
+/// A persistent cache of generated shaders on the local filesystem.
+///
+/// Each entry stores the source code and the uniform, input and output
+/// blocks of every stage of a generated shader, together with its
+/// attributes, and is addressed by a key that captures everything that
+/// affects generation: the upstream element graph, the shader name, the
+/// generator language and target, the MaterialX version, the generation
+/// options and source code search path of the context, the root attributes,
+/// definitions and geometric properties of the document and its data
+/// libraries, the paths and modification times of the source files of
+/// the implementations in the graph, the color management system name,
+/// the unit system name and the unit scales of its registered linear unit
+/// converters, and any bound light shaders.  Unit converters of other
+/// kinds are identified by unit type alone, and the unit implementations
+/// loaded into the unit system are assumed to match the data libraries.
+///
+/// Each entry also records the modification times of the files included
+/// by its stages, and an entry whose include files have changed is not
+/// used.  Shaders restored from the cache are rebuilt directly from the
+/// stored stages, without constructing a shader graph, so the graph of a
+/// cached shader is empty.
+class ShaderCache
+{
+  public:
+    ShaderCache(const FilePath& directory) :
+        _directory(directory)
+    {
+    }
+    ~ShaderCache() { }
+
+    /// Create a new shader cache, storing its entries in the given directory.
+    static ShaderCachePtr create(const FilePath& directory)
+    {
+        return std::make_shared<ShaderCache>(directory);
+    }
+
+    /// Return the directory in which entries are stored.
+    const FilePath& getDirectory() const
+    {
+        return _directory;
+    }
+
+    /// Generate a shader for the given element, returning the cached shader
+    /// if one exists for the given name, element and context, and otherwise
+    /// generating the shader and adding it to the cache.  Adding the shader
+    /// is best-effort, and a shader that cannot be written to the cache is
+    /// still returned.
+    /// @param name Name of the shader.
+    /// @param element The element for which to generate a shader.
+    /// @param context The context for shader generation.
+    /// @return The cached or generated shader.
+    ShaderPtr generate(const string& name, ElementPtr element, GenContext& context) const;
+
+    /// Return the cache key for a shader with the given name, generated for
+    /// the given element and context.
+    string computeKey(const string& name, ConstElementPtr element, GenContext& context) const;
+
+    /// Read the shader with the given key from the cache.
+    /// @param key The cache key of the shader.
+    /// @param context The context whose generator syntax is assigned to the
+    ///    stages of the shader.
+    /// @return The cached shader, or nullptr if no valid entry is found,
+    ///    including when the entry is truncated or corrupt.
+    ShaderPtr read(const string& key, GenContext& context) const;
+
+    /// Write the given shader to the cache under the given key, replacing
+    /// any existing entry.
+    void write(const string& key, const Shader& shader) const;
+
+    /// Remove all entries from the cache.
+    void clear() const;
+
+  public:
+    static const string FILE_EXTENSION;
+
+  protected:
+    FilePath getEntryPath(const string& key) const;
+
+  protected:
+    FilePath _directory;
+};
+
+} // namespace MaterialX
+
+#endif
@@ -0,0 +1,235 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <MaterialXGenShader/ShaderChangeObserver.h>
+
+#include <MaterialXGenShader/Shader.h>
+#include <MaterialXGenShader/TypeDesc.h>
+#include <MaterialXGenShader/Util.h>
+
+namespace MaterialX
+{
+
+namespace
+{
+
+ConstElementPtr getTopLevelElement(ConstElementPtr elem)
+{
+    while (elem->getParent() && !elem->getParent()->isA<Document>())
+    {
+        elem = elem->getParent();
+    }
+    return elem;
+}
+
+} // anonymous namespace
+
+//
+// ShaderChangeObserver methods
+//
+
+ShaderChangeObserver::ShaderChangeObserver(ShaderPtr shader, ConstElementPtr element) :
+    _shader(shader),
+    _requiresRegeneration(false)
+{
+    // Track the top-level elements reached by the upstream graph.
+    _topLevelElements.insert(getTopLevelElement(element)->getName());
+    for (Edge edge : element->traverseGraph())
+    {
+        _topLevelElements.insert(getTopLevelElement(edge.getUpstreamElement())->getName());
+    }
+
+    // Index the uniforms of all stages by element path.
+    for (size_t i = 0; i < _shader->numStages(); ++i)
+    {
+        for (const auto& it : _shader->getStage(i).getUniformBlocks())
+        {
+            const VariableBlock& block = *it.second;
+            for (size_t j = 0; j < block.size(); ++j)
+            {
+                const ShaderPort* port = block[j];
+                if (!port->getPath().empty())
+                {
+                    _uniforms.emplace(port->getPath(), port);
+                }
+            }
+        }
+    }
+}
+
+ShaderChange ShaderChangeObserver::classifySetAttribute(ConstElementPtr elem, const string& attrib, const string& value) const
+{
+    if (isMetadataAttribute(attrib))
+    {
+        return ShaderChange(SHADER_CHANGE_NONE);
+    }
+    if (elem->isA<NodeGraph>() && attrib == InterfaceElement::NODE_DEF_ATTRIBUTE)
+    {
+        // The nodegraph becomes the implementation of a nodedef.
+        return ShaderChange(SHADER_CHANGE_REGENERATE);
+    }
+    if (!affectsShader(elem))
+    {
+        return ShaderChange(SHADER_CHANGE_NONE);
+    }
+
+    ConstValueElementPtr valueElem = elem->asA<ValueElement>();
+    const ShaderPort* uniform = valueElem ? findUniform(valueElem->getNamePath()) : nullptr;
+    if (uniform)
+    {
+        if (attrib == ValueElement::VALUE_ATTRIBUTE)
+        {
+            // Values of other types than the uniform, such as enumerations
+            // remapped by the generator, are handled by regeneration.
+            const string& type = valueElem->getType();
+            ValuePtr uniformValue = TypeDesc::get(type) == uniform->getType() ?
+                                    Value::createValueFromStrings(value, type) : nullptr;
+            if (uniformValue)
+            {
+                ShaderChange change(SHADER_CHANGE_UNIFORM);
+                change.path = uniform->getPath();
+                change.value = uniformValue;
+                return change;
+            }
+        }
+        else if (attrib == TypedElement::TYPE_ATTRIBUTE &&
+                 (!valueElem->hasValue() || TypeDesc::get(value) == uniform->getType()))
+        {
+            // Typing an input that holds no value yet, as when an input is
+            // added to a node, has no effect until its value is set, which
+            // is then checked against the type of the uniform.
+            return ShaderChange(SHADER_CHANGE_NONE);
+        }
+    }
+
+    return ShaderChange(SHADER_CHANGE_REGENERATE);
+}
+
+ShaderChange ShaderChangeObserver::classifyRemoveAttribute(ConstElementPtr elem, const string& attrib) const
+{
+    if (isMetadataAttribute(attrib) || !affectsShader(elem))
+    {
+        return ShaderChange(SHADER_CHANGE_NONE);
+    }
+    return ShaderChange(SHADER_CHANGE_REGENERATE);
+}
+
+ShaderChange ShaderChangeObserver::classifyAddElement(ConstElementPtr parent, ConstElementPtr elem) const
+{
+    if (isDefinitionElement(elem))
+    {
+        return ShaderChange(SHADER_CHANGE_REGENERATE);
+    }
+    if (parent->isA<Document>() || !affectsShader(parent))
+    {
+        // Other new top-level elements are not referenced by the shader.
+        return ShaderChange(SHADER_CHANGE_NONE);
+    }
+    if (elem->isA<ValueElement>() && findUniform(elem->getNamePath()))
+    {
+        // A new input for a uniform holds no value, so the uniform
+        // keeps the default value of the nodedef.
+        return ShaderChange(SHADER_CHANGE_NONE);
+    }
+    return ShaderChange(SHADER_CHANGE_REGENERATE);
+}
+
+ShaderChange ShaderChangeObserver::classifyRemoveElement(ConstElementPtr parent, ConstElementPtr elem) const
+{
+    if (isDefinitionElement(elem))
+    {
+        return ShaderChange(SHADER_CHANGE_REGENERATE);
+    }
+    const bool affected = parent->isA<Document>() ? _topLevelElements.count(elem->getName()) > 0 : affectsShader(parent);
+    return ShaderChange(affected ? SHADER_CHANGE_REGENERATE : SHADER_CHANGE_NONE);
+}
+
+ShaderChange ShaderChangeObserver::classifyContentChange(ConstElementPtr elem) const
+{
+    return ShaderChange(affectsShader(elem) ? SHADER_CHANGE_REGENERATE : SHADER_CHANGE_NONE);
+}
+
+void ShaderChangeObserver::onAddElement(ElementPtr parent, ElementPtr elem)
+{
+    recordChange(classifyAddElement(parent, elem));
+}
+
+void ShaderChangeObserver::onRemoveElement(ElementPtr parent, ElementPtr elem)
+{
+    recordChange(classifyRemoveElement(parent, elem));
+}
+
+void ShaderChangeObserver::onSetAttribute(ElementPtr elem, const string& attrib, const string& value)
+{
+    recordChange(classifySetAttribute(elem, attrib, value));
+}
+
+void ShaderChangeObserver::onRemoveAttribute(ElementPtr elem, const string& attrib)
+{
+    recordChange(classifyRemoveAttribute(elem, attrib));
+}
+
+void ShaderChangeObserver::onCopyContent(ElementPtr elem)
+{
+    recordChange(classifyContentChange(elem));
+}
+
+void ShaderChangeObserver::onClearContent(ElementPtr elem)
+{
+    recordChange(classifyContentChange(elem));
+}
+
+void ShaderChangeObserver::onRead()
+{
+    recordChange(ShaderChange(SHADER_CHANGE_REGENERATE));
+}
+
+bool ShaderChangeObserver::affectsShader(ConstElementPtr elem) const
+{
+    if (elem->isA<Document>())
+    {
+        return true;
+    }
+    ConstElementPtr topLevel = getTopLevelElement(elem);
+    return isDefinitionElement(topLevel) || _topLevelElements.count(topLevel->getName()) > 0;
+}
+
+const ShaderPort* ShaderChangeObserver::findUniform(const string& path) const
+{
+    auto it = _uniforms.find(path);
+    return it != _uniforms.end() ? it->second : nullptr;
+}
+
+bool ShaderChangeObserver::isMetadataAttribute(const string& attrib)
+{
+    static const StringSet METADATA_ATTRIBUTES =
+    {
+        Element::DOC_ATTRIBUTE,
+        ValueElement::UI_NAME_ATTRIBUTE,
+        ValueElement::UI_FOLDER_ATTRIBUTE,
+        ValueElement::UI_MIN_ATTRIBUTE,
+        ValueElement::UI_MAX_ATTRIBUTE,
+        ValueElement::UI_SOFT_MIN_ATTRIBUTE,
+        ValueElement::UI_SOFT_MAX_ATTRIBUTE,
+        ValueElement::UI_STEP_ATTRIBUTE,
+        ValueElement::UI_ADVANCED_ATTRIBUTE
+    };
+    return METADATA_ATTRIBUTES.count(attrib) > 0;
+}
+
+void ShaderChangeObserver::recordChange(const ShaderChange& change)
+{
+    if (change.type == SHADER_CHANGE_NONE)
+    {
+        return;
+    }
+    if (change.type == SHADER_CHANGE_REGENERATE)
+    {
+        _requiresRegeneration = true;
+    }
+    _changes.push_back(change);
+}
+
+} // namespace MaterialX
@@ -0,0 +1,175 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#ifndef MATERIALX_SHADERCHANGEOBSERVER_H
+#define MATERIALX_SHADERCHANGEOBSERVER_H
+
+/// @file
+/// Classification of document changes against generated shaders
+
+#include <MaterialXGenShader/Library.h>
+
+#include <MaterialXCore/Observer.h>
+
+namespace MaterialX
+{
+
+class ShaderChangeObserver;
+class ShaderPort;
+
+/// Shared pointer to a ShaderChangeObserver
+using ShaderChangeObserverPtr = shared_ptr<ShaderChangeObserver>;
+
+/// The effect of a document change on a generated shader.
+enum ShaderChangeType
+{
+    /// The change does not affect the shader.
+    SHADER_CHANGE_NONE,
+
+    /// The change sets the value of an input that is exposed
+    /// as a uniform of the shader. The shader remains valid
+    /// and only the uniform value needs to be updated.
+    SHADER_CHANGE_UNIFORM,
+
+    /// The change alters the generated code, so the shader
+    /// needs to be regenerated.
+    SHADER_CHANGE_REGENERATE
+};
+
+/// @struct ShaderChange
+/// A document change classified against a generated shader.
+struct ShaderChange
+{
+    ShaderChange(ShaderChangeType t = SHADER_CHANGE_NONE) :
+        type(t)
+    {
+    }
+
+    /// The effect of the change on the shader.
+    ShaderChangeType type;
+
+    /// For uniform updates, the element path of the uniform.
+    string path;
+
+    /// For uniform updates, the new value of the uniform.
+    ValuePtr value;
+};
+
+/// @class ShaderChangeObserver
+/// An observer that classifies document changes against a generated shader.
+///
+/// The observer is created for a shader and the element it was generated
+/// from, and registered with the ObservedDocument holding that element.
+/// Each change reported through the observer callbacks is classified as
+/// an update to the value of a uniform of the shader, a change requiring
+/// the shader to be regenerated, or a change with no effect on the shader,
+/// allowing interactive editors to push new uniform values to an existing
+/// program instead of regenerating and recompiling it.
+///
+/// Classification is conservative: any change to the top-level elements
+/// reached by the upstream graph of the element, to definitions, or to
+/// the document itself requires regeneration, unless it only sets the value
+/// of a uniform or edits user interface metadata.
+class ShaderChangeObserver : public Observer
+{
+  public:
+    ShaderChangeObserver(ShaderPtr shader, ConstElementPtr element);
+    virtual ~ShaderChangeObserver() { }
+
+    /// Create a new observer for the given shader, generated from the
+    /// given element.
+    static ShaderChangeObserverPtr create(ShaderPtr shader, ConstElementPtr element)
+    {
+        return std::make_shared<ShaderChangeObserver>(shader, element);
+    }
+
+    /// Return the shader against which changes are classified.
+    ShaderPtr getShader() const
+    {
+        return _shader;
+    }
+
+    /// @name Classification
+    /// @{
+
+    /// Classify the setting of an attribute of an element.
+    ShaderChange classifySetAttribute(ConstElementPtr elem, const string& attrib, const string& value) const;
+
+    /// Classify the removal of an attribute of an element.
+    ShaderChange classifyRemoveAttribute(ConstElementPtr elem, const string& attrib) const;
+
+    /// Classify the addition of an element to the element tree.
+    ShaderChange classifyAddElement(ConstElementPtr parent, ConstElementPtr elem) const;
+
+    /// Classify the removal of an element from the element tree.
+    ShaderChange classifyRemoveElement(ConstElementPtr parent, ConstElementPtr elem) const;
+
+    /// Classify a change to the content of an element.
+    ShaderChange classifyContentChange(ConstElementPtr elem) const;
+
+    /// @}
+    /// @name Recorded Changes
+    /// @{
+
+    /// Return the changes affecting the shader that have been reported
+    /// through the observer callbacks, in the order they were reported.
+    const vector<ShaderChange>& getChanges() const
+    {
+        return _changes;
+    }
+
+    /// Return true if any recorded change requires the shader
+    /// to be regenerated.
+    bool requiresRegeneration() const
+    {
+        return _requiresRegeneration;
+    }
+
+    /// Clear all recorded changes.
+    void clearChanges()
+    {
+        _changes.clear();
+        _requiresRegeneration = false;
+    }
+
+    /// @}
+    /// @name Observer Callbacks
+    /// @{
+
+    void onAddElement(ElementPtr parent, ElementPtr elem) override;
+    void onRemoveElement(ElementPtr parent, ElementPtr elem) override;
+    void onSetAttribute(ElementPtr elem, const string& attrib, const string& value) override;
+    void onRemoveAttribute(ElementPtr elem, const string& attrib) override;
+    void onCopyContent(ElementPtr elem) override;
+    void onClearContent(ElementPtr elem) override;
+    void onRead() override;
+
+    /// @}
+
+  protected:
+    // Return true if changes to the given element may affect the shader.
+    bool affectsShader(ConstElementPtr elem) const;
+
+    // Return the uniform with the given element path, or nullptr
+    // if no such uniform exists.
+    const ShaderPort* findUniform(const string& path) const;
+
+    // Return true if the given attribute only holds user interface metadata.
+    static bool isMetadataAttribute(const string& attrib);
+
+    // Record a classified change.
+    void recordChange(const ShaderChange& change);
+
+  protected:
+    ShaderPtr _shader;
+    StringSet _topLevelElements;
+    std::unordered_map<string, const ShaderPort*> _uniforms;
+    vector<ShaderChange> _changes;
+    bool _requiresRegeneration;
+};
+
+} // namespace MaterialX
+
+#endif
@@ -101,6 +101,7 @@ void ShaderGenerator::emitFunctionCall(const ShaderNode& node, GenContext& conte
     }
     else
     {
+        ScopedGenTimer timer(context, "emitFunctionCall", node.getName());
         node.getImplementation().emitFunctionCall(node, context, stage);
     }
 }
@@ -243,32 +244,54 @@ ShaderNodeImplPtr ShaderGenerator::getImplementation(const InterfaceElement& ele
     const string& name = element.getName();
 
     // Check if it's created and cached already.
+    const GenProfilerPtr& profiler = context.getProfiler();
     ShaderNodeImplPtr impl = context.findNodeImplementation(name);
     if (impl)
     {
+        if (profiler)
+        {
+            profiler->incrementCounter(GenProfiler::IMPL_CACHE_HITS);
+        }
         return impl;
     }
 
-    if (element.isA<NodeGraph>())
+    // Create and initialize a new implementation.
+    bool created = false;
+    auto createImplementation = [this, &element, &context, &name, &created]()
     {
-        // Use a compound implementation.
-        impl = createCompoundImplementation(static_cast<const NodeGraph&>(element));
-    }
-    else if (element.isA<Implementation>())
-    {
-        // Try creating a new in the factory.
-        impl = _implFactory.create(name);
-        if (!impl)
+        created = true;
+        ShaderNodeImplPtr newImpl;
+        if (element.isA<NodeGraph>())
         {
-            // Fall back to the source code implementation.
-            impl = createSourceCodeImplementation(static_cast<const Implementation&>(element));
+            // Use a compound implementation.
+            newImpl = createCompoundImplementation(static_cast<const NodeGraph&>(element));
         }
-    }
-    else
+        else if (element.isA<Implementation>())
+        {
+            // Try creating a new in the factory.
+            newImpl = _implFactory.create(name);
+            if (!newImpl)
+            {
+                // Fall back to the source code implementation.
+                newImpl = createSourceCodeImplementation(static_cast<const Implementation&>(element));
+            }
+        }
+        else
+        {
+            throw ExceptionShaderGenError("Element '" + name + "' is neither an Implementation nor an NodeGraph");
+        }
+        newImpl->initialize(element, context);
+        return newImpl;
+    };
+
+    // Take the implementation from the shared cache if one is present.
+    ShaderNodeImplCachePtr sharedCache = context.getNodeImplementationCache();
+    impl = sharedCache ? sharedCache->getOrCreate(name, context, createImplementation) : createImplementation();
+
+    if (profiler)
     {
-        throw ExceptionShaderGenError("Element '" + name + "' is neither an Implementation nor an NodeGraph");
+        profiler->incrementCounter(created ? GenProfiler::IMPL_CACHE_MISSES : GenProfiler::IMPL_CACHE_HITS);
     }
-    impl->initialize(element, context);
 
     // Cache it.
     context.addNodeImplementation(name, impl);
@@ -294,10 +317,20 @@ namespace
     }
 }
 
+void ShaderGenerator::replaceTokens(const StringMap& substitutions, GenContext& context, ShaderStage& stage) const
+{
+    ScopedGenTimer timer(context, "replaceTokens", stage.getName());
+    replaceTokens(substitutions, stage);
+    if (context.getProfiler())
+    {
+        context.getProfiler()->incrementCounter(GenProfiler::BYTES_EMITTED, static_cast<int64_t>(stage.getSourceCode().size()));
+    }
+}
+
 void ShaderGenerator::replaceTokens(const StringMap& substitutions, ShaderStage& stage) const
 {
     // Replace tokens in source code
-    tokenSubstitution(substitutions, stage._code);
+    tokenSubstitution(substitutions, stage._code.str());
 
     // Replace tokens on shader interface
     for (size_t i = 0; i < stage._constants.size(); ++i)
@@ -206,6 +206,11 @@ class ShaderGenerator
     /// Replace tokens with identifiers according to the given substitutions map.
     void replaceTokens(const StringMap& substitutions, ShaderStage& stage) const;
 
+    /// Replace tokens with identifiers according to the given substitutions map,
+    /// recording the replacement and the size of the final source code in the
+    /// profiler of the given context.
+    void replaceTokens(const StringMap& substitutions, GenContext& context, ShaderStage& stage) const;
+
   protected:
     static const string SEMICOLON;
     static const string COMMA;
@@ -215,7 +220,9 @@ class ShaderGenerator
     Factory<ShaderNodeImpl> _implFactory;
     ColorManagementSystemPtr _colorManagementSystem;
     UnitSystemPtr _unitSystem;
-    mutable StringMap _tokenSubstitutions;
+    StringMap _tokenSubstitutions;
+
+    friend class ShaderCache;
 };
 
 } // namespace MaterialX
@@ -13,9 +13,395 @@
 
 #include <MaterialXCore/Document.h>
 
+#include <algorithm>
+#include <cmath>
+
 namespace MaterialX
 {
 
+namespace
+{
+
+// Return the entries of a transform map ordered by port name, so that
+// transform nodes are added independently of the memory layout of ports.
+template<class PortType, class TransformType>
+vector<std::pair<PortType*, TransformType>> getOrderedTransforms(const std::unordered_map<PortType*, TransformType>& transformMap)
+{
+    vector<std::pair<PortType*, TransformType>> transforms(transformMap.begin(), transformMap.end());
+    std::sort(transforms.begin(), transforms.end(), [](const std::pair<PortType*, TransformType>& a,
+                                                       const std::pair<PortType*, TransformType>& b)
+    {
+        const string& nodeA = a.first->getNode()->getName();
+        const string& nodeB = b.first->getNode()->getName();
+        return nodeA != nodeB ? nodeA < nodeB : a.first->getName() < b.first->getName();
+    });
+    return transforms;
+}
+
+// Return true if any unconnected input of the given node will be published
+// as a uniform, which is the case for all unconnected editable inputs when
+// the shader interface is complete.
+bool hasPublishedInputs(const ShaderNode* node, int interfaceType)
+{
+    if (interfaceType == SHADER_INTERFACE_COMPLETE)
+    {
+        for (const ShaderInput* input : node->getInputs())
+        {
+            if (!input->getConnection() && input->getType()->isEditable() && node->isEditable(*input))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Return true if the given node may be merged with an identical node
+// without changing the interface of the shader.  Closure and shader nodes
+// are never merged, and neither are nodes with published inputs, since
+// each of these inputs is a uniform of its own.
+bool isMergeable(const ShaderNode* node, int interfaceType)
+{
+    if (node->hasClassification(ShaderNode::Classification::CLOSURE) ||
+        node->hasClassification(ShaderNode::Classification::SHADER) ||
+        node->hasClassification(ShaderNode::Classification::CONSTANT))
+    {
+        return false;
+    }
+    return !hasPublishedInputs(node, interfaceType);
+}
+
+// Return a hash of the implementation and inputs of the given node.
+size_t hashNode(const ShaderNode* node)
+{
+    size_t hash = std::hash<const ShaderNodeImpl*>()(&node->getImplementation());
+    auto combine = [&hash](size_t value)
+    {
+        hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    };
+    for (const ShaderInput* input : node->getInputs())
+    {
+        combine(std::hash<const ShaderOutput*>()(input->getConnection()));
+        if (!input->getConnection())
+        {
+            combine(std::hash<string>()(input->getValue() ? input->getValue()->getValueString() : EMPTY_STRING));
+        }
+    }
+    return hash;
+}
+
+// Return true if the given nodes compute identical results, sharing an
+// implementation and having equal unconnected inputs and identical
+// upstream connections.
+bool isEquivalent(const ShaderNode* a, const ShaderNode* b)
+{
+    if (&a->getImplementation() != &b->getImplementation() ||
+        a->numInputs() != b->numInputs() ||
+        a->numOutputs() != b->numOutputs())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a->numOutputs(); ++i)
+    {
+        const ShaderOutput* outputA = a->getOutput(i);
+        const ShaderOutput* outputB = b->getOutput(i);
+        if (outputA->getName() != outputB->getName() || outputA->getType() != outputB->getType())
+        {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < a->numInputs(); ++i)
+    {
+        const ShaderInput* inputA = a->getInput(i);
+        const ShaderInput* inputB = b->getInput(i);
+        if (inputA->getName() != inputB->getName() ||
+            inputA->getType() != inputB->getType() ||
+            inputA->getConnection() != inputB->getConnection() ||
+            inputA->getChannels() != inputB->getChannels() ||
+            inputA->getUnit() != inputB->getUnit() ||
+            inputA->getGeomProp() != inputB->getGeomProp())
+        {
+            return false;
+        }
+        if (!inputA->getConnection())
+        {
+            const ValuePtr valueA = inputA->getValue();
+            const ValuePtr valueB = inputB->getValue();
+            if ((valueA != nullptr) != (valueB != nullptr) ||
+                (valueA && (valueA->getTypeString() != valueB->getTypeString() ||
+                            valueA->getValueString() != valueB->getValueString())))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Assign a value to a downstream input, swizzling the value if the input
+// has channels set.
+void assignValue(GenContext& context, ShaderInput* downstream, ValuePtr value, const TypeDesc* type)
+{
+    downstream->setValue(value);
+
+    // Swizzle the value. Once done clear the channel to indicate
+    // no further swizzling is reqiured.
+    const string& channels = downstream->getChannels();
+    if (!channels.empty())
+    {
+        downstream->setValue(context.getShaderGenerator().getSyntax().getSwizzledValue(value,
+                                                                                  type,
+                                                                                  channels,
+                                                                                  downstream->getType()));
+        downstream->setType(downstream->getType());
+        downstream->setChannels(EMPTY_STRING);
+    }
+}
+
+// Return the float components of a scalar, color or vector value.
+bool getComponents(ConstValuePtr value, vector<float>& components)
+{
+    components.clear();
+    if (!value)
+    {
+        return false;
+    }
+    if (value->isA<float>())
+    {
+        components.push_back(value->asA<float>());
+    }
+    else if (value->isA<int>())
+    {
+        components.push_back(static_cast<float>(value->asA<int>()));
+    }
+    else if (value->isA<bool>())
+    {
+        components.push_back(value->asA<bool>() ? 1.0f : 0.0f);
+    }
+    else if (value->isA<Color2>())
+    {
+        const Color2& v = value->asA<Color2>();
+        components.assign(v.data(), v.data() + v.numElements());
+    }
+    else if (value->isA<Color3>())
+    {
+        const Color3& v = value->asA<Color3>();
+        components.assign(v.data(), v.data() + v.numElements());
+    }
+    else if (value->isA<Color4>())
+    {
+        const Color4& v = value->asA<Color4>();
+        components.assign(v.data(), v.data() + v.numElements());
+    }
+    else if (value->isA<Vector2>())
+    {
+        const Vector2& v = value->asA<Vector2>();
+        components.assign(v.data(), v.data() + v.numElements());
+    }
+    else if (value->isA<Vector3>())
+    {
+        const Vector3& v = value->asA<Vector3>();
+        components.assign(v.data(), v.data() + v.numElements());
+    }
+    else if (value->isA<Vector4>())
+    {
+        const Vector4& v = value->asA<Vector4>();
+        components.assign(v.data(), v.data() + v.numElements());
+    }
+    return !components.empty();
+}
+
+// Create a value of the given float, color or vector type from its
+// components, returning nullptr for other types or non-finite components.
+ValuePtr createValue(const TypeDesc* type, const vector<float>& c)
+{
+    if (c.size() != type->getSize())
+    {
+        return nullptr;
+    }
+    for (float component : c)
+    {
+        if (!std::isfinite(component))
+        {
+            return nullptr;
+        }
+    }
+    if (type == Type::FLOAT)
+    {
+        return Value::createValue(c[0]);
+    }
+    if (type == Type::COLOR2)
+    {
+        return Value::createValue(Color2(c[0], c[1]));
+    }
+    if (type == Type::COLOR3)
+    {
+        return Value::createValue(Color3(c[0], c[1], c[2]));
+    }
+    if (type == Type::COLOR4)
+    {
+        return Value::createValue(Color4(c[0], c[1], c[2], c[3]));
+    }
+    if (type == Type::VECTOR2)
+    {
+        return Value::createValue(Vector2(c[0], c[1]));
+    }
+    if (type == Type::VECTOR3)
+    {
+        return Value::createValue(Vector3(c[0], c[1], c[2]));
+    }
+    if (type == Type::VECTOR4)
+    {
+        return Value::createValue(Vector4(c[0], c[1], c[2], c[3]));
+    }
+    return nullptr;
+}
+
+// Return the component of a value at the given index, broadcasting
+// scalar values across all components.
+float getComponent(const vector<float>& components, size_t index)
+{
+    return components.size() == 1 ? components[0] : components[index];
+}
+
+// Evaluate a stdlib math node whose inputs are all unconnected, returning
+// the value of its output, or nullptr if the node cannot be evaluated.
+ValuePtr evaluateNode(const ShaderNode* node)
+{
+    static const string ADD("add");
+    static const string MULTIPLY("multiply");
+    static const string POWER("power");
+    static const string MIX("mix");
+    static const string CLAMP("clamp");
+    static const string SWIZZLE("swizzle");
+    static const string CONVERT("convert");
+
+    const string& op = node->getNodeString();
+    if (node->numOutputs() != 1 || !(op == ADD || op == MULTIPLY || op == POWER || op == MIX ||
+                                     op == CLAMP || op == SWIZZLE || op == CONVERT))
+    {
+        return nullptr;
+    }
+
+    const TypeDesc* outputType = node->getOutput()->getType();
+    const size_t size = outputType->getSize();
+
+    // Gather the components of all non-string inputs.
+    std::unordered_map<string, vector<float>> inputs;
+    for (const ShaderInput* input : node->getInputs())
+    {
+        if (input->getType() == Type::STRING)
+        {
+            continue;
+        }
+        vector<float>& components = inputs[input->getName()];
+        if (!getComponents(input->getValue(), components) ||
+            (components.size() != 1 && components.size() != size && op != SWIZZLE && op != CONVERT))
+        {
+            return nullptr;
+        }
+    }
+
+    vector<float> result(size);
+    if (op == ADD || op == MULTIPLY || op == POWER)
+    {
+        const vector<float>& in1 = inputs["in1"];
+        const vector<float>& in2 = inputs["in2"];
+        if (in1.empty() || in2.empty())
+        {
+            return nullptr;
+        }
+        for (size_t i = 0; i < size; ++i)
+        {
+            const float a = getComponent(in1, i);
+            const float b = getComponent(in2, i);
+            result[i] = op == ADD ? a + b : (op == MULTIPLY ? a * b : std::pow(a, b));
+        }
+    }
+    else if (op == MIX)
+    {
+        const vector<float>& fg = inputs["fg"];
+        const vector<float>& bg = inputs["bg"];
+        const vector<float>& mix = inputs["mix"];
+        if (fg.empty() || bg.empty() || mix.empty())
+        {
+            return nullptr;
+        }
+        for (size_t i = 0; i < size; ++i)
+        {
+            const float t = getComponent(mix, i);
+            result[i] = getComponent(bg, i) * (1.0f - t) + getComponent(fg, i) * t;
+        }
+    }
+    else if (op == CLAMP)
+    {
+        const vector<float>& in = inputs["in"];
+        const vector<float>& low = inputs["low"];
+        const vector<float>& high = inputs["high"];
+        if (in.empty() || low.empty() || high.empty())
+        {
+            return nullptr;
+        }
+        for (size_t i = 0; i < size; ++i)
+        {
+            result[i] = std::min(std::max(getComponent(in, i), getComponent(low, i)), getComponent(high, i));
+        }
+    }
+    else
+    {
+        const ShaderInput* input = node->getInput("in");
+        const vector<float>& in = inputs["in"];
+        if (!input || in.empty())
+        {
+            return nullptr;
+        }
+        if (op == SWIZZLE)
+        {
+            const ShaderInput* channelsInput = node->getInput("channels");
+            const string channels = channelsInput && channelsInput->getValue() ?
+                                    channelsInput->getValue()->getValueString() : EMPTY_STRING;
+            if (channels.size() != size)
+            {
+                return nullptr;
+            }
+            for (size_t i = 0; i < size; ++i)
+            {
+                const char ch = channels[i];
+                if (ch == '0' || ch == '1')
+                {
+                    result[i] = ch == '1' ? 1.0f : 0.0f;
+                    continue;
+                }
+                if (in.size() == 1)
+                {
+                    result[i] = in[0];
+                    continue;
+                }
+                const int index = input->getType()->getChannelIndex(ch);
+                if (index < 0 || index >= static_cast<int>(in.size()))
+                {
+                    return nullptr;
+                }
+                result[i] = in[index];
+            }
+        }
+        else
+        {
+            // Match the conversions of ConvertNode: scalars are broadcast,
+            // matching components are copied, and a missing third component
+            // is set to zero and a missing fourth component to one.
+            for (size_t i = 0; i < size; ++i)
+            {
+                result[i] = in.size() == 1 ? in[0] : (i < in.size() ? in[i] : (i == 3 ? 1.0f : 0.0f));
+            }
+        }
+    }
+
+    return createValue(outputType, result);
+}
+
+} // anonymous namespace
+
 //
 // ShaderGraph methods
 //
@@ -75,6 +461,8 @@ void ShaderGraph::createConnectedNodes(const ElementPtr& downstreamElement,
                                        GenContext& context,
                                        ShaderNode* rootNode)
 {
+    ScopedGenTimer timer(context, "createConnectedNodes", upstreamElement->getName());
+
     // Create the node if it doesn't exists
     NodePtr upstreamNode = upstreamElement->asA<Node>();
     if (!upstreamNode)
@@ -159,6 +547,8 @@ void ShaderGraph::createConnectedNodes(const ElementPtr& downstreamElement,
 
 void ShaderGraph::addUpstreamDependencies(const Element& root, ConstMaterialPtr material, GenContext& context)
 {
+    ScopedGenTimer timer(context, "addUpstreamDependencies", root.getName());
+
     // Keep track of our root node in the graph.
     // This is needed when the graph is a shader graph and we need
     // to make connections for BindInputs during traversal below.
@@ -1127,12 +1517,14 @@ const ShaderNode* ShaderGraph::getNode(const string& name) const
 
 void ShaderGraph::finalize(GenContext& context)
 {
+    ScopedGenTimer timer(context, "finalize", getName());
+
     // Insert color transformation nodes where needed
-    for (const auto& it : _inputColorTransformMap)
+    for (const auto& it : getOrderedTransforms(_inputColorTransformMap))
     {
         addColorTransformNode(it.first, it.second, context);
     }
-    for (const auto& it : _outputColorTransformMap)
+    for (const auto& it : getOrderedTransforms(_outputColorTransformMap))
     {
         addColorTransformNode(it.first, it.second, context);
     }
@@ -1140,11 +1532,11 @@ void ShaderGraph::finalize(GenContext& context)
     _outputColorTransformMap.clear();
 
     // Insert unit transformation nodes where needed
-    for (const auto& it : _inputUnitTransformMap)
+    for (const auto& it : getOrderedTransforms(_inputUnitTransformMap))
     {
         addUnitTransformNode(it.first, it.second, context);
     }
-    for (const auto& it : _outputUnitTransformMap)
+    for (const auto& it : getOrderedTransforms(_outputUnitTransformMap))
     {
         addUnitTransformNode(it.first, it.second, context);
     }
@@ -1188,13 +1580,27 @@ void ShaderGraph::finalize(GenContext& context)
     }
 
     // Sort the nodes in topological order.
-    topologicalSort();
+    {
+        ScopedGenTimer sortTimer(context, "topologicalSort", getName());
+        topologicalSort();
+    }
 
     // Calculate scopes for all nodes in the graph.
-    calculateScopes();
+    {
+        ScopedGenTimer scopeTimer(context, "calculateScopes", getName());
+        calculateScopes();
+    }
 
     // Set variable names for inputs and outputs in the graph.
-    setVariableNames(context);
+    {
+        ScopedGenTimer nameTimer(context, "setVariableNames", getName());
+        setVariableNames(context);
+    }
+
+    if (context.getProfiler())
+    {
+        context.getProfiler()->incrementCounter(GenProfiler::NODES, static_cast<int64_t>(_nodeOrder.size()));
+    }
 
     // Track closure nodes used by each surface shader.
     //
@@ -1233,6 +1639,8 @@ void ShaderGraph::disconnect(ShaderNode* node) const
 
 void ShaderGraph::optimize(GenContext& context)
 {
+    ScopedGenTimer timer(context, "optimize", getName());
+
     size_t numEdits = 0;
     for (ShaderNode* node : getNodes())
     {
@@ -1286,6 +1694,12 @@ void ShaderGraph::optimize(GenContext& context)
         }
     }
 
+    // Evaluate math nodes with constant inputs.
+    numEdits += foldConstants(context);
+
+    // Merge nodes computing identical results.
+    numEdits += mergeCommonSubexpressions(context);
+
     if (numEdits > 0)
     {
         std::set<ShaderNode*> usedNodes;
@@ -1302,7 +1716,10 @@ void ShaderGraph::optimize(GenContext& context)
             }
         }
 
-        // Remove any unused nodes
+        // Remove any unused nodes, keeping the current order of the
+        // remaining nodes.
+        vector<ShaderNode*> usedNodeOrder;
+        usedNodeOrder.reserve(usedNodes.size());
         for (ShaderNode* node : _nodeOrder)
         {
             if (usedNodes.count(node) == 0)
@@ -1313,11 +1730,130 @@ void ShaderGraph::optimize(GenContext& context)
                 // Erase from storage
                 _nodeMap.erase(node->getName());
             }
+            else
+            {
+                usedNodeOrder.push_back(node);
+            }
+        }
+
+        _nodeOrder = usedNodeOrder;
+    }
+}
+
+size_t ShaderGraph::foldConstants(GenContext& context)
+{
+    // Visit nodes in topological order, so that values computed upstream
+    // are pushed to downstream nodes before these are visited, and repeat
+    // until no more nodes can be evaluated.
+    topologicalSort();
+
+    const int interfaceType = context.getOptions().shaderInterfaceType;
+    std::set<ShaderNode*> foldedNodes;
+    size_t numFolded = 0;
+    for (size_t lastNumFolded = size_t(-1); lastNumFolded != numFolded; )
+    {
+        lastNumFolded = numFolded;
+        for (ShaderNode* node : _nodeOrder)
+        {
+            if (foldedNodes.count(node) || node->getNodeString().empty() ||
+                hasPublishedInputs(node, interfaceType))
+            {
+                continue;
+            }
+            bool connected = false;
+            for (const ShaderInput* input : node->getInputs())
+            {
+                connected = connected || input->getConnection();
+            }
+            ShaderOutput* output = node->getOutput();
+            if (connected || output->getConnections().empty())
+            {
+                continue;
+            }
+
+            ValuePtr value = evaluateNode(node);
+            if (!value)
+            {
+                continue;
+            }
+
+            // Replace the node with its value, leaving the node unused.
+            // Iterate a copy of the connection set since the
+            // original set will change when breaking connections.
+            ShaderInputSet downstreamConnections = output->getConnections();
+            for (ShaderInput* downstream : downstreamConnections)
+            {
+                output->breakConnection(downstream);
+                assignValue(context, downstream, value, output->getType());
+            }
+            foldedNodes.insert(node);
+            ++numFolded;
         }
+    }
 
-        _nodeOrder.resize(usedNodes.size());
-        _nodeOrder.assign(usedNodes.begin(), usedNodes.end());
+    return numFolded;
+}
+
+size_t ShaderGraph::mergeCommonSubexpressions(GenContext& context)
+{
+    // Visit nodes in topological order, so that when a node is reached
+    // all duplicates upstream of it have already been merged, and identical
+    // subgraphs collapse from their roots down.
+    topologicalSort();
+
+    const int interfaceType = context.getOptions().shaderInterfaceType;
+    std::unordered_map<size_t, vector<ShaderNode*>> visitedNodes;
+    size_t numMerged = 0;
+    for (ShaderNode* node : _nodeOrder)
+    {
+        if (!isMergeable(node, interfaceType))
+        {
+            continue;
+        }
+
+        // Skip nodes no longer in use.
+        bool used = false;
+        for (const ShaderOutput* output : node->getOutputs())
+        {
+            used = used || !output->getConnections().empty();
+        }
+        if (!used)
+        {
+            continue;
+        }
+
+        vector<ShaderNode*>& candidates = visitedNodes[hashNode(node)];
+        ShaderNode* original = nullptr;
+        for (ShaderNode* candidate : candidates)
+        {
+            if (isEquivalent(candidate, node))
+            {
+                original = candidate;
+                break;
+            }
+        }
+        if (!original)
+        {
+            candidates.push_back(node);
+            continue;
+        }
+
+        // Re-route the downstream connections of the duplicate to the
+        // original node, leaving the duplicate unused.
+        for (size_t i = 0; i < node->numOutputs(); ++i)
+        {
+            ShaderOutput* output = node->getOutput(i);
+            ShaderInputSet downstreamConnections = output->getConnections();
+            for (ShaderInput* downstream : downstreamConnections)
+            {
+                output->breakConnection(downstream);
+                downstream->makeConnection(original->getOutput(i));
+            }
+        }
+        ++numMerged;
     }
+
+    return numMerged;
 }
 
 void ShaderGraph::bypass(GenContext& context, ShaderNode* node, size_t inputIndex, size_t outputIndex)
@@ -1348,26 +1884,13 @@ void ShaderGraph::bypass(GenContext& context, ShaderNode* node, size_t inputInde
         for (ShaderInput* downstream : downstreamConnections)
         {
             output->breakConnection(downstream);
-            downstream->setValue(input->getValue());
+            assignValue(context, downstream, input->getValue(), input->getType());
             downstream->setPath(input->getPath());
             const string& inputUnit = input->getUnit();
             if (!inputUnit.empty())
             {
                 downstream->setUnit(inputUnit);
             }
-
-            // Swizzle the input value. Once done clear the channel to indicate
-            // no further swizzling is reqiured.
-            const string& channels = downstream->getChannels();
-            if (!channels.empty())
-            {
-                downstream->setValue(context.getShaderGenerator().getSyntax().getSwizzledValue(input->getValue(),
-                                                                                          input->getType(), 
-                                                                                          channels,
-                                                                                          downstream->getType()));
-                downstream->setType(downstream->getType());
-                downstream->setChannels(EMPTY_STRING);
-            }
         }
     }
 }
@@ -1403,9 +1926,16 @@ void ShaderGraph::topologicalSort()
         }
     }
 
+    // Nodes are stored unordered, so enqueue them by name.
+    std::sort(nodeQueue.begin(), nodeQueue.end(), [](const ShaderNode* a, const ShaderNode* b)
+    {
+        return a->getName() < b->getName();
+    });
+
     _nodeOrder.resize(_nodeMap.size(), nullptr);
     size_t count = 0;
 
+    vector<ShaderNode*> readyNodes;
     while (!nodeQueue.empty())
     {
         // Pop the queue and add to topological order.
@@ -1415,6 +1945,7 @@ void ShaderGraph::topologicalSort()
 
         // Find connected nodes and decrease their in-degree,
         // adding node to the queue if in-degrees becomes 0.
+        readyNodes.clear();
         for (const auto& output : node->getOutputs())
         {
             for (const auto& input : output->getConnections())
@@ -1423,11 +1954,19 @@ void ShaderGraph::topologicalSort()
                 {
                     if (--inDegree[input->getNode()] <= 0)
                     {
-                        nodeQueue.push_back(input->getNode());
+                        readyNodes.push_back(input->getNode());
                     }
                 }
             }
         }
+
+        // Connections are ordered by address, so enqueue ready nodes by
+        // name to keep the order independent of memory layout.
+        std::sort(readyNodes.begin(), readyNodes.end(), [](const ShaderNode* a, const ShaderNode* b)
+        {
+            return a->getName() < b->getName();
+        });
+        nodeQueue.insert(nodeQueue.end(), readyNodes.begin(), readyNodes.end());
     }
 
     // Check if there was a cycle.
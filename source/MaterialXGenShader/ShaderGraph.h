@@ -161,6 +161,19 @@ class ShaderGraph : public ShaderNode
     /// Optimize the graph, removing redundant paths.
     void optimize(GenContext& context);
 
+    /// Evaluate math nodes whose inputs are all unconnected, replacing
+    /// each node with the computed value of its output.  Only inputs that
+    /// are not published as uniforms are evaluated, so with a complete
+    /// shader interface, nodes with editable inputs are kept.
+    /// @return The number of nodes evaluated.
+    size_t foldConstants(GenContext& context);
+
+    /// Merge nodes that share an implementation and have identical inputs,
+    /// re-routing the downstream connections of each duplicate node to the
+    /// node it duplicates.
+    /// @return The number of nodes merged.
+    size_t mergeCommonSubexpressions(GenContext& context);
+
     /// Bypass a node for a particular input and output,
     /// effectively connecting the input's upstream connection
     /// with the output's downstream connections.
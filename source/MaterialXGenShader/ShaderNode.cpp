@@ -198,22 +198,31 @@ void ShaderNode::ScopeInfo::merge(const ScopeInfo &fromScope)
 
 ShaderNodePtr ShaderNode::create(const ShaderGraph* parent, const string& name, const NodeDef& nodeDef, GenContext& context)
 {
-    ShaderNodePtr newNode = std::make_shared<ShaderNode>(parent, name);
-
     const ShaderGenerator& shadergen = context.getShaderGenerator();
 
     // Find the implementation for this nodedef
+    ShaderNodeImplPtr nodeImpl;
     InterfaceElementPtr impl = nodeDef.getImplementation(shadergen.getTarget(), shadergen.getLanguage());
     if (impl)
     {
-        newNode->_impl = shadergen.getImplementation(*impl, context);
+        nodeImpl = shadergen.getImplementation(*impl, context);
     }
-    if (!newNode->_impl)
+    if (!nodeImpl)
     {
         throw ExceptionShaderGenError("Could not find a matching implementation for node '" + nodeDef.getNodeString() +
             "' matching language '" + shadergen.getLanguage() + "' and target '" + shadergen.getTarget() + "'");
     }
 
+    return create(parent, name, nodeDef, context, nodeImpl);
+}
+
+ShaderNodePtr ShaderNode::create(const ShaderGraph* parent, const string& name, const NodeDef& nodeDef,
+                                 GenContext& context, ShaderNodeImplPtr impl)
+{
+    ShaderNodePtr newNode = std::make_shared<ShaderNode>(parent, name);
+    newNode->_nodeString = nodeDef.getNodeString();
+    newNode->_impl = impl;
+
     // Check for classification based on group name
     unsigned int groupClassification = 0;
     string groupName = nodeDef.getNodeGroup();
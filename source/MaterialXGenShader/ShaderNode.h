@@ -294,6 +294,11 @@ class ShaderNode
     static ShaderNodePtr create(const ShaderGraph* parent, const string& name, const NodeDef& nodeDef, 
                                 GenContext& context);
 
+    /// Create a new node from a nodedef, using the given implementation in
+    /// place of the one found for the nodedef.
+    static ShaderNodePtr create(const ShaderGraph* parent, const string& name, const NodeDef& nodeDef,
+                                GenContext& context, ShaderNodeImplPtr impl);
+
     /// Create a new node from a node implementation.
     static ShaderNodePtr create(const ShaderGraph* parent, const string& name, ShaderNodeImplPtr impl,
                                 unsigned int classification = Classification::TEXTURE);
@@ -321,6 +326,13 @@ class ShaderNode
         return _name;
     }
 
+    /// Return the node string of the nodedef this node was created from,
+    /// or an empty string if the node was created from an implementation.
+    const string& getNodeString() const
+    {
+        return _nodeString;
+    }
+
     /// Return the implementation used for this node.
     const ShaderNodeImpl& getImplementation() const
     {
@@ -397,6 +409,7 @@ class ShaderNode
   protected:
     const ShaderGraph* _parent;
     string _name;
+    string _nodeString;
     unsigned int _classification;
 
     std::unordered_map<string, ShaderInputPtr> _inputMap;
@@ -14,6 +14,8 @@
 #include <MaterialXCore/Node.h>
 #include <MaterialXCore/Value.h>
 
+#include <algorithm>
+
 namespace MaterialX
 {
 
@@ -88,6 +90,54 @@ void VariableBlock::add(ShaderPortPtr port)
     }
 }
 
+//
+// CodeBuffer methods
+//
+
+const size_t CodeBuffer::DEFAULT_CHUNK_SIZE = 16 * 1024;
+
+void CodeBuffer::append(const char* data, size_t length)
+{
+    if (!length)
+    {
+        return;
+    }
+    if (_chunks.empty() || _chunks.back().capacity() - _chunks.back().size() < length)
+    {
+        _chunks.emplace_back();
+        _chunks.back().reserve(std::max(_chunkSize, length));
+    }
+    _chunks.back().append(data, length);
+    _chunkedSize += length;
+}
+
+void CodeBuffer::assign(string str)
+{
+    _code = std::move(str);
+    _chunks.clear();
+    _chunkedSize = 0;
+}
+
+void CodeBuffer::clear()
+{
+    assign(EMPTY_STRING);
+}
+
+void CodeBuffer::join() const
+{
+    if (_chunks.empty())
+    {
+        return;
+    }
+    _code.reserve(_code.size() + _chunkedSize);
+    for (const string& chunk : _chunks)
+    {
+        _code += chunk;
+    }
+    _chunks.clear();
+    _chunkedSize = 0;
+}
+
 //
 // ShaderStage methods
 //
@@ -196,19 +246,23 @@ void ShaderStage::beginScope(Syntax::Punctuation punc)
     switch (punc) {
     case Syntax::CURLY_BRACKETS:
         beginLine();
-        _code += "{" + _syntax->getNewline();
+        _code += "{";
+        _code += _syntax->getNewline();
         break;
     case Syntax::PARENTHESES:
         beginLine();
-        _code += "(" + _syntax->getNewline();
+        _code += "(";
+        _code += _syntax->getNewline();
         break;
     case Syntax::SQUARE_BRACKETS:
         beginLine();
-        _code += "[" + _syntax->getNewline();
+        _code += "[";
+        _code += _syntax->getNewline();
         break;
     }
 
     ++_indentations;
+    _indentation += _syntax->getIndentation();
     _scopes.push(punc);
 }
 
@@ -222,6 +276,7 @@ void ShaderStage::endScope(bool semicolon, bool newline)
     Syntax::Punctuation punc = _scopes.back();
     _scopes.pop();
     --_indentations;
+    _indentation.resize(_indentation.size() - _syntax->getIndentation().size());
 
     switch (punc) {
     case Syntax::CURLY_BRACKETS:
@@ -245,10 +300,7 @@ void ShaderStage::endScope(bool semicolon, bool newline)
 
 void ShaderStage::beginLine()
 {
-    for (int i = 0; i < _indentations; ++i)
-    {
-        _code += _syntax->getIndentation();
-    }
+    _code += _indentation;
 }
 
 void ShaderStage::endLine(bool semicolon)
@@ -280,38 +332,40 @@ void ShaderStage::addLine(const string& str, bool semicolon)
 void ShaderStage::addComment(const string& str)
 {
     beginLine();
-    _code += _syntax->getSingleLineComment() + str;
+    _code += _syntax->getSingleLineComment();
+    _code += str;
     endLine(false);
 }
 
 void ShaderStage::addBlock(const string& str, GenContext& context)
 {
-    const string& INCLUDE = _syntax->getIncludeStatement();
-    const string& QUOTE   = _syntax->getStringQuote();
+    addSegments(SourceCodeCache::preprocess(str, *_syntax), context);
+}
 
-    // Add each line in the block seperatelly
-    // to get correct indentation
-    StringStream stream(str);
-    for (string line; std::getline(stream, line); )
+void ShaderStage::addSegments(const SourceCodeCache::SegmentVec& segments, GenContext& context)
+{
+    // Runs of code can be appended directly at the outermost scope, while
+    // nested scopes require each line to be indented.
+    const bool appendCode = _indentations == 0 && _syntax->getNewline() == "\n";
+    for (const SourceCodeCache::Segment& segment : segments)
     {
-        size_t pos = line.find(INCLUDE);
-        if (pos != string::npos)
+        if (!segment.include.empty())
         {
-            size_t startQuote = line.find_first_of(QUOTE);
-            size_t endQuote = line.find_last_of(QUOTE);
-            if (startQuote != string::npos && endQuote != string::npos && endQuote > startQuote)
-            {
-                size_t length = (endQuote - startQuote) - 1;
-                if (length)
-                {
-                    const string filename = line.substr(startQuote + 1, length);
-                    addInclude(filename, context);
-                }
-            }
+            addInclude(segment.include, context);
+        }
+        else if (appendCode)
+        {
+            _code += segment.code;
         }
         else
         {
-            addLine(line, false);
+            size_t lineStart = 0;
+            while (lineStart < segment.code.size())
+            {
+                const size_t lineEnd = segment.code.find('\n', lineStart);
+                addLine(segment.code.substr(lineStart, lineEnd - lineStart), false);
+                lineStart = lineEnd + 1;
+            }
         }
     }
 }
@@ -319,19 +373,24 @@ void ShaderStage::addBlock(const string& str, GenContext& context)
 void ShaderStage::addInclude(const string& file, GenContext& context)
 {
     string resolvedFile = file;
+    tokenSubstitution(context.getTokenSubstitutions(), resolvedFile);
     tokenSubstitution(context.getShaderGenerator().getTokenSubstitutions(), resolvedFile);
 
     resolvedFile = context.resolveSourceFile(resolvedFile);
 
     if (!_includes.count(resolvedFile))
     {
-        string content;
-        if (!readFile(resolvedFile, content))
+        SourceCodeCache::SegmentVecPtr segments = SourceCodeCache::get().getSegments(resolvedFile, *_syntax);
+        if (!segments)
         {
             throw ExceptionShaderGenError("Could not find include file: '" + file + "'");
         }
         _includes.insert(resolvedFile);
-        addBlock(content, context);
+        if (context.getProfiler())
+        {
+            context.getProfiler()->incrementCounter(GenProfiler::INCLUDE_FILES);
+        }
+        addSegments(*segments, context);
     }
 }
 
@@ -343,6 +402,7 @@ void ShaderStage::addFunctionDefinition(const ShaderNode& node, GenContext& cont
     if (!_definedFunctions.count(id))
     {
         _definedFunctions.insert(id);
+        ScopedGenTimer timer(context, "emitFunctionDefinition", node.getName());
         impl.emitFunctionDefinition(node, context, *this);
     }
 }
@@ -13,6 +13,7 @@
 
 #include <MaterialXGenShader/GenOptions.h>
 #include <MaterialXGenShader/ShaderGraph.h>
+#include <MaterialXGenShader/SourceCodeCache.h>
 #include <MaterialXGenShader/Syntax.h>
 
 #include <MaterialXCore/Library.h>
@@ -119,6 +120,88 @@ class VariableBlock
     vector<ShaderPort*> _variableOrder;
 };
 
+/// @class CodeBuffer
+/// A buffer for emitting source code, which accumulates code in a sequence
+/// of pre-sized chunks.  Appending code never reallocates or copies the code
+/// already emitted, and the chunks are joined into a single string only when
+/// the code is requested.
+class CodeBuffer
+{
+  public:
+    /// Default capacity of each chunk, in characters.
+    static const size_t DEFAULT_CHUNK_SIZE;
+
+    CodeBuffer(size_t chunkSize = DEFAULT_CHUNK_SIZE) :
+        _chunkSize(chunkSize),
+        _chunkedSize(0)
+    {}
+
+    /// Append a sequence of characters.
+    void append(const char* data, size_t length);
+
+    /// Append a string.
+    void append(const string& str)
+    {
+        append(str.data(), str.size());
+    }
+
+    /// Append a string.
+    CodeBuffer& operator+=(const string& str)
+    {
+        append(str.data(), str.size());
+        return *this;
+    }
+
+    /// Append a null-terminated string.
+    CodeBuffer& operator+=(const char* str)
+    {
+        append(str, std::char_traits<char>::length(str));
+        return *this;
+    }
+
+    /// Return the number of characters in the buffer.
+    size_t size() const
+    {
+        return _code.size() + _chunkedSize;
+    }
+
+    /// Return true if the buffer holds no characters.
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /// Return the contents of the buffer as a single string, joining any
+    /// chunks appended since the last request.
+    const string& str() const
+    {
+        join();
+        return _code;
+    }
+
+    /// Return the contents of the buffer as a single string, which may be
+    /// edited in place.
+    string& str()
+    {
+        join();
+        return _code;
+    }
+
+    /// Replace the contents of the buffer with the given string.
+    void assign(string str);
+
+    /// Clear the contents of the buffer.
+    void clear();
+
+  private:
+    void join() const;
+
+    size_t _chunkSize;
+    mutable string _code;
+    mutable vector<string> _chunks;
+    mutable size_t _chunkedSize;
+};
+
 
 /// @class ShaderStage
 /// A shader stage, containing the state and 
@@ -135,8 +218,9 @@ class ShaderStage
     /// Return the stage function name.
     const string& getFunctionName() const { return _functionName; }
 
-    /// Return the stage source code.
-    const string& getSourceCode() const { return _code; }
+    /// Return the stage source code.  Code emitted to the stage is joined
+    /// on request, which is done by the generator when generation completes.
+    const string& getSourceCode() const { return _code.str(); }
 
     /// Create a new uniform variable block.
     VariableBlockPtr createUniformBlock(const string& name, const string& instance = EMPTY_STRING);
@@ -217,6 +301,9 @@ class ShaderStage
     /// Add a block of code.
     void addBlock(const string& str, GenContext& context);
 
+    /// Add a block of preprocessed code.
+    void addSegments(const SourceCodeCache::SegmentVec& segments, GenContext& context);
+
     /// Add the contents of an include file. Making sure it is 
     /// only included once for the shader stage.
     void addInclude(const string& file, GenContext& context);
@@ -252,6 +339,9 @@ class ShaderStage
     /// Current indentation level.
     int _indentations;
 
+    /// Indentation string for the current indentation level.
+    string _indentation;
+
     /// Current scope.
     std::queue<Syntax::Punctuation> _scopes;
 
@@ -274,9 +364,10 @@ class ShaderStage
     VariableBlockMap _outputs;
 
     /// Resulting source code for this stage.
-    string _code;
+    CodeBuffer _code;
 
     friend class ShaderGenerator;
+    friend class ShaderCache;
 };
 
 /// Shared pointer to a ShaderStage
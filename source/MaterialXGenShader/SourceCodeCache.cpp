@@ -0,0 +1,155 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <MaterialXGenShader/SourceCodeCache.h>
+
+#include <MaterialXGenShader/Syntax.h>
+#include <MaterialXGenShader/Util.h>
+
+namespace MaterialX
+{
+
+//
+// SourceCodeCache methods
+//
+
+SourceCodeCache& SourceCodeCache::get()
+{
+    static SourceCodeCache cache;
+    return cache;
+}
+
+SourceCodeCache::ContentPtr SourceCodeCache::getContent(const FilePath& filename)
+{
+    return getEntry(filename.asString(), EMPTY_STRING, nullptr).content;
+}
+
+SourceCodeCache::SegmentVecPtr SourceCodeCache::getSegments(const FilePath& filename, const Syntax& syntax)
+{
+    const string syntaxKey = syntax.getIncludeStatement() + syntax.getStringQuote();
+    Entry entry = getEntry(filename.asString(), syntaxKey, &syntax);
+    if (!entry.content)
+    {
+        return nullptr;
+    }
+    auto it = entry.segments.find(syntaxKey);
+    return it != entry.segments.end() ? it->second : nullptr;
+}
+
+size_t SourceCodeCache::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+void SourceCodeCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+}
+
+SourceCodeCache::Entry SourceCodeCache::getEntry(const string& filename, const string& syntaxKey, const Syntax* syntax)
+{
+    const int64_t modificationTime = FilePath(filename).getModificationTime();
+
+    // Return the cached entry if it is current and holds what is requested.
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(filename);
+        if (it != _entries.end() && it->second.modificationTime == modificationTime &&
+            (!syntax || !it->second.content || it->second.segments.count(syntaxKey)))
+        {
+            return it->second;
+        }
+    }
+
+    // Read and preprocess the file outside of the lock, so that threads
+    // requesting different files proceed concurrently.
+    Entry entry;
+    entry.modificationTime = modificationTime;
+    string content;
+    if (readFile(filename, content))
+    {
+        entry.content = std::make_shared<const string>(std::move(content));
+        if (syntax)
+        {
+            entry.segments[syntaxKey] = std::make_shared<const SegmentVec>(preprocess(*entry.content, *syntax));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry& cached = _entries[filename];
+    if (cached.content && cached.modificationTime == modificationTime)
+    {
+        // Another thread stored this version of the file, so merge in any
+        // segments we have preprocessed.
+        cached.segments.insert(entry.segments.begin(), entry.segments.end());
+    }
+    else
+    {
+        cached = entry;
+    }
+    return cached;
+}
+
+SourceCodeCache::SegmentVec SourceCodeCache::preprocess(const string& source, const Syntax& syntax)
+{
+    const string& INCLUDE = syntax.getIncludeStatement();
+    const string& QUOTE = syntax.getStringQuote();
+
+    SegmentVec segments;
+    Segment code;
+    size_t lineStart = 0;
+    size_t includePos = source.find(INCLUDE);
+    while (lineStart < source.size())
+    {
+        size_t lineEnd = source.find('\n', lineStart);
+        if (lineEnd == string::npos)
+        {
+            lineEnd = source.size();
+        }
+
+        if (includePos != string::npos && includePos < lineStart)
+        {
+            includePos = source.find(INCLUDE, lineStart);
+        }
+        if (includePos != string::npos && includePos < lineEnd)
+        {
+            const string line = source.substr(lineStart, lineEnd - lineStart);
+            size_t startQuote = line.find_first_of(QUOTE);
+            size_t endQuote = line.find_last_of(QUOTE);
+            if (startQuote != string::npos && endQuote != string::npos && endQuote > startQuote)
+            {
+                size_t length = (endQuote - startQuote) - 1;
+                if (length)
+                {
+                    if (!code.code.empty())
+                    {
+                        segments.push_back(std::move(code));
+                        code = Segment();
+                    }
+                    Segment include;
+                    include.include = line.substr(startQuote + 1, length);
+                    segments.push_back(std::move(include));
+                }
+            }
+        }
+        else
+        {
+            code.code.append(source, lineStart, lineEnd - lineStart);
+            code.code += '\n';
+        }
+
+        lineStart = lineEnd + 1;
+    }
+    if (!code.code.empty())
+    {
+        segments.push_back(std::move(code));
+    }
+
+    return segments;
+}
+
+} // namespace MaterialX
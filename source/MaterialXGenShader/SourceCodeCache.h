@@ -0,0 +1,99 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#ifndef MATERIALX_SOURCECODECACHE_H
+#define MATERIALX_SOURCECODECACHE_H
+
+/// @file
+/// A shared cache of source code files used during shader generation
+
+#include <MaterialXGenShader/Library.h>
+
+#include <MaterialXFormat/File.h>
+
+#include <mutex>
+
+namespace MaterialX
+{
+
+class Syntax;
+
+/// @class SourceCodeCache
+/// A thread-safe cache of the source code files read during shader
+/// generation, shared by all generators and contexts in the process.
+///
+/// Files are keyed by their resolved path and last modification time, so
+/// a file that changes on disk is read again on its next request.  Along
+/// with the raw content of each file, the cache stores its preprocessed
+/// form, in which lines are grouped into runs of code separated by include
+/// directives, allowing include files to be appended to shader stages
+/// without scanning them line by line.
+class SourceCodeCache
+{
+  public:
+    /// A segment of preprocessed source code, holding either a run of
+    /// complete lines of code or the filename of an include directive.
+    struct Segment
+    {
+        string code;
+        string include;
+    };
+
+    /// A sequence of preprocessed source code segments.
+    using SegmentVec = vector<Segment>;
+
+    /// Shared pointer to the content of a source code file.
+    using ContentPtr = shared_ptr<const string>;
+
+    /// Shared pointer to the preprocessed segments of a source code file.
+    using SegmentVecPtr = shared_ptr<const SegmentVec>;
+
+  public:
+    SourceCodeCache() { }
+    ~SourceCodeCache() { }
+
+    /// Return the cache shared by all shader generation in the process.
+    static SourceCodeCache& get();
+
+    /// Return the content of the given file, or nullptr if the file cannot
+    /// be read or is empty.
+    ContentPtr getContent(const FilePath& filename);
+
+    /// Return the preprocessed segments of the given file, using the include
+    /// statement and string quote of the given syntax, or nullptr if the
+    /// file cannot be read or is empty.
+    SegmentVecPtr getSegments(const FilePath& filename, const Syntax& syntax);
+
+    /// Return the number of files in the cache.
+    size_t size() const;
+
+    /// Clear all files from the cache.
+    void clear();
+
+    /// Split the given source code into segments, using the include statement
+    /// and string quote of the given syntax.  Lines containing the include
+    /// statement without a quoted filename are dropped.
+    static SegmentVec preprocess(const string& source, const Syntax& syntax);
+
+  protected:
+    struct Entry
+    {
+        int64_t modificationTime;
+        ContentPtr content;
+        std::unordered_map<string, SegmentVecPtr> segments;
+    };
+
+    // Return the entry for the given file, reading the file if it is not
+    // cached or has been modified.
+    Entry getEntry(const string& filename, const string& syntaxKey, const Syntax* syntax);
+
+  protected:
+    mutable std::mutex _mutex;
+    std::unordered_map<string, Entry> _entries;
+};
+
+} // namespace MaterialX
+
+#endif
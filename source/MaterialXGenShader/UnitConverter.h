@@ -185,6 +185,12 @@ class UnitConverterRegistry
     /// Returns -1 value if not found
     int getUnitAsInteger(const string& unitName) const;
 
+    /// Return the registered unit converters, keyed by unit type name.
+    const std::unordered_map<string, UnitConverterPtr>& getUnitConverters() const
+    {
+        return _unitConverters;
+    }
+
   private:
     UnitConverterRegistry(const UnitConverterRegistry&) = delete;
     UnitConverterRegistry() { }
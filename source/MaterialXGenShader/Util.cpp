@@ -12,9 +12,11 @@
 #include <MaterialXFormat/XmlIo.h>
 #include <MaterialXFormat/PugiXML/pugixml.hpp>
 
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <thread>
 
 namespace MaterialX
 {
@@ -688,6 +690,16 @@ bool requiresImplementation(ConstNodeDefPtr nodeDef)
     return !typeAttribute.empty() && typeAttribute != TYPE_NONE;
 }
 
+bool isDefinitionElement(ConstElementPtr element)
+{
+    return element->isA<NodeDef>() ||
+           element->isA<Implementation>() ||
+           element->isA<TypeDef>() ||
+           element->isA<UnitDef>() ||
+           element->isA<UnitTypeDef>() ||
+           (element->isA<NodeGraph>() && element->hasAttribute(InterfaceElement::NODE_DEF_ATTRIBUTE));
+}
+
 bool elementRequiresShading(ConstTypedElementPtr element)
 {
     string elementType(element->getType());
@@ -875,6 +887,66 @@ void findRenderableElements(ConstDocumentPtr doc, vector<TypedElementPtr>& eleme
     }
 }
 
+vector<ShaderPtr> generateBatch(const vector<TypedElementPtr>& elements, const GenContext& context,
+                                unsigned int threadCount, StringVec* errors)
+{
+    if (!threadCount)
+    {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    threadCount = (unsigned int) std::max(std::min((size_t) threadCount, elements.size()), (size_t) 1);
+
+    // Share implementations between the contexts of all threads.
+    ShaderNodeImplCachePtr implCache = context.getNodeImplementationCache();
+    if (!implCache)
+    {
+        implCache = ShaderNodeImplCache::create();
+    }
+
+    // Generate shaders across worker threads, with each element storing its
+    // shader or error in its own slot.
+    vector<ShaderPtr> shaders(elements.size());
+    StringVec messages(elements.size());
+    std::atomic<size_t> nextElement(0);
+    auto generateElements = [&]()
+    {
+        GenContext threadContext(context);
+        threadContext.setNodeImplementationCache(implCache);
+        const ShaderGenerator& generator = threadContext.getShaderGenerator();
+        for (size_t i = nextElement++; i < elements.size(); i = nextElement++)
+        {
+            try
+            {
+                shaders[i] = generator.generate(elements[i]->getName(), elements[i], threadContext);
+            }
+            catch (std::exception& e)
+            {
+                messages[i] = e.what();
+            }
+            catch (...)
+            {
+                messages[i] = "Unknown error in shader generation";
+            }
+        }
+    };
+    vector<std::thread> threads;
+    for (unsigned int i = 1; i < threadCount; i++)
+    {
+        threads.emplace_back(generateElements);
+    }
+    generateElements();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    if (errors)
+    {
+        *errors = std::move(messages);
+    }
+
+    return shaders;
+}
+
 ValueElementPtr findNodeDefChild(const string& path, DocumentPtr doc, const string& target)
 {
     if (path.empty() || !doc)
@@ -928,30 +1000,35 @@ namespace
 
 void tokenSubstitution(const StringMap& substitutions, string& source)
 {
+    size_t pos = source.find(TOKEN_PREFIX);
+    if (pos == string::npos)
+    {
+        return;
+    }
+
     string buffer;
-    size_t pos = 0, len = source.length();
-    while (pos < len)
+    buffer.reserve(source.size());
+    string token;
+    size_t copied = 0, len = source.length();
+    while (pos != string::npos && pos + 1 < len)
     {
-        size_t p1 = source.find_first_of(TOKEN_PREFIX, pos);
-        if (p1 != string::npos && p1 + 1 < len)
+        size_t end = pos + 1;
+        while (end < len && isalnum(source[end]))
         {
-            buffer += source.substr(pos, p1 - pos);
-            pos = p1 + 1;
-            string token = { TOKEN_PREFIX };
-            while (pos < len && isalnum(source[pos]))
-            {
-                token += source[pos++];
-            }
-            auto it = substitutions.find(token);
-            buffer += (it != substitutions.end() ? it->second : token);
+            ++end;
         }
-        else
+        token.assign(source, pos, end - pos);
+        auto it = substitutions.find(token);
+        if (it != substitutions.end())
         {
-            buffer += source.substr(pos);
-            break;
+            buffer.append(source, copied, pos - copied);
+            buffer += it->second;
+            copied = end;
         }
+        pos = source.find(TOKEN_PREFIX, end);
     }
-    source = buffer;
+    buffer.append(source, copied, string::npos);
+    source.swap(buffer);
 }
 
 vector<Vector2> getUdimCoordinates(const StringVec& udimIdentifiers)
@@ -76,6 +76,11 @@ void mapValueToColor(ConstValuePtr value, Color4& color);
 /// Return whether a nodedef requires an implementation
 bool requiresImplementation(ConstNodeDefPtr nodeDef);
 
+/// Return true if the given element is a definition used by shader
+/// generation: a nodedef, implementation, typedef, unitdef, unittypedef,
+/// or a nodegraph implementing a nodedef.
+bool isDefinitionElement(ConstElementPtr element);
+
 /// Determine if a given element requires shading / lighting for rendering
 bool elementRequiresShading(ConstTypedElementPtr element);
 
@@ -128,6 +133,29 @@ void findRenderableShaderRefs(ConstDocumentPtr doc,
 void findRenderableElements(ConstDocumentPtr doc, vector<TypedElementPtr>& elements,
                             bool includeReferencedGraphs = false);
 
+/// Generate shaders for a batch of elements, distributing the work across
+/// multiple threads.  Each thread generates shaders in its own copy of the
+/// given context, sharing the shader generator, the user data of the context
+/// and a shared implementation cache.  If the given context has no shared
+/// implementation cache, then one is created for the duration of the batch.
+///
+/// The documents of the given elements are only read during generation, and
+/// must not be modified until the batch is complete.  Shaders are returned
+/// in the order of the given elements, and match those generated serially.
+/// A failure to generate one element does not affect the other elements.
+/// @param elements The elements for which shaders are generated.
+/// @param context The context from which the context of each element is copied.
+/// @param threadCount The number of threads to use, where zero selects
+///    the number of hardware threads available.
+/// @param errors An optional vector which, if provided, is resized to the
+///    number of elements, and receives the error message of each element
+///    that failed to generate, or an empty string for each element that
+///    succeeded.
+/// @return A vector of shaders, one for each of the given elements, where
+///    elements that failed to generate have a null shader.
+vector<ShaderPtr> generateBatch(const vector<TypedElementPtr>& elements, const GenContext& context,
+                                unsigned int threadCount = 0, StringVec* errors = nullptr);
+
 /// Given a path to a element, find the corresponding element with the same name
 /// on an associated nodedef if it exists. A target string should be provided
 /// if the path is to a Node as definitions for Nodes can be target specific.
@@ -9,18 +9,555 @@
 
 #include <MaterialXGenShader/Nodes/ConvolutionNode.h>
 
+#include <limits>
+#include <thread>
+
 namespace MaterialX
 {
 
+namespace
+{
+
+const unsigned int BLOCK_DIM = 4;
+const unsigned int BLOCK_TEXELS = BLOCK_DIM * BLOCK_DIM;
+
+// Texels of a block, in row-major order, with up to three 8-bit channels.
+using BlockTexels = uint8_t[BLOCK_TEXELS][3];
+
+size_t getBlockByteCount(Image::CompressionFormat format)
+{
+    switch (format)
+    {
+        case Image::CompressionFormat::BC1: return 8;
+        case Image::CompressionFormat::BC4: return 8;
+        case Image::CompressionFormat::BC5: return 16;
+        default: return 0;
+    }
+}
+
+unsigned int getCompressedChannelCount(Image::CompressionFormat format)
+{
+    switch (format)
+    {
+        case Image::CompressionFormat::BC1: return 3;
+        case Image::CompressionFormat::BC4: return 1;
+        case Image::CompressionFormat::BC5: return 2;
+        default: return 0;
+    }
+}
+
+uint8_t quantize(float value)
+{
+    return (uint8_t) (std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+float toFloat(uint8_t value) { return value / 255.0f; }
+float toFloat(Half value) { return value; }
+float toFloat(float value) { return value; }
+
+template <class T> T fromFloat(float value);
+template <> uint8_t fromFloat<uint8_t>(float value) { return quantize(value); }
+template <> Half fromFloat<Half>(float value) { return Half(value); }
+template <> float fromFloat<float>(float value) { return value; }
+
+template <class T> Color4 readTexel(const T* data, unsigned int channelCount)
+{
+    switch (channelCount)
+    {
+        case 4: return Color4(toFloat(data[0]), toFloat(data[1]), toFloat(data[2]), toFloat(data[3]));
+        case 3: return Color4(toFloat(data[0]), toFloat(data[1]), toFloat(data[2]), 1.0f);
+        case 2: return Color4(toFloat(data[0]), toFloat(data[1]), 0.0f, 1.0f);
+        case 1: return Color4(toFloat(data[0]), toFloat(data[0]), toFloat(data[0]), 1.0f);
+        default: throw Exception("Unsupported channel count in getTexelColor");
+    }
+}
+
+template <class T> void writeTexel(T* data, unsigned int channelCount, const Color4& color)
+{
+    unsigned int writeChannels = std::min(channelCount, (unsigned int) 4);
+    for (unsigned int c = 0; c < writeChannels; c++)
+    {
+        data[c] = fromFloat<T>(color[c]);
+    }
+}
+
+template <class S, class D> void convertComponents(const S* src, D* dst, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = fromFloat<D>(toFloat(src[i]));
+    }
+}
+
+template <class S> void convertComponents(const S* src, void* dst, Image::BaseType dstType, size_t count)
+{
+    switch (dstType)
+    {
+        case Image::BaseType::UINT8: convertComponents(src, static_cast<uint8_t*>(dst), count); break;
+        case Image::BaseType::HALF: convertComponents(src, static_cast<Half*>(dst), count); break;
+        case Image::BaseType::FLOAT: convertComponents(src, static_cast<float*>(dst), count); break;
+        default: throw Exception("Unsupported base type in convert");
+    }
+}
+
+// Run the given task over the range [0, count) in chunks of at least
+// minChunk items, on up to one thread per hardware thread.
+void parallelFor(size_t count, size_t minChunk, const std::function<void(size_t, size_t)>& task)
+{
+    size_t threadCount = std::min((size_t) std::max(std::thread::hardware_concurrency(), 1u),
+                                  (count + minChunk - 1) / minChunk);
+    if (threadCount <= 1)
+    {
+        task(0, count);
+        return;
+    }
+
+    size_t chunk = (count + threadCount - 1) / threadCount;
+    vector<std::thread> threads;
+    for (size_t begin = chunk; begin < count; begin += chunk)
+    {
+        threads.emplace_back(task, begin, std::min(begin + chunk, count));
+    }
+    task(0, chunk);
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+//
+// Mip levels are filtered with a box filter, in which each destination
+// texel averages the source texels it covers, weighted by their coverage.
+//
+
+struct FilterTap
+{
+    unsigned int index;
+    float weight;
+};
+
+vector<vector<FilterTap>> getBoxFilterTaps(unsigned int srcSize, unsigned int dstSize)
+{
+    vector<vector<FilterTap>> taps(dstSize);
+    const float scale = (float) srcSize / dstSize;
+    for (unsigned int d = 0; d < dstSize; d++)
+    {
+        const float start = d * scale;
+        const float end = (d + 1) * scale;
+        for (unsigned int s = (unsigned int) start; s < srcSize && s < end; s++)
+        {
+            float weight = std::min(end, s + 1.0f) - std::max(start, (float) s);
+            if (weight > 0.0f)
+            {
+                taps[d].push_back({ s, weight / scale });
+            }
+        }
+    }
+    return taps;
+}
+
+void downsample(const float* src, unsigned int srcWidth, unsigned int srcHeight,
+                float* dst, unsigned int dstWidth, unsigned int dstHeight,
+                unsigned int channelCount)
+{
+    const vector<vector<FilterTap>> xTaps = getBoxFilterTaps(srcWidth, dstWidth);
+    const vector<vector<FilterTap>> yTaps = getBoxFilterTaps(srcHeight, dstHeight);
+    const size_t srcRowSize = (size_t) srcWidth * channelCount;
+    const size_t dstRowSize = (size_t) dstWidth * channelCount;
+
+    parallelFor(dstHeight, 16, [&](size_t begin, size_t end)
+    {
+        vector<float> row(srcRowSize);
+        for (size_t y = begin; y < end; y++)
+        {
+            // Filter vertically into a full-width row, then horizontally
+            // into the destination, with inner loops running over
+            // contiguous channels.
+            std::fill(row.begin(), row.end(), 0.0f);
+            for (const FilterTap& tap : yTaps[y])
+            {
+                const float* srcRow = src + tap.index * srcRowSize;
+                for (size_t i = 0; i < srcRowSize; i++)
+                {
+                    row[i] += srcRow[i] * tap.weight;
+                }
+            }
+
+            float* dstRow = dst + y * dstRowSize;
+            std::fill(dstRow, dstRow + dstRowSize, 0.0f);
+            for (unsigned int x = 0; x < dstWidth; x++)
+            {
+                float* dstTexel = dstRow + (size_t) x * channelCount;
+                for (const FilterTap& tap : xTaps[x])
+                {
+                    const float* srcTexel = row.data() + (size_t) tap.index * channelCount;
+                    for (unsigned int c = 0; c < channelCount; c++)
+                    {
+                        dstTexel[c] += srcTexel[c] * tap.weight;
+                    }
+                }
+            }
+        }
+    });
+}
+
+// Return the texels of the given image as floats, converting the image
+// into the given holder if it does not already hold float texels.
+const float* getFloatTexels(const Image& image, ImagePtr& holder)
+{
+    if (image.getBaseType() == Image::BaseType::FLOAT && !image.isCompressed())
+    {
+        if (!image.getResourceBuffer())
+        {
+            throw Exception("Invalid resource buffer");
+        }
+        return static_cast<const float*>(image.getResourceBuffer());
+    }
+    holder = image.convert(Image::BaseType::FLOAT);
+    return static_cast<const float*>(holder->getResourceBuffer());
+}
+
+// Apply a separable filter with the given odd-sized kernel to the columns,
+// then the rows, of an image with float texels, clamping at the edges.
+// Rows are filtered in parallel, with inner loops running over contiguous
+// components so that they vectorize.
+void applySeparableFilter(const float* src, float* dst,
+                          unsigned int width, unsigned int height, unsigned int channelCount,
+                          const float* kernel, unsigned int kernelSize)
+{
+    const int radius = (int) kernelSize / 2;
+    const size_t rowSize = (size_t) width * channelCount;
+    const int edgeEnd = std::min(radius, (int) width);
+    const int interiorEnd = std::max((int) width - radius, edgeEnd);
+
+    parallelFor(height, 16, [&](size_t begin, size_t end)
+    {
+        vector<float> row(rowSize);
+        for (size_t y = begin; y < end; y++)
+        {
+            std::fill(row.begin(), row.end(), 0.0f);
+            for (unsigned int k = 0; k < kernelSize; k++)
+            {
+                int sy = std::min(std::max((int) y + (int) k - radius, 0), (int) height - 1);
+                const float* srcRow = src + sy * rowSize;
+                const float weight = kernel[k];
+                for (size_t i = 0; i < rowSize; i++)
+                {
+                    row[i] += srcRow[i] * weight;
+                }
+            }
+
+            float* dstRow = dst + y * rowSize;
+            std::fill(dstRow, dstRow + rowSize, 0.0f);
+            for (unsigned int k = 0; k < kernelSize; k++)
+            {
+                const int offset = (int) k - radius;
+                const float weight = kernel[k];
+
+                // Texels within the kernel radius of the edges read
+                // clamped coordinates.
+                for (int x = 0; x < (int) width; x = (x + 1 == edgeEnd) ? interiorEnd : x + 1)
+                {
+                    int sx = std::min(std::max(x + offset, 0), (int) width - 1);
+                    for (unsigned int c = 0; c < channelCount; c++)
+                    {
+                        dstRow[x * channelCount + c] += row[sx * channelCount + c] * weight;
+                    }
+                }
+
+                // Interior texels are filtered as one contiguous span.
+                if (interiorEnd > edgeEnd)
+                {
+                    const float* srcSpan = row.data() + (edgeEnd + offset) * channelCount;
+                    float* dstSpan = dstRow + edgeEnd * channelCount;
+                    const size_t spanSize = (size_t) (interiorEnd - edgeEnd) * channelCount;
+                    for (size_t i = 0; i < spanSize; i++)
+                    {
+                        dstSpan[i] += srcSpan[i] * weight;
+                    }
+                }
+            }
+        }
+    });
+}
+
+// Filter an image with a separable kernel, returning an uncompressed image
+// with the base type and channel count of the source.
+ImagePtr applySeparableFilter(const Image& image, const float* kernel, unsigned int kernelSize)
+{
+    ImagePtr holder;
+    const float* src = getFloatTexels(image, holder);
+    ImagePtr result = Image::create(image.getWidth(), image.getHeight(), image.getChannelCount(), Image::BaseType::FLOAT);
+    result->createResourceBuffer();
+    applySeparableFilter(src, static_cast<float*>(result->getResourceBuffer()),
+                         image.getWidth(), image.getHeight(), image.getChannelCount(),
+                         kernel, kernelSize);
+    return image.getBaseType() == Image::BaseType::FLOAT ? result : result->convert(image.getBaseType());
+}
+
+//
+// BC4 blocks hold two 8-bit endpoints followed by 3-bit palette indices.
+//
+
+void encodeBC4Block(const BlockTexels& texels, unsigned int channel, uint8_t* block)
+{
+    uint8_t minValue = 255;
+    uint8_t maxValue = 0;
+    for (unsigned int i = 0; i < BLOCK_TEXELS; i++)
+    {
+        minValue = std::min(minValue, texels[i][channel]);
+        maxValue = std::max(maxValue, texels[i][channel]);
+    }
+
+    // Use the eight value mode, in which the palette interpolates from
+    // the first endpoint (index 0) to the second endpoint (index 1)
+    // through indices 2 to 7.
+    block[0] = maxValue;
+    block[1] = minValue;
+    uint64_t indices = 0;
+    const int range = maxValue - minValue;
+    if (range > 0)
+    {
+        for (unsigned int i = 0; i < BLOCK_TEXELS; i++)
+        {
+            int step = ((maxValue - texels[i][channel]) * 7 + range / 2) / range;
+            uint64_t index = step == 0 ? 0 : (step == 7 ? 1 : step + 1);
+            indices |= index << (3 * i);
+        }
+    }
+    for (unsigned int b = 0; b < 6; b++)
+    {
+        block[2 + b] = (uint8_t) (indices >> (8 * b));
+    }
+}
+
+void decodeBC4Block(const uint8_t* block, unsigned int channel, BlockTexels& texels)
+{
+    const int value0 = block[0];
+    const int value1 = block[1];
+    uint8_t palette[8] = { (uint8_t) value0, (uint8_t) value1 };
+    if (value0 > value1)
+    {
+        for (int k = 2; k < 8; k++)
+        {
+            palette[k] = (uint8_t) (((8 - k) * value0 + (k - 1) * value1) / 7);
+        }
+    }
+    else
+    {
+        for (int k = 2; k < 6; k++)
+        {
+            palette[k] = (uint8_t) (((6 - k) * value0 + (k - 1) * value1) / 5);
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    uint64_t indices = 0;
+    for (unsigned int b = 0; b < 6; b++)
+    {
+        indices |= (uint64_t) block[2 + b] << (8 * b);
+    }
+    for (unsigned int i = 0; i < BLOCK_TEXELS; i++)
+    {
+        texels[i][channel] = palette[(indices >> (3 * i)) & 0x7];
+    }
+}
+
+//
+// BC1 blocks hold two RGB565 endpoints followed by 2-bit palette indices.
+//
+
+uint16_t packRGB565(const int* rgb)
+{
+    return (uint16_t) (((rgb[0] * 31 + 127) / 255) << 11 |
+                       ((rgb[1] * 63 + 127) / 255) << 5 |
+                       ((rgb[2] * 31 + 127) / 255));
+}
+
+void unpackRGB565(uint16_t color, int* rgb)
+{
+    const int r = (color >> 11) & 0x1f;
+    const int g = (color >> 5) & 0x3f;
+    const int b = color & 0x1f;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+void getBC1Palette(uint16_t color0, uint16_t color1, int palette[4][3])
+{
+    unpackRGB565(color0, palette[0]);
+    unpackRGB565(color1, palette[1]);
+    for (unsigned int c = 0; c < 3; c++)
+    {
+        if (color0 > color1)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        else
+        {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+}
+
+void encodeBC1Block(const BlockTexels& texels, uint8_t* block)
+{
+    // Find the bounding box and mean of the block colors.
+    int minColor[3] = { 255, 255, 255 };
+    int maxColor[3] = { 0, 0, 0 };
+    int mean[3] = { 0, 0, 0 };
+    for (unsigned int i = 0; i < BLOCK_TEXELS; i++)
+    {
+        for (unsigned int c = 0; c < 3; c++)
+        {
+            minColor[c] = std::min(minColor[c], (int) texels[i][c]);
+            maxColor[c] = std::max(maxColor[c], (int) texels[i][c]);
+            mean[c] += texels[i][c];
+        }
+    }
+    for (unsigned int c = 0; c < 3; c++)
+    {
+        mean[c] /= BLOCK_TEXELS;
+    }
+
+    // Select the diagonal of the bounding box that best follows the colors,
+    // by flipping the green and blue extents where they are anti-correlated
+    // with red.
+    int covariance[3] = { 0, 0, 0 };
+    for (unsigned int i = 0; i < BLOCK_TEXELS; i++)
+    {
+        const int dr = texels[i][0] - mean[0];
+        covariance[1] += dr * (texels[i][1] - mean[1]);
+        covariance[2] += dr * (texels[i][2] - mean[2]);
+    }
+    for (unsigned int c = 1; c < 3; c++)
+    {
+        if (covariance[c] < 0)
+        {
+            std::swap(minColor[c], maxColor[c]);
+        }
+    }
+
+    // Order the endpoints for the four color mode, in which the palette
+    // holds the endpoints and two colors interpolated between them.
+    uint16_t color0 = packRGB565(maxColor);
+    uint16_t color1 = packRGB565(minColor);
+    if (color0 < color1)
+    {
+        std::swap(color0, color1);
+    }
+
+    uint32_t indices = 0;
+    if (color0 != color1)
+    {
+        int palette[4][3];
+        getBC1Palette(color0, color1, palette);
+        for (unsigned int i = 0; i < BLOCK_TEXELS; i++)
+        {
+            uint32_t bestIndex = 0;
+            int bestError = std::numeric_limits<int>::max();
+            for (uint32_t k = 0; k < 4; k++)
+            {
+                int error = 0;
+                for (unsigned int c = 0; c < 3; c++)
+                {
+                    const int d = texels[i][c] - palette[k][c];
+                    error += d * d;
+                }
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestIndex = k;
+                }
+            }
+            indices |= bestIndex << (2 * i);
+        }
+    }
+
+    block[0] = (uint8_t) color0;
+    block[1] = (uint8_t) (color0 >> 8);
+    block[2] = (uint8_t) color1;
+    block[3] = (uint8_t) (color1 >> 8);
+    for (unsigned int b = 0; b < 4; b++)
+    {
+        block[4 + b] = (uint8_t) (indices >> (8 * b));
+    }
+}
+
+void decodeBC1Block(const uint8_t* block, BlockTexels& texels)
+{
+    const uint16_t color0 = (uint16_t) (block[0] | block[1] << 8);
+    const uint16_t color1 = (uint16_t) (block[2] | block[3] << 8);
+    int palette[4][3];
+    getBC1Palette(color0, color1, palette);
+
+    const uint32_t indices = (uint32_t) block[4] | (uint32_t) block[5] << 8 |
+                             (uint32_t) block[6] << 16 | (uint32_t) block[7] << 24;
+    for (unsigned int i = 0; i < BLOCK_TEXELS; i++)
+    {
+        const int* color = palette[(indices >> (2 * i)) & 0x3];
+        for (unsigned int c = 0; c < 3; c++)
+        {
+            texels[i][c] = (uint8_t) color[c];
+        }
+    }
+}
+
+void encodeBlock(Image::CompressionFormat format, const BlockTexels& texels, uint8_t* block)
+{
+    switch (format)
+    {
+        case Image::CompressionFormat::BC1:
+            encodeBC1Block(texels, block);
+            break;
+        case Image::CompressionFormat::BC4:
+            encodeBC4Block(texels, 0, block);
+            break;
+        case Image::CompressionFormat::BC5:
+            encodeBC4Block(texels, 0, block);
+            encodeBC4Block(texels, 1, block + 8);
+            break;
+        default:
+            throw Exception("Unsupported compression format in compress");
+    }
+}
+
+void decodeBlock(Image::CompressionFormat format, const uint8_t* block, BlockTexels& texels)
+{
+    switch (format)
+    {
+        case Image::CompressionFormat::BC1:
+            decodeBC1Block(block, texels);
+            break;
+        case Image::CompressionFormat::BC4:
+            decodeBC4Block(block, 0, texels);
+            break;
+        case Image::CompressionFormat::BC5:
+            decodeBC4Block(block, 0, texels);
+            decodeBC4Block(block + 8, 1, texels);
+            break;
+        default:
+            throw Exception("Unsupported compression format");
+    }
+}
+
+} // anonymous namespace
+
 //
 // Image methods
 //
 
-Image::Image(unsigned int width, unsigned int height, unsigned int channelCount, BaseType baseType) :
+Image::Image(unsigned int width, unsigned int height, unsigned int channelCount, BaseType baseType,
+             CompressionFormat compressionFormat) :
     _width(width),
     _height(height),
     _channelCount(channelCount),
     _baseType(baseType),
+    _compressionFormat(compressionFormat),
     _resourceBuffer(nullptr),
     _resourceBufferDeallocator(nullptr),
     _resourceId(0)
@@ -54,6 +591,16 @@ unsigned int Image::getMaxMipCount() const
     return (unsigned int) std::log2(std::max(_width, _height)) + 1;
 }
 
+size_t Image::getResourceBufferSize() const
+{
+    if (isCompressed())
+    {
+        size_t blockCount = (size_t) ((_width + BLOCK_DIM - 1) / BLOCK_DIM) * ((_height + BLOCK_DIM - 1) / BLOCK_DIM);
+        return blockCount * getBlockByteCount(_compressionFormat);
+    }
+    return (size_t) _width * _height * _channelCount * getBaseStride();
+}
+
 ImagePtr Image::createConstantColor(unsigned int width, unsigned int height, const Color4& color)
 {
     unsigned int channelCount = 4;
@@ -89,23 +636,23 @@ void Image::setTexelColor(unsigned int x, unsigned int y, const Color4& color)
     {
         throw Exception("Invalid resource buffer in setTexelColor");
     }
+    if (isCompressed())
+    {
+        throw Exception("Unsupported compressed image in setTexelColor");
+    }
 
-    unsigned int writeChannels = std::min(_channelCount, (unsigned int) 4);
+    size_t offset = ((size_t) y * _width + x) * _channelCount;
     if (_baseType == BaseType::FLOAT)
     {
-        float* data = static_cast<float*>(_resourceBuffer) + (y * _width + x) * _channelCount;
-        for (unsigned int c = 0; c < writeChannels; c++)
-        {
-            data[c] = color[c];
-        }
+        writeTexel(static_cast<float*>(_resourceBuffer) + offset, _channelCount, color);
     }
     else if (_baseType == BaseType::HALF)
     {
-        Half* data = static_cast<Half*>(_resourceBuffer) + (y * _width + x) * _channelCount;
-        for (unsigned int c = 0; c < writeChannels; c++)
-        {
-            data[c] = (Half) color[c];
-        }
+        writeTexel(static_cast<Half*>(_resourceBuffer) + offset, _channelCount, color);
+    }
+    else if (_baseType == BaseType::UINT8)
+    {
+        writeTexel(static_cast<uint8_t*>(_resourceBuffer) + offset, _channelCount, color);
     }
     else
     {
@@ -124,159 +671,261 @@ Color4 Image::getTexelColor(unsigned int x, unsigned int y) const
         throw Exception("Invalid resource buffer in getTexelColor");
     }
 
+    if (isCompressed())
+    {
+        BlockTexels texels;
+        decodeBlock(_compressionFormat, static_cast<const uint8_t*>(_resourceBuffer) + getBlockOffset(x, y), texels);
+        return readTexel(texels[(y % BLOCK_DIM) * BLOCK_DIM + x % BLOCK_DIM], _channelCount);
+    }
+
+    size_t offset = ((size_t) y * _width + x) * _channelCount;
     if (_baseType == BaseType::FLOAT)
     {
-        float* data = static_cast<float*>(_resourceBuffer) + (y * _width + x) * _channelCount;
-        if (_channelCount == 4)
-        {
-            return Color4(data[0], data[1], data[2], data[3]);
-        }
-        else if (_channelCount == 3)
-        {
-            return Color4(data[0], data[1], data[2], 1.0f);
-        }
-        else if (_channelCount == 2)
-        {
-            return Color4(data[0], data[1], 0.0f, 1.0f);
-        }
-        else if (_channelCount == 1)
-        {
-            return Color4(data[0], data[0], data[0], 1.0f);
-        }
-        else
-        {
-            throw Exception("Unsupported channel count in getTexelColor");
-        }
+        return readTexel(static_cast<const float*>(_resourceBuffer) + offset, _channelCount);
     }
     else if (_baseType == BaseType::HALF)
     {
-        Half* data = static_cast<Half*>(_resourceBuffer) + (y * _width + x) * _channelCount;
-        if (_channelCount == 4)
-        {
-            return Color4(data[0], data[1], data[2], data[3]);
-        }
-        else if (_channelCount == 3)
-        {
-            return Color4(data[0], data[1], data[2], 1.0f);
-        }
-        else if (_channelCount == 2)
+        return readTexel(static_cast<const Half*>(_resourceBuffer) + offset, _channelCount);
+    }
+    else if (_baseType == BaseType::UINT8)
+    {
+        return readTexel(static_cast<const uint8_t*>(_resourceBuffer) + offset, _channelCount);
+    }
+    else
+    {
+        throw Exception("Unsupported base type in getTexelColor");
+    }
+}
+
+ImagePtr Image::convert(BaseType baseType) const
+{
+    if (isCompressed())
+    {
+        ImagePtr image = decompress();
+        return baseType == image->getBaseType() ? image : image->convert(baseType);
+    }
+    if (!_resourceBuffer)
+    {
+        throw Exception("Invalid resource buffer in convert");
+    }
+
+    ImagePtr image = Image::create(_width, _height, _channelCount, baseType);
+    image->createResourceBuffer();
+    if (_baseType != BaseType::FLOAT && _baseType != BaseType::HALF && _baseType != BaseType::UINT8)
+    {
+        throw Exception("Unsupported base type in convert");
+    }
+
+    // Convert rows in parallel.
+    const size_t rowSize = (size_t) _width * _channelCount;
+    const size_t dstRowBytes = rowSize * image->getBaseStride();
+    parallelFor(_height, 16, [&](size_t begin, size_t end)
+    {
+        size_t offset = begin * rowSize;
+        size_t count = (end - begin) * rowSize;
+        void* dst = static_cast<char*>(image->getResourceBuffer()) + begin * dstRowBytes;
+        if (_baseType == BaseType::FLOAT)
         {
-            return Color4(data[0], data[1], 0.0f, 1.0f);
+            convertComponents(static_cast<const float*>(_resourceBuffer) + offset, dst, baseType, count);
         }
-        else if (_channelCount == 1)
+        else if (_baseType == BaseType::HALF)
         {
-            return Color4(data[0], data[0], data[0], 1.0f);
+            convertComponents(static_cast<const Half*>(_resourceBuffer) + offset, dst, baseType, count);
         }
         else
         {
-            throw Exception("Unsupported channel count in getTexelColor");
+            convertComponents(static_cast<const uint8_t*>(_resourceBuffer) + offset, dst, baseType, count);
         }
+    });
+    return image;
+}
+
+ImagePtr Image::compress(CompressionFormat format) const
+{
+    if (isCompressed())
+    {
+        throw Exception("Image is already compressed in compress");
     }
-    else
+    if (format == CompressionFormat::NONE)
     {
-        throw Exception("Unsupported base type in getTexelColor");
+        return convert(_baseType);
+    }
+
+    ImagePtr image(new Image(_width, _height, getCompressedChannelCount(format), BaseType::UINT8, format));
+    image->createResourceBuffer();
+    uint8_t* block = static_cast<uint8_t*>(image->getResourceBuffer());
+    const size_t blockByteCount = getBlockByteCount(format);
+    for (unsigned int by = 0; by < _height; by += BLOCK_DIM)
+    {
+        for (unsigned int bx = 0; bx < _width; bx += BLOCK_DIM)
+        {
+            // Texels beyond the image edges repeat the edge texels.
+            BlockTexels texels;
+            for (unsigned int i = 0; i < BLOCK_TEXELS; i++)
+            {
+                unsigned int x = std::min(bx + i % BLOCK_DIM, _width - 1);
+                unsigned int y = std::min(by + i / BLOCK_DIM, _height - 1);
+                Color4 color = getTexelColor(x, y);
+                for (unsigned int c = 0; c < 3; c++)
+                {
+                    texels[i][c] = quantize(color[c]);
+                }
+            }
+            encodeBlock(format, texels, block);
+            block += blockByteCount;
+        }
     }
+    return image;
 }
 
-ImagePtr Image::applyBoxBlur()
+ImagePtr Image::decompress() const
 {
-    ImagePtr blurImage = Image::create(getWidth(), getHeight(), getChannelCount(), getBaseType());
-    blurImage->createResourceBuffer();
+    if (!isCompressed())
+    {
+        return convert(BaseType::UINT8);
+    }
+    if (!_resourceBuffer)
+    {
+        throw Exception("Invalid resource buffer in decompress");
+    }
 
-    for (int y = 0; y < (int) getHeight(); y++)
+    ImagePtr image = Image::create(_width, _height, _channelCount, BaseType::UINT8);
+    image->createResourceBuffer();
+    uint8_t* data = static_cast<uint8_t*>(image->getResourceBuffer());
+    const uint8_t* block = static_cast<const uint8_t*>(_resourceBuffer);
+    const size_t blockByteCount = getBlockByteCount(_compressionFormat);
+    for (unsigned int by = 0; by < _height; by += BLOCK_DIM)
     {
-        for (int x = 0; x < (int) getWidth(); x++)
+        for (unsigned int bx = 0; bx < _width; bx += BLOCK_DIM)
         {
-            Color4 blurColor;
-            for (int dy = -1; dy <= 1; dy++)
+            BlockTexels texels;
+            decodeBlock(_compressionFormat, block, texels);
+            block += blockByteCount;
+
+            unsigned int blockWidth = std::min(BLOCK_DIM, _width - bx);
+            unsigned int blockHeight = std::min(BLOCK_DIM, _height - by);
+            for (unsigned int y = 0; y < blockHeight; y++)
             {
-                int sy = std::min(std::max(y + dy, 0), (int) getHeight() - 1);
-                for (int dx = -1; dx <= 1; dx++)
+                for (unsigned int x = 0; x < blockWidth; x++)
                 {
-                    int sx = std::min(std::max(x + dx, 0), (int) getWidth() - 1);
-                    blurColor += getTexelColor(sx, sy);
+                    uint8_t* texel = data + ((size_t) (by + y) * _width + bx + x) * _channelCount;
+                    std::copy_n(texels[y * BLOCK_DIM + x], _channelCount, texel);
                 }
             }
-            blurColor /= 9.0f;
-            blurImage->setTexelColor(x, y, blurColor);
         }
     }
+    return image;
+}
 
-    return blurImage;
+ImagePtr Image::applyBoxBlur()
+{
+    const float kernel[3] = { 1.0f / 3.0f, 1.0f / 3.0f, 1.0f / 3.0f };
+    return applySeparableFilter(*this, kernel, 3);
 }
 
 ImagePtr Image::applyGaussianBlur()
 {
-    ImagePtr blurImage1 = Image::create(getWidth(), getHeight(), getChannelCount(), getBaseType());
-    ImagePtr blurImage2 = Image::create(getWidth(), getHeight(), getChannelCount(), getBaseType());
-    blurImage1->createResourceBuffer();
-    blurImage2->createResourceBuffer();
+    return applySeparableFilter(*this, GAUSSIAN_KERNEL_7.data(), (unsigned int) GAUSSIAN_KERNEL_7.size());
+}
 
-    for (int y = 0; y < (int) getHeight(); y++)
+ImagePair Image::splitByLuminance(float luminance)
+{
+    ImagePtr holder;
+    const float* src = getFloatTexels(*this, holder);
+    ImagePtr underflowImage = Image::create(getWidth(), getHeight(), getChannelCount(), BaseType::FLOAT);
+    ImagePtr overflowImage = Image::create(getWidth(), getHeight(), getChannelCount(), BaseType::FLOAT);
+    underflowImage->createResourceBuffer();
+    overflowImage->createResourceBuffer();
+    float* underflow = static_cast<float*>(underflowImage->getResourceBuffer());
+    float* overflow = static_cast<float*>(overflowImage->getResourceBuffer());
+
+    const size_t rowSize = (size_t) _width * _channelCount;
+    parallelFor(_height, 16, [&](size_t begin, size_t end)
     {
-        for (int x = 0; x < (int) getWidth(); x++)
+        for (size_t i = begin * rowSize; i < end * rowSize; i++)
         {
-            Color4 blurColor;
-            unsigned int weightIndex = 0;
-            for (int dy = -3; dy <= 3; dy++, weightIndex++)
-            {
-                int sy = std::min(std::max(y + dy, 0), (int) getHeight() - 1);
-                blurColor += getTexelColor(x, sy) * GAUSSIAN_KERNEL_7[weightIndex];
-            }
-            blurImage1->setTexelColor(x, y, blurColor);
+            underflow[i] = std::min(src[i], luminance);
+            overflow[i] = std::max(src[i] - underflow[i], 0.0f);
         }
-    }
 
-    for (int y = 0; y < (int) getHeight(); y++)
-    {
-        for (int x = 0; x < (int) getWidth(); x++)
+        // The alpha channels of both images are opaque.
+        if (_channelCount >= 4)
         {
-            Color4 blurColor;
-            unsigned int weightIndex = 0;
-            for (int dx = -3; dx <= 3; dx++, weightIndex++)
+            for (size_t i = begin * rowSize + 3; i < end * rowSize; i += _channelCount)
             {
-                int sx = std::min(std::max(x + dx, 0), (int) getWidth() - 1);
-                blurColor += blurImage1->getTexelColor(sx, y) * GAUSSIAN_KERNEL_7[weightIndex];
+                underflow[i] = 1.0f;
+                overflow[i] = 1.0f;
             }
-            blurImage2->setTexelColor(x, y, blurColor);
         }
-    }
+    });
 
-    return blurImage2;
+    if (getBaseType() != BaseType::FLOAT)
+    {
+        underflowImage = underflowImage->convert(getBaseType());
+        overflowImage = overflowImage->convert(getBaseType());
+    }
+    return std::make_pair(underflowImage, overflowImage);
 }
 
-ImagePair Image::splitByLuminance(float luminance)
+void Image::generateMips()
 {
-    ImagePtr underflowImage = Image::create(getWidth(), getHeight(), getChannelCount(), getBaseType());
-    ImagePtr overflowImage = Image::create(getWidth(), getHeight(), getChannelCount(), getBaseType());
-    underflowImage->createResourceBuffer();
-    overflowImage->createResourceBuffer();
+    _mips.clear();
+    if (!_resourceBuffer)
+    {
+        throw Exception("Invalid resource buffer in generateMips");
+    }
+
+    // Filter in floating-point, from a float copy of the base image if needed.
+    ImagePtr level;
+    const float* levelData = static_cast<const float*>(_resourceBuffer);
+    if (_baseType != BaseType::FLOAT || isCompressed())
+    {
+        level = convert(BaseType::FLOAT);
+        levelData = static_cast<const float*>(level->getResourceBuffer());
+    }
 
-    for (unsigned int y = 0; y < getHeight(); y++)
+    unsigned int levelWidth = _width;
+    unsigned int levelHeight = _height;
+    for (unsigned int i = 1; i < getMaxMipCount(); i++)
     {
-        for (unsigned int x = 0; x < getWidth(); x++)
+        unsigned int mipWidth = std::max(levelWidth / 2, 1u);
+        unsigned int mipHeight = std::max(levelHeight / 2, 1u);
+        ImagePtr mip = Image::create(mipWidth, mipHeight, _channelCount, BaseType::FLOAT);
+        mip->createResourceBuffer();
+        downsample(levelData, levelWidth, levelHeight,
+                   static_cast<float*>(mip->getResourceBuffer()), mipWidth, mipHeight,
+                   _channelCount);
+
+        if (isCompressed())
+        {
+            _mips.push_back(mip->compress(_compressionFormat));
+        }
+        else if (_baseType != BaseType::FLOAT)
+        {
+            _mips.push_back(mip->convert(_baseType));
+        }
+        else
         {
-            Color4 envColor = getTexelColor(x, y);
-            Color4 underflowColor(
-                std::min(envColor[0], luminance),
-                std::min(envColor[1], luminance),
-                std::min(envColor[2], luminance), 1.0f);
-            Color4 overflowColor(
-                std::max(envColor[0] - underflowColor[0], 0.0f),
-                std::max(envColor[1] - underflowColor[1], 0.0f),
-                std::max(envColor[2] - underflowColor[2], 0.0f), 1.0f);
-            underflowImage->setTexelColor(x, y, underflowColor);
-            overflowImage->setTexelColor(x, y, overflowColor);
+            _mips.push_back(mip);
         }
+
+        level = mip;
+        levelData = static_cast<const float*>(mip->getResourceBuffer());
+        levelWidth = mipWidth;
+        levelHeight = mipHeight;
     }
+}
 
-    return std::make_pair(underflowImage, overflowImage);
+size_t Image::getBlockOffset(unsigned int x, unsigned int y) const
+{
+    size_t blocksWide = (_width + BLOCK_DIM - 1) / BLOCK_DIM;
+    return ((y / BLOCK_DIM) * blocksWide + x / BLOCK_DIM) * getBlockByteCount(_compressionFormat);
 }
 
 void Image::createResourceBuffer()
 {
     releaseResourceBuffer();
-    _resourceBuffer = malloc(_width * _height * _channelCount * getBaseStride());
+    _resourceBuffer = malloc(getResourceBufferSize());
     _resourceBufferDeallocator = nullptr;
 }
 
@@ -33,6 +33,11 @@ using ImageBufferDeallocator = std::function<void(void*)>;
 
 /// @class Image
 /// Class representing an image in system memory
+///
+/// The resource buffer of an image holds either uncompressed texels, or
+/// 4x4 blocks of texels in one of the supported block compression formats.
+/// For compressed images, the channel count and base type describe the
+/// decoded texels.
 class Image
 {
   public:
@@ -43,6 +48,18 @@ class Image
         FLOAT = 2
     };
 
+    enum class CompressionFormat
+    {
+        /// Uncompressed texels.
+        NONE = 0,
+        /// Three-channel blocks with 4 bits per texel.
+        BC1 = 1,
+        /// One-channel blocks with 4 bits per texel.
+        BC4 = 2,
+        /// Two-channel blocks with 8 bits per texel.
+        BC5 = 3
+    };
+
   public:
     /// Create an empty image with the given properties.
     static ImagePtr create(unsigned int width, unsigned int height, unsigned int channelCount, BaseType baseType = BaseType::UINT8)
@@ -79,12 +96,28 @@ class Image
         return _baseType;
     }
 
+    /// Return the compression format of the image.
+    CompressionFormat getCompressionFormat() const
+    {
+        return _compressionFormat;
+    }
+
+    /// Return true if the image holds block-compressed texels.
+    bool isCompressed() const
+    {
+        return _compressionFormat != CompressionFormat::NONE;
+    }
+
     /// Return the stride of our base type in bytes.
     unsigned int getBaseStride() const;
 
     /// Return the maximum number of mipmaps for this image.
     unsigned int getMaxMipCount() const;
 
+    /// Return the size in bytes of a resource buffer matching the
+    /// properties of this image.
+    size_t getResourceBufferSize() const;
+
     /// Set the resource buffer for this image.
     void setResourceBuffer(void* buffer)
     {
@@ -122,13 +155,50 @@ class Image
     }
 
     /// Set the texel color at the given coordinates.  If the coordinates
-    /// or image resource buffer are invalid, then an exception is thrown.
+    /// or image resource buffer are invalid, or the image is compressed,
+    /// then an exception is thrown.
     void setTexelColor(unsigned int x, unsigned int y, const Color4& color);
 
-    /// Return the texel color at the given coordinates.  If the coordinates
-    /// or image resource buffer are invalid, then an exception is thrown.
+    /// Return the texel color at the given coordinates, decoding its block
+    /// if the image is compressed.  If the coordinates or image resource
+    /// buffer are invalid, then an exception is thrown.
     Color4 getTexelColor(unsigned int x, unsigned int y) const;
 
+    /// Return a copy of this image with the given base type, decompressing
+    /// the image if it is compressed.
+    ImagePtr convert(BaseType baseType) const;
+
+    /// Return a block-compressed copy of this image in the given format.
+    /// Texel values are clamped to the range [0, 1] and quantized to 8 bits
+    /// before encoding, so compression is intended for color and data
+    /// textures rather than HDR images.  If this image is already compressed,
+    /// then an exception is thrown.
+    ImagePtr compress(CompressionFormat format) const;
+
+    /// Return an uncompressed copy of this image, with UINT8 texels and
+    /// the channel count of its compression format.
+    ImagePtr decompress() const;
+
+    /// Generate the full chain of mip levels for this image on the CPU,
+    /// replacing any previously generated levels.  Each level is filtered
+    /// from the level above it with a box filter, with the rows of each
+    /// level filtered in parallel, and is stored with the base type and
+    /// compression format of this image.
+    void generateMips();
+
+    /// Return the generated mip levels of this image, starting with the
+    /// level below the base image and ending with a single texel.
+    const vector<ImagePtr>& getMips() const
+    {
+        return _mips;
+    }
+
+    /// Clear the generated mip levels of this image.
+    void clearMips()
+    {
+        _mips.clear();
+    }
+
     /// Apply a 3x3 box blur to this image, returning a new blurred image.
     ImagePtr applyBoxBlur();
 
@@ -146,17 +216,24 @@ class Image
     void releaseResourceBuffer();
 
   protected:
-    Image(unsigned int width, unsigned int height, unsigned int channelCount, BaseType baseType);
+    Image(unsigned int width, unsigned int height, unsigned int channelCount, BaseType baseType,
+          CompressionFormat compressionFormat = CompressionFormat::NONE);
+
+    // Return the byte offset of the block holding the given texel.
+    size_t getBlockOffset(unsigned int x, unsigned int y) const;
 
   protected:
     unsigned int _width;
     unsigned int _height;
     unsigned int _channelCount;
     BaseType _baseType;
+    CompressionFormat _compressionFormat;
 
     void* _resourceBuffer;
     ImageBufferDeallocator _resourceBufferDeallocator;
     unsigned int _resourceId;
+
+    vector<ImagePtr> _mips;
 };
 
 } // namespace MaterialX
@@ -8,6 +8,11 @@
 #include <MaterialXGenShader/Shader.h>
 #include <MaterialXGenShader/Util.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
 namespace MaterialX
 {
 
@@ -33,16 +38,133 @@ const string ImageLoader::TX_EXTENSION = "tx";
 const string ImageLoader::TXT_EXTENSION = "txt";
 const string ImageLoader::TXR_EXTENSION = "txr";
 
+namespace
+{
+
+// Return the size in bytes of the resource buffers of the given image and
+// of its generated mip levels.
+size_t getImageByteCount(ConstImagePtr image)
+{
+    size_t byteCount = image->getResourceBuffer() ? image->getResourceBufferSize() : 0;
+    for (ConstImagePtr mip : image->getMips())
+    {
+        byteCount += mip->getResourceBuffer() ? mip->getResourceBufferSize() : 0;
+    }
+    return byteCount;
+}
+
+// Generate the mip levels of the given image on the CPU, if the image has
+// a resource buffer and its levels have not been generated, returning true
+// if levels were generated.
+bool generateMissingMips(ImagePtr image)
+{
+    if (!image->getResourceBuffer() || !image->getMips().empty() || image->getMaxMipCount() <= 1)
+    {
+        return false;
+    }
+    image->generateMips();
+    return true;
+}
+
+// Return the image loaded by the given completed prefetch, or an empty
+// shared pointer if loading the image failed or threw an exception.
+ImagePtr getPrefetchedImage(const ImageFuture& future)
+{
+    try
+    {
+        return future.get();
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+} // anonymous namespace
+
+//
+// ImageLoadQueue methods
+//
+
+/// A queue of image loading tasks, run on a fixed set of worker threads.
+class ImageLoadQueue
+{
+  public:
+    ImageLoadQueue(unsigned int threadCount) :
+        _stop(false)
+    {
+        for (unsigned int i = 0; i < threadCount; i++)
+        {
+            _threads.emplace_back([this]() { run(); });
+        }
+    }
+
+    // Complete all queued tasks and join the worker threads.
+    ~ImageLoadQueue()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _condition.notify_all();
+        for (std::thread& thread : _threads)
+        {
+            thread.join();
+        }
+    }
+
+    void push(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tasks.push_back(std::move(task));
+        }
+        _condition.notify_one();
+    }
+
+  private:
+    void run()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _condition.wait(lock, [this]() { return _stop || !_tasks.empty(); });
+                if (_tasks.empty())
+                {
+                    return;
+                }
+                task = std::move(_tasks.front());
+                _tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+  private:
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::deque<std::function<void()>> _tasks;
+    vector<std::thread> _threads;
+    bool _stop;
+};
+
 //
 // ImageHandler methods
 //
 
-ImageHandler::ImageHandler(ImageLoaderPtr imageLoader)
+ImageHandler::ImageHandler(ImageLoaderPtr imageLoader) :
+    _cacheBudget(0)
 {
     addLoader(imageLoader);
     _zeroImage = Image::createConstantColor(1, 1, Color4(0.0f));
 }
 
+ImageHandler::~ImageHandler()
+{
+}
+
 void ImageHandler::addLoader(ImageLoaderPtr loader)
 {
     if (loader)
@@ -92,23 +214,44 @@ bool ImageHandler::saveImage(const FilePath& filePath,
     return false;
 }
 
-ImagePtr ImageHandler::acquireImage(const FilePath& filePath, bool, const Color4* fallbackColor, string* message)
+ImagePtr ImageHandler::acquireImage(const FilePath& filePath, bool generateMipMaps, const Color4* fallbackColor, string* message)
 {
     FilePath foundFilePath =  _searchPath.find(filePath);
-    string extension = foundFilePath.getExtension();
-    ImageLoaderMap::reverse_iterator iter;
-    for (iter = _imageLoaders.rbegin(); iter != _imageLoaders.rend(); ++iter)
+
+    // Return a cached image if available.
+    cachePrefetchedImages();
+    ImagePtr cachedImage = getCachedImage(foundFilePath);
+    if (cachedImage)
     {
-        ImageLoaderPtr loader = iter->second;
-        if (loader && loader->supportedExtensions().count(extension))
+        if (generateMipMaps && generateMissingMips(cachedImage))
         {
-            ImagePtr image = loader->loadImage(foundFilePath);
-            if (image)
-            {
-                cacheImage(foundFilePath, image);
-                return image;
-            }
+            updateCachedImage(cachedImage);
+        }
+        return cachedImage;
+    }
+    _cacheStatistics.misses++;
+
+    // Wait for a pending prefetch of the image, or load it on this thread.
+    ImagePtr image;
+    auto pending = _pendingImages.find(foundFilePath);
+    if (pending != _pendingImages.end())
+    {
+        ImageFuture future = pending->second;
+        _pendingImages.erase(pending);
+        image = future.get();
+    }
+    else
+    {
+        image = loadImage(foundFilePath, _imageLoaders);
+    }
+    if (image)
+    {
+        if (generateMipMaps)
+        {
+            generateMissingMips(image);
         }
+        cacheImage(foundFilePath, image);
+        return image;
     }
 
     if (message && !filePath.isEmpty())
@@ -117,7 +260,7 @@ ImagePtr ImageHandler::acquireImage(const FilePath& filePath, bool, const Color4
     }
     if (fallbackColor)
     {
-        ImagePtr image = Image::createConstantColor(1, 1, *fallbackColor);
+        image = Image::createConstantColor(1, 1, *fallbackColor);
         if (image)
         {
             cacheImage(filePath, image);
@@ -142,7 +285,7 @@ void ImageHandler::unbindImages()
 {
     for (auto iter : _imageCache)
     {
-        unbindImage(iter.second);
+        unbindImage(iter.second.image);
     }
 }
 
@@ -155,38 +298,238 @@ void ImageHandler::releaseRenderResources(ImagePtr)
 {
 }
 
+vector<ImageFuture> ImageHandler::prefetchImages(const FilePathVec& filePaths)
+{
+    cachePrefetchedImages();
+
+    vector<ImageFuture> futures;
+    for (const FilePath& filePath : filePaths)
+    {
+        const string foundFilePath = _searchPath.find(filePath);
+
+        // Return cached images as ready futures.
+        auto cached = _imageCache.find(foundFilePath);
+        if (cached != _imageCache.end())
+        {
+            std::promise<ImagePtr> promise;
+            promise.set_value(cached->second.image);
+            futures.push_back(promise.get_future().share());
+            continue;
+        }
+
+        // Share the loading of images that are already being loaded.
+        auto pending = _pendingImages.find(foundFilePath);
+        if (pending != _pendingImages.end())
+        {
+            futures.push_back(pending->second);
+            continue;
+        }
+
+        if (!_loadQueue)
+        {
+            _loadQueue.reset(new ImageLoadQueue(std::max(std::thread::hardware_concurrency(), 1u)));
+        }
+
+        // Worker threads use their own copy of the loader map, so that
+        // loaders may be added while images are being loaded.
+        const ImageLoaderMap loaders = _imageLoaders;
+        auto task = std::make_shared<std::packaged_task<ImagePtr()>>([foundFilePath, loaders]()
+        {
+            return loadImage(foundFilePath, loaders);
+        });
+        ImageFuture future = task->get_future().share();
+        _pendingImages[foundFilePath] = future;
+        _loadQueue->push([task]() { (*task)(); });
+        futures.push_back(future);
+    }
+    return futures;
+}
+
+void ImageHandler::setCacheBudget(size_t bytes)
+{
+    _cacheBudget = bytes;
+    cachePrefetchedImages();
+    evictImages();
+}
+
+void ImageHandler::setImagePinned(ImagePtr image, bool pinned)
+{
+    if (pinned)
+    {
+        _pinnedImages.insert(image);
+    }
+    else
+    {
+        _pinnedImages.erase(image);
+    }
+}
+
+ImageCacheStatistics ImageHandler::getCacheStatistics() const
+{
+    ImageCacheStatistics statistics = _cacheStatistics;
+    statistics.imageCount = _imageCache.size();
+    for (const auto& pending : _pendingImages)
+    {
+        if (pending.second.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            ImagePtr image = getPrefetchedImage(pending.second);
+            if (image)
+            {
+                statistics.pendingByteCount += getImageByteCount(image);
+            }
+        }
+    }
+    return statistics;
+}
+
+void ImageHandler::resetCacheStatistics()
+{
+    _cacheStatistics.hits = 0;
+    _cacheStatistics.misses = 0;
+    _cacheStatistics.evictions = 0;
+}
+
 void ImageHandler::cacheImage(const string& filePath, ImagePtr image)
 {
-    _imageCache[filePath] = image;
+    auto it = _imageCache.find(filePath);
+    if (it != _imageCache.end())
+    {
+        _cacheStatistics.byteCount -= it->second.byteCount;
+        _imageCacheUsage.erase(it->second.usage);
+        _imageCache.erase(it);
+    }
+
+    const size_t byteCount = getImageByteCount(image);
+    _imageCacheUsage.push_back(filePath);
+    _imageCache[filePath] = { image, byteCount, std::prev(_imageCacheUsage.end()) };
+    _cacheStatistics.byteCount += byteCount;
+
+    evictImages(image);
 }
 
-ImagePtr ImageHandler::getCachedImage(const FilePath& filePath)
+void ImageHandler::updateCachedImage(ImagePtr image)
 {
-    if (_imageCache.count(filePath))
+    for (auto& it : _imageCache)
     {
-        return _imageCache[filePath];
+        if (it.second.image == image)
+        {
+            const size_t byteCount = getImageByteCount(image);
+            _cacheStatistics.byteCount = _cacheStatistics.byteCount - it.second.byteCount + byteCount;
+            it.second.byteCount = byteCount;
+            evictImages(image);
+            return;
+        }
     }
-    if (!filePath.isAbsolute())
+}
+
+ImagePtr ImageHandler::getCachedImage(const FilePath& filePath)
+{
+    auto it = _imageCache.find(filePath);
+    if (it == _imageCache.end() && !filePath.isAbsolute())
     {
         for (const FilePath& path : _searchPath)
         {
-            FilePath combined = path / filePath;
-            if (_imageCache.count(combined))
+            it = _imageCache.find(path / filePath);
+            if (it != _imageCache.end())
             {
-                return _imageCache[combined];
+                break;
             }
         }
     }
-    return nullptr;
+    if (it == _imageCache.end())
+    {
+        return nullptr;
+    }
+
+    // Mark the image as most recently used.
+    _imageCacheUsage.splice(_imageCacheUsage.end(), _imageCacheUsage, it->second.usage);
+    _cacheStatistics.hits++;
+    return it->second.image;
 }
 
 void ImageHandler::clearImageCache()
 {
     for (auto iter : _imageCache)
     {
-        releaseRenderResources(iter.second);
+        releaseRenderResources(iter.second.image);
+    }
+
+    // Unbind images that remain pinned, which derived handlers unpin as
+    // they are unbound, and drop any remaining pins.
+    const vector<ImagePtr> pinnedImages(_pinnedImages.begin(), _pinnedImages.end());
+    for (ImagePtr image : pinnedImages)
+    {
+        unbindImage(image);
     }
+    _pinnedImages.clear();
+
     _imageCache.clear();
+    _imageCacheUsage.clear();
+    _cacheStatistics.byteCount = 0;
+}
+
+ImagePtr ImageHandler::loadImage(const FilePath& filePath, const ImageLoaderMap& loaders)
+{
+    string extension = filePath.getExtension();
+    ImageLoaderMap::const_reverse_iterator iter;
+    for (iter = loaders.rbegin(); iter != loaders.rend(); ++iter)
+    {
+        ImageLoaderPtr loader = iter->second;
+        if (loader && loader->supportedExtensions().count(extension))
+        {
+            ImagePtr image = loader->loadImage(filePath);
+            if (image)
+            {
+                return image;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void ImageHandler::evictImages(ImagePtr keep)
+{
+    auto usage = _imageCacheUsage.begin();
+    while (_cacheBudget && _cacheStatistics.byteCount > _cacheBudget && usage != _imageCacheUsage.end())
+    {
+        auto it = _imageCache.find(*usage);
+        ImagePtr image = it->second.image;
+        if (image == keep || isImagePinned(image))
+        {
+            ++usage;
+            continue;
+        }
+
+        usage = _imageCacheUsage.erase(usage);
+        _cacheStatistics.byteCount -= it->second.byteCount;
+        _cacheStatistics.evictions++;
+        _imageCache.erase(it);
+        releaseRenderResources(image);
+    }
+}
+
+void ImageHandler::cachePrefetchedImages()
+{
+    auto pending = _pendingImages.begin();
+    while (pending != _pendingImages.end())
+    {
+        if (pending->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++pending;
+            continue;
+        }
+
+        // Remove the entry before retrieving the image, so that a failed
+        // load is dropped rather than retried on every call.
+        const string filePath = pending->first;
+        const ImageFuture future = pending->second;
+        pending = _pendingImages.erase(pending);
+        ImagePtr image = getPrefetchedImage(future);
+        if (image)
+        {
+            cacheImage(filePath, image);
+        }
+    }
 }
 
 //
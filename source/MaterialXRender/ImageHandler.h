@@ -15,7 +15,10 @@
 
 #include <MaterialXCore/Element.h>
 
+#include <future>
+#include <list>
 #include <map>
+#include <unordered_set>
 
 namespace MaterialX
 {
@@ -28,6 +31,7 @@ extern const string DEFAULT_COLOR_SUFFIX;
 
 class ImageHandler;
 class ImageLoader;
+class ImageLoadQueue;
 class VariableBlock;
 
 /// Shared pointer to an ImageHandler
@@ -39,6 +43,9 @@ using ImageLoaderPtr = std::shared_ptr<ImageLoader>;
 /// Map from strings to image loaders
 using ImageLoaderMap = std::multimap<string, ImageLoaderPtr>;
 
+/// A shared future for an image being loaded
+using ImageFuture = std::shared_future<ImagePtr>;
+
 /// @class ImageSamplingProperties
 /// Interface to describe sampling properties for images.
 class ImageSamplingProperties
@@ -85,6 +92,26 @@ class ImageSamplingProperties
     Color4 defaultColor = { 0.0f, 0.0f, 0.0f, 1.0f };
 };
 
+/// @struct ImageCacheStatistics
+/// Usage statistics for the image cache of an ImageHandler.
+struct ImageCacheStatistics
+{
+    /// Number of image requests served from the cache.
+    size_t hits = 0;
+    /// Number of image requests that required the image to be loaded.
+    size_t misses = 0;
+    /// Number of images evicted from the cache to meet its budget.
+    size_t evictions = 0;
+    /// Number of images in the cache.
+    size_t imageCount = 0;
+    /// Total size in bytes of the resource buffers of images in the cache,
+    /// including their generated mip levels.
+    size_t byteCount = 0;
+    /// Total size in bytes of the resource buffers of prefetched images
+    /// that have finished loading but have not yet been moved to the cache.
+    size_t pendingByteCount = 0;
+};
+
 /// @class ImageLoader
 /// Abstract base class for file-system image loaders
 class ImageLoader
@@ -128,7 +155,8 @@ class ImageLoader
                            ConstImagePtr image,
                            bool verticalFlip = false) = 0;
 
-    /// Load an image from the file system. This method must be implemented by derived classes.
+    /// Load an image from the file system. This method must be implemented by derived classes,
+    /// and may be called concurrently from the worker threads of an image handler.
     /// @param filePath The requested image file path.
     /// @return On success, a shared pointer to the loaded image; otherwise an empty shared pointer.
     virtual ImagePtr loadImage(const FilePath& filePath) = 0;
@@ -150,7 +178,7 @@ class ImageHandler
     {
         return ImageHandlerPtr(new ImageHandler(imageLoader));
     }
-    virtual ~ImageHandler() { }
+    virtual ~ImageHandler();
 
     /// Add another image loader to the handler, which will be invoked if
     /// existing loaders cannot load a given image.
@@ -170,9 +198,13 @@ class ImageHandler
                            bool verticalFlip = false);
 
     /// Acquire an image from the cache or file system.  If the image is not
-    /// found in the cache, then each image loader will be applied in turn.
+    /// found in the cache, then each image loader will be applied in turn,
+    /// unless the image is being prefetched, in which case the prefetch
+    /// is awaited.
     /// @param filePath File path of the image.
-    /// @param generateMipMaps Generate mip maps if supported.
+    /// @param generateMipMaps If true, the mip levels of the image are
+    ///    generated on the CPU if they have not already been generated,
+    ///    and are counted against the cache budget.
     /// @param fallbackColor Optional uniform color of a fallback texture
     ///    to create when the image cannot be loaded from the file system.
     ///    By default, no fallback texture is created.
@@ -220,7 +252,9 @@ class ImageHandler
         return _resolver;
     }
 
-    /// Create rendering resources for the given image.
+    /// Create rendering resources for the given image.  If mip maps are
+    /// requested, then derived handlers generate the mip levels of the
+    /// image on the CPU if they have not already been generated.
     virtual bool createRenderResources(ImagePtr image, bool generateMipMaps);
 
     /// Release rendering resources for the given image.
@@ -232,24 +266,118 @@ class ImageHandler
         return _zeroImage;
     }
 
+    /// @name Image Cache
+    /// @{
+
+    /// Set the budget in bytes for the resource buffers of images in the
+    /// cache, including their generated mip levels, where zero denotes an
+    /// unlimited budget.  When the budget is
+    /// exceeded, the least recently acquired images that are not pinned are
+    /// evicted from the cache, releasing their render resources.  The
+    /// resource buffer of an evicted image is freed when no other
+    /// references to the image are held.  Defaults to zero.
+    void setCacheBudget(size_t bytes);
+
+    /// Return the budget in bytes for images in the cache.
+    size_t getCacheBudget() const
+    {
+        return _cacheBudget;
+    }
+
+    /// Pin or unpin the given image.  Pinned images are never evicted from
+    /// the cache, and derived handlers pin images while they are bound.
+    void setImagePinned(ImagePtr image, bool pinned);
+
+    /// Return true if the given image is pinned.
+    bool isImagePinned(ImagePtr image) const
+    {
+        return _pinnedImages.count(image) > 0;
+    }
+
+    /// Return usage statistics for the image cache.
+    ImageCacheStatistics getCacheStatistics() const;
+
+    /// Reset the hit, miss and eviction counts of the image cache.
+    void resetCacheStatistics();
+
+    /// @}
+    /// @name Asynchronous Loading
+    /// @{
+
+    /// Start loading the given images on worker threads, returning a future
+    /// for each image.  File paths are resolved in the same way as in
+    /// acquireImage, and images that are already cached or being loaded
+    /// are not loaded again.  Prefetched images that have finished loading
+    /// are moved to the cache, subject to its budget, on the next call to
+    /// acquireImage, prefetchImages or setCacheBudget, and images that
+    /// failed to load are dropped.  Acquiring an image that is still being
+    /// loaded waits only for the loading of that image.
+    ///
+    /// Only the loading of images runs on worker threads: the handler
+    /// itself is not thread-safe, and all of its methods must be called
+    /// from a single thread.
+    virtual vector<ImageFuture> prefetchImages(const FilePathVec& filePaths);
+
+    /// Return the number of prefetched images that have not yet been moved
+    /// to the cache.
+    size_t getPendingImageCount() const
+    {
+        return _pendingImages.size();
+    }
+
+    /// @}
+
   protected:
     // Protected constructor.
     ImageHandler(ImageLoaderPtr imageLoader);
 
-    // Add an image to the cache.
+    // Add an image to the cache, evicting images as needed to meet the
+    // cache budget.
     void cacheImage(const string& filePath, ImagePtr image);
 
+    // Update the byte count of the given image in the cache, if it is
+    // cached, after its mip levels have been generated, evicting images as
+    // needed to meet the cache budget.
+    void updateCachedImage(ImagePtr image);
+
     // Return the cached image, if found; otherwise return an empty
-    // shared pointer.
+    // shared pointer.  A cached image is marked as most recently used.
     ImagePtr getCachedImage(const FilePath& filePath);
 
     /// Clear the contents of the image cache, first releasing any
-    /// render resources associated with each image.
+    /// render resources associated with each image, and unbinding and
+    /// unpinning all pinned images.
     void clearImageCache();
 
+    // Evict least recently used images until the cache meets its budget,
+    // keeping pinned images and the given image.
+    void evictImages(ImagePtr keep = nullptr);
+
+    // Move prefetched images that have finished loading to the cache,
+    // dropping those that failed to load.
+    void cachePrefetchedImages();
+
+    // Load an image with the first of the given loaders that succeeds,
+    // returning an empty shared pointer if no loader succeeds.
+    static ImagePtr loadImage(const FilePath& filePath, const ImageLoaderMap& loaders);
+
+  protected:
+    struct CacheEntry
+    {
+        ImagePtr image;
+        size_t byteCount;
+        std::list<string>::iterator usage;
+    };
+
   protected:
     ImageLoaderMap _imageLoaders;
-    ImageMap _imageCache;
+    std::unordered_map<string, CacheEntry> _imageCache;
+    std::list<string> _imageCacheUsage;
+    std::unordered_set<ImagePtr> _pinnedImages;
+    size_t _cacheBudget;
+    ImageCacheStatistics _cacheStatistics;
+    std::unordered_map<string, ImageFuture> _pendingImages;
+    std::unique_ptr<ImageLoadQueue> _loadQueue;
     FileSearchPath _searchPath;
     StringResolverPtr _resolver;
     ImagePtr _zeroImage;
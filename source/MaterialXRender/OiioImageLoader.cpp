@@ -24,6 +24,11 @@ bool OiioImageLoader::saveImage(const FilePath& filePath,
                                 ConstImagePtr image,
                                 bool verticalFlip)
 {
+    if (image->isCompressed())
+    {
+        image = image->decompress();
+    }
+
     OIIO::ImageSpec imageSpec;
     imageSpec.width = image->getWidth();
     imageSpec.height = image->getHeight();
@@ -31,6 +31,17 @@ bool StbImageLoader::saveImage(const FilePath& filePath,
                                ConstImagePtr image,
                                bool verticalFlip)
 {
+    // Save compressed and half-float images through their nearest
+    // supported uncompressed format.
+    if (image->isCompressed())
+    {
+        image = image->decompress();
+    }
+    else if (image->getBaseType() == Image::BaseType::HALF)
+    {
+        image = image->convert(Image::BaseType::FLOAT);
+    }
+
     bool isChar = image->getBaseType() == Image::BaseType::UINT8;
     bool isFloat = image->getBaseType() == Image::BaseType::FLOAT;
     if (!isChar && !isFloat)
@@ -56,7 +67,7 @@ bool StbImageLoader::saveImage(const FilePath& filePath,
     {
         if (extension == PNG_EXTENSION)
         {
-            returnValue = stbi_write_png(filePathName.c_str(), w, h, channels, data, w * 4);
+            returnValue = stbi_write_png(filePathName.c_str(), w, h, channels, data, w * channels);
         }
         else if (extension == BMP_EXTENSION)
         {
@@ -115,6 +126,12 @@ ImagePtr StbImageLoader::loadImage(const FilePath& filePath)
     ImagePtr image = Image::create(width, height, channelCount, baseType);
     image->setResourceBuffer(buffer);
     image->setResourceBufferDeallocator(&stbi_image_free);
+
+    // Convert HDR images to the requested base type.
+    if (baseType != _hdrBaseType && baseType == Image::BaseType::FLOAT)
+    {
+        image = image->convert(_hdrBaseType);
+    }
     return image;
 }
 
@@ -22,7 +22,8 @@ using StbImageLoaderPtr = std::shared_ptr<class StbImageLoader>;
 class StbImageLoader : public ImageLoader
 {
   public:
-    StbImageLoader()
+    StbImageLoader() :
+        _hdrBaseType(Image::BaseType::FLOAT)
     {
         // Set all extensions supported by stb image
         _extensions.insert(BMP_EXTENSION);
@@ -47,6 +48,23 @@ class StbImageLoader : public ImageLoader
 
     /// Load an image from the file system.
     ImagePtr loadImage(const FilePath& filePath) override;
+
+    /// Set the base type in which HDR images are stored, which may be
+    /// FLOAT or HALF.  Storing HDR images as HALF halves their memory
+    /// footprint.  Defaults to FLOAT.
+    void setHdrBaseType(Image::BaseType baseType)
+    {
+        _hdrBaseType = baseType;
+    }
+
+    /// Return the base type in which HDR images are stored.
+    Image::BaseType getHdrBaseType() const
+    {
+        return _hdrBaseType;
+    }
+
+  protected:
+    Image::BaseType _hdrBaseType;
 };
 
 } // namespace MaterialX
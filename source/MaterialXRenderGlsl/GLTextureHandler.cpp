@@ -39,15 +39,21 @@ ImagePtr GLTextureHandler::acquireImage(const FilePath& filePath,
         resolvedFilePath = _resolver->resolve(resolvedFilePath, FILENAME_TYPE_STRING);
     }
 
-    // Return a cached image if available.
-    ImagePtr cachedDesc = getCachedImage(resolvedFilePath);
-    if (cachedDesc)
+    // Call the base acquire method, which returns a cached image if available.
+    return ImageHandler::acquireImage(resolvedFilePath, generateMipMaps, fallbackColor, message);
+}
+
+vector<ImageFuture> GLTextureHandler::prefetchImages(const FilePathVec& filePaths)
+{
+    // Resolve the input filepaths.
+    FilePathVec resolvedFilePaths;
+    for (const FilePath& filePath : filePaths)
     {
-        return cachedDesc;
+        resolvedFilePaths.push_back(_resolver ? FilePath(_resolver->resolve(filePath, FILENAME_TYPE_STRING)) : filePath);
     }
 
-    // Call the base acquire method.
-    return ImageHandler::acquireImage(resolvedFilePath, generateMipMaps, fallbackColor, message);
+    // Call the base prefetch method.
+    return ImageHandler::prefetchImages(resolvedFilePaths);
 }
 
 bool GLTextureHandler::bindImage(ImagePtr image, const ImageSamplingProperties& samplingProperties)
@@ -84,6 +90,9 @@ bool GLTextureHandler::bindImage(ImagePtr image, const ImageSamplingProperties&
     }      
     _boundTextureLocations[textureUnit] = image->getResourceId();
 
+    // Bound images are kept in the cache until they are unbound.
+    setImagePinned(image, true);
+
     glActiveTexture(GL_TEXTURE0 + textureUnit);
     glBindTexture(GL_TEXTURE_2D, image->getResourceId());
 
@@ -113,6 +122,7 @@ bool GLTextureHandler::unbindImage(ImagePtr image)
             glActiveTexture(GL_TEXTURE0 + textureUnit);
             glBindTexture(GL_TEXTURE_2D, GlslProgram::UNDEFINED_OPENGL_RESOURCE_ID);
             _boundTextureLocations[textureUnit] = GlslProgram::UNDEFINED_OPENGL_RESOURCE_ID;
+            setImagePinned(image, false);
             return true;
         }
     }
@@ -138,16 +148,37 @@ bool GLTextureHandler::createRenderResources(ImagePtr image, bool generateMipMap
     glActiveTexture(GL_TEXTURE0 + textureUnit);
     glBindTexture(GL_TEXTURE_2D, image->getResourceId());
 
-    int glType, glFormat, glInternalFormat;
-    mapTextureFormatToGL(image->getBaseType(), image->getChannelCount(), false,
-        glType, glFormat, glInternalFormat);
-    glTexImage2D(GL_TEXTURE_2D, 0, glInternalFormat, image->getWidth(), image->getHeight(),
-        0, glFormat, glType, image->getResourceBuffer());
+    // Generate mip levels on the CPU if requested, which also supports
+    // compressed images, and count them against the cache budget.
+    if (generateMipMaps && image->getResourceBuffer() && image->getMips().empty() && image->getMaxMipCount() > 1)
+    {
+        image->generateMips();
+        updateCachedImage(image);
+    }
 
-    if (generateMipMaps)
+    // Upload the base level, followed by any mip levels generated on the CPU.
+    vector<ImagePtr> levels = { image };
+    levels.insert(levels.end(), image->getMips().begin(), image->getMips().end());
+    for (size_t i = 0; i < levels.size(); i++)
     {
-        glGenerateMipmap(GL_TEXTURE_2D);
+        ImagePtr level = levels[i];
+        if (level->isCompressed())
+        {
+            int glInternalFormat = mapCompressionFormatToGL(level->getCompressionFormat());
+            glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), glInternalFormat, level->getWidth(), level->getHeight(),
+                0, static_cast<GLsizei>(level->getResourceBufferSize()), level->getResourceBuffer());
+        }
+        else
+        {
+            int glType, glFormat, glInternalFormat;
+            mapTextureFormatToGL(level->getBaseType(), level->getChannelCount(), false,
+                glType, glFormat, glInternalFormat);
+            glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), glInternalFormat, level->getWidth(), level->getHeight(),
+                0, glFormat, glType, level->getResourceBuffer());
+        }
     }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels.size() - 1));
     glBindTexture(GL_TEXTURE_2D, 0);
 
     return true;
@@ -280,4 +311,15 @@ void GLTextureHandler::mapTextureFormatToGL(Image::BaseType baseType, unsigned i
     }
 }
 
+int GLTextureHandler::mapCompressionFormatToGL(Image::CompressionFormat compressionFormat)
+{
+    switch (compressionFormat)
+    {
+        case Image::CompressionFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case Image::CompressionFormat::BC4: return GL_COMPRESSED_RED_RGTC1;
+        case Image::CompressionFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+        default: throw Exception("Unsupported compression format in mapCompressionFormatToGL");
+    }
+}
+
 } // namespace MaterialX
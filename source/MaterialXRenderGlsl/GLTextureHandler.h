@@ -34,12 +34,17 @@ class GLTextureHandler : public ImageHandler
                           const Color4* fallbackColor = nullptr,
                           string* message = nullptr) override;
 
+    /// Start loading the given images on worker threads, resolving
+    /// their file paths with the filename resolver of the handler.
+    vector<ImageFuture> prefetchImages(const FilePathVec& filePaths) override;
+
     /// Bind an image. This method will bind the texture to an active texture
     /// unit as defined by the corresponding image description. The method
     /// will fail if there are not enough available image units to bind to.
     bool bindImage(ImagePtr image, const ImageSamplingProperties& samplingProperties) override;
 
-    /// Unbind an image. 
+    /// Unbind an image. Bound images are pinned in the image cache
+    /// until they are unbound.
     bool unbindImage(ImagePtr image) override;
 
     /// Create rendering resources for the given image.
@@ -60,6 +65,9 @@ class GLTextureHandler : public ImageHandler
     static void mapTextureFormatToGL(Image::BaseType baseType, unsigned int channelCount, bool srgb,
                                      int& glType, int& glFormat, int& glInternalFormat);
 
+    /// Utility to map a compression format to an OpenGL compressed internal format
+    static int mapCompressionFormatToGL(Image::CompressionFormat compressionFormat);
+
   protected:
     // Protected constructor
     GLTextureHandler(ImageLoaderPtr imageLoader);
@@ -578,9 +578,10 @@ void GlslProgram::bindTextures(ImageHandlerPtr imageHandler)
         throw ExceptionShaderRenderError(errorType, errors);
     }
 
-    // Bind textures based on uniforms found in the program
+    // Find textures based on uniforms found in the program
     const GlslProgram::InputMap& uniformList = getUniformsList();
     VariableBlock& publicUniforms = _shader->getStage(Stage::PIXEL).getUniformBlock(HW::PUBLIC_UNIFORMS);
+    vector<std::pair<const GlslProgram::InputMap::value_type*, string>> textures;
     for (const auto& uniform : uniformList)
     {
         GLenum uniformType = uniform.second->gltype;
@@ -596,13 +597,26 @@ void GlslProgram::bindTextures(ImageHandlerPtr imageHandler)
                 fileName != HW::ENV_RADIANCE &&
                 fileName != HW::ENV_IRRADIANCE)
             {
-                ImageSamplingProperties samplingProperties;
-                samplingProperties.setProperties(uniform.first, publicUniforms);
-
-                bindTexture(uniformType, uniformLocation, fileName, imageHandler, true, samplingProperties);
+                textures.emplace_back(&uniform, fileName);
             }
         }
     }
+
+    // Load all textures in parallel, then bind them in turn.
+    FilePathVec filePaths;
+    for (const auto& texture : textures)
+    {
+        filePaths.push_back(texture.second);
+    }
+    imageHandler->prefetchImages(filePaths);
+    for (const auto& texture : textures)
+    {
+        const auto& uniform = *texture.first;
+        ImageSamplingProperties samplingProperties;
+        samplingProperties.setProperties(uniform.first, publicUniforms);
+
+        bindTexture(uniform.second->gltype, uniform.second->location, texture.second, imageHandler, true, samplingProperties);
+    }
     checkErrors();
 }
 
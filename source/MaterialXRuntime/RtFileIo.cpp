@@ -74,14 +74,14 @@ namespace
     {
         // Read in all metadata so we can export the element again
         // without loosing data.
-        for (const string& name : src->getAttributeNames())
+        for (const Element::Attribute& attr : src->getAttributes())
         {
-            const RtToken mdName(name);
+            const RtToken mdName(attr.getName());
             if (!ignoreList.count(mdName))
             {
                 // Store all custom attributes as string tokens.
                 RtTypedValue* md = dest->addMetadata(mdName, RtType::TOKEN);
-                md->getValue().asToken() = src->getAttribute(name);
+                md->getValue().asToken() = attr.getValue();
             }
         }
     }
@@ -0,0 +1,84 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <MaterialXTest/Catch/catch.hpp>
+
+#include <MaterialXFormat/BinaryIo.h>
+#include <MaterialXFormat/XmlIo.h>
+
+#include <MaterialXGenShader/Util.h>
+
+#include <cstdio>
+#include <sstream>
+
+namespace mx = MaterialX;
+
+TEST_CASE("Binary round trip", "[binaryio]")
+{
+    mx::FilePath librariesPath = mx::FilePath::getCurrentPath() / mx::FilePath("libraries");
+    mx::FilePath examplesPath("resources/Materials/Examples/Syntax");
+    mx::FileSearchPath searchPath = librariesPath.asString() +
+        mx::PATH_LIST_SEPARATOR +
+        examplesPath.asString();
+
+    // Read the data libraries and an example document through the XML path.
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "stdlib", "pbrlib", "bxdf" }, librariesPath, doc);
+    mx::XmlReadOptions readOptions;
+    readOptions.skipConflictingElements = true;
+    mx::readFromXmlFile(doc, "NodeGraphs.mtlx", searchPath, &readOptions);
+    REQUIRE(doc->validate());
+
+    // Verify that the binary representation reproduces the document.
+    std::ostringstream stream;
+    mx::writeToBinaryStream(doc, stream);
+    std::string buffer = stream.str();
+    mx::DocumentPtr binaryDoc = mx::createDocument();
+    mx::readFromBinaryBuffer(binaryDoc, buffer.data(), buffer.size());
+    REQUIRE(*binaryDoc == *doc);
+    REQUIRE(binaryDoc->validate());
+
+    // Verify that source URIs are preserved, so that XML output is unchanged.
+    REQUIRE(binaryDoc->getNodeDef("ND_image_color3")->getSourceUri() ==
+            doc->getNodeDef("ND_image_color3")->getSourceUri());
+    binaryDoc->setSourceUri(doc->getSourceUri());
+    REQUIRE(mx::writeToXmlString(binaryDoc) == mx::writeToXmlString(doc));
+
+    // Round trip through a memory-mapped file.
+    mx::FilePath filename = mx::FilePath::getTempPath() / mx::FilePath("NodeGraphs." + mx::MTLX_BINARY_EXTENSION);
+    mx::writeToBinaryFile(doc, filename);
+    mx::DocumentPtr fileDoc = mx::createDocument();
+    mx::readFromBinaryFile(fileDoc, filename);
+    REQUIRE(*fileDoc == *doc);
+
+    // Read the same file twice, skipping duplicate elements.
+    mx::CopyOptions copyOptions;
+    copyOptions.skipConflictingElements = true;
+    mx::readFromBinaryFile(fileDoc, filename, mx::FileSearchPath(), &copyOptions);
+    REQUIRE(*fileDoc == *doc);
+
+    // Read a document with conflicting elements, which leaves the document
+    // unmodified.
+    mx::DocumentPtr conflictDoc = mx::createDocument();
+    mx::NodeGraphPtr conflictGraph = conflictDoc->addNodeGraph("NG_conflict");
+    conflictDoc->addNodeDef("ND_image_color3", "color3", "image")->setDocString("Conflict");
+    const std::string conflictXml = mx::writeToXmlString(conflictDoc);
+    REQUIRE_THROWS_AS(mx::readFromBinaryFile(conflictDoc, filename), mx::Exception&);
+    REQUIRE(mx::writeToXmlString(conflictDoc) == conflictXml);
+    REQUIRE(conflictDoc->getChildren().size() == 2);
+    REQUIRE(!conflictDoc->hasSourceUri());
+    std::remove(filename.asString().c_str());
+
+    // Write to an invalid path.
+    mx::FilePath invalidFilename = mx::FilePath::getTempPath() / mx::FilePath("missing_directory") / filename.getBaseName();
+    REQUIRE_THROWS_AS(mx::writeToBinaryFile(doc, invalidFilename), mx::ExceptionFileMissing&);
+
+    // Read invalid and missing data.
+    mx::DocumentPtr invalidDoc = mx::createDocument();
+    REQUIRE_THROWS_AS(mx::readFromBinaryBuffer(invalidDoc, buffer.data(), buffer.size() / 2), mx::ExceptionParseError&);
+    std::string xmlString = mx::writeToXmlString(doc);
+    REQUIRE_THROWS_AS(mx::readFromBinaryBuffer(invalidDoc, xmlString.data(), xmlString.size()), mx::ExceptionParseError&);
+    REQUIRE_THROWS_AS(mx::readFromBinaryFile(invalidDoc, "NonExistent.mtlxb"), mx::ExceptionFileMissing&);
+}
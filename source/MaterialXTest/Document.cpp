@@ -6,10 +6,14 @@
 #include <MaterialXTest/Catch/catch.hpp>
 
 #include <MaterialXCore/Document.h>
+#include <MaterialXCore/Observer.h>
 #include <MaterialXFormat/File.h>
 #include <MaterialXFormat/XmlIo.h>
 #include <MaterialXGenShader/Util.h>
 
+#include <chrono>
+#include <fstream>
+
 namespace mx = MaterialX;
 
 TEST_CASE("Document", "[document]")
@@ -158,3 +162,260 @@ TEST_CASE("Version", "[document]")
         REQUIRE((convertItem.second == 0));
     }
 }
+
+TEST_CASE("Document cache", "[document]")
+{
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::FilePath searchPath = mx::FilePath::getCurrentPath() / mx::FilePath("libraries");
+    mx::loadLibraries({ "stdlib", "pbrlib" }, searchPath, doc);
+    const size_t addNodeDefCount = doc->getMatchingNodeDefs("add").size();
+    REQUIRE(addNodeDefCount > 0);
+
+    // Add, edit and remove a nodedef, checking lookups after each edit.
+    mx::NodeDefPtr nodeDef = doc->addNodeDef("ND_custom_float", "float", "custom");
+    REQUIRE(doc->getMatchingNodeDefs("custom").size() == 1);
+    nodeDef->setNodeString("custom2");
+    REQUIRE(doc->getMatchingNodeDefs("custom").empty());
+    REQUIRE(doc->getMatchingNodeDefs("custom2").size() == 1);
+    nodeDef->setNamespace("ns");
+    REQUIRE(doc->getMatchingNodeDefs("custom2").empty());
+    REQUIRE(doc->getMatchingNodeDefs("ns:custom2").size() == 1);
+    mx::ImplementationPtr impl = doc->addImplementation("IM_custom_float");
+    impl->setNodeDef(nodeDef);
+    REQUIRE(doc->getMatchingImplementations("ND_custom_float").size() == 1);
+    REQUIRE(nodeDef->getImplementation() == impl);
+    doc->removeImplementation(impl->getName());
+    REQUIRE(doc->getMatchingImplementations("ND_custom_float").empty());
+    doc->removeNodeDef(nodeDef->getName());
+    REQUIRE(doc->getMatchingNodeDefs("ns:custom2").empty());
+
+    // Connect and disconnect ports within a node graph.
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph();
+    mx::NodePtr constant = nodeGraph->addNode("constant", "constant1", "float");
+    mx::NodePtr add = nodeGraph->addNode("add", "add1", "float");
+    mx::InputPtr input = add->addInput("in1", "float");
+    input->setConnectedNode(constant);
+    REQUIRE(constant->getNodeDef());
+    REQUIRE(doc->getMatchingPorts("constant1").size() == 1);
+    constant->setName("constant2");
+    input->setNodeName("constant2");
+    REQUIRE(doc->getMatchingPorts("constant1").empty());
+    REQUIRE(doc->getMatchingPorts("constant2").size() == 1);
+    nodeGraph->removeNode(add->getName());
+    REQUIRE(doc->getMatchingPorts("constant2").empty());
+
+    // Clear a copy of the node graph and verify that its entries are removed.
+    mx::NodeGraphPtr copiedGraph = doc->addNodeGraph();
+    copiedGraph->copyContentFrom(nodeGraph);
+    copiedGraph->getNode("constant2")->addInput("in", "float")->setNodeName("other");
+    REQUIRE(doc->getMatchingPorts("other").size() == 1);
+    copiedGraph->clearContent();
+    REQUIRE(doc->getMatchingPorts("other").empty());
+    REQUIRE(doc->getMatchingNodeDefs("add").size() == addNodeDefCount);
+    REQUIRE(doc->validate());
+}
+
+TEST_CASE("Document cache benchmark", "[document]")
+{
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::FilePath searchPath = mx::FilePath::getCurrentPath() / mx::FilePath("libraries");
+    mx::loadLibraries({ "stdlib", "pbrlib" }, searchPath, doc);
+
+    std::ofstream benchmarkLog;
+    benchmarkLog.open("document_cache_benchmark.txt");
+
+    // Interleave edits and nodedef lookups, as an interactive editor would.
+    // Each lookup only updates the cache entries of the edited elements,
+    // where the full rebuild path clears the whole cache after each edit.
+    for (bool fullRebuild : { false, true })
+    {
+        mx::NodeGraphPtr nodeGraph = doc->addNodeGraph();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 500; i++)
+        {
+            mx::NodePtr node = nodeGraph->addNode("multiply", "", "color3");
+            node->setInputValue("in2", mx::Color3(0.5f));
+            if (fullRebuild)
+            {
+                doc->onClearContent(doc);
+            }
+            REQUIRE(node->getNodeDef() == doc->getNodeDef("ND_multiply_color3"));
+            if (i % 2)
+            {
+                nodeGraph->removeNode(node->getName());
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        benchmarkLog << (fullRebuild ? "Full rebuild: " : "Incremental update: ") << seconds << "s" << std::endl;
+        REQUIRE(nodeGraph->getNodes().size() == 250);
+        doc->removeNodeGraph(nodeGraph->getName());
+    }
+}
+
+TEST_CASE("Data library", "[document]")
+{
+    mx::DocumentPtr library = mx::createDocument();
+    mx::FilePath searchPath = mx::FilePath::getCurrentPath() / mx::FilePath("libraries");
+    mx::loadLibraries({ "stdlib", "pbrlib" }, searchPath, library);
+    const size_t libraryChildCount = library->getChildren().size();
+
+    // Share the library between two documents without copying its content.
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::DocumentPtr doc2 = mx::createDocument();
+    doc->setDataLibrary(library);
+    doc2->setDataLibrary(library);
+    REQUIRE(doc->hasDataLibrary());
+
+    // Data libraries may not form cycles.
+    REQUIRE_THROWS_AS(doc->setDataLibrary(doc), mx::Exception&);
+    REQUIRE_THROWS_AS(library->setDataLibrary(doc), mx::Exception&);
+    REQUIRE(doc->getDataLibrary() == library);
+    REQUIRE(!library->hasDataLibrary());
+    REQUIRE(doc->getChildren().empty());
+    REQUIRE(doc->getNodeDefs().size() == library->getNodeDefs().size());
+    REQUIRE(doc->getImplementations().size() == library->getImplementations().size());
+    REQUIRE(doc->getTypeDefs().size() == library->getTypeDefs().size());
+    REQUIRE(doc->getNodeDef("ND_image_color3") == library->getNodeDef("ND_image_color3"));
+    REQUIRE(doc2->getNodeDef("ND_image_color3") == library->getNodeDef("ND_image_color3"));
+
+    // Resolve nodedefs and implementations through the data library.
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph();
+    mx::NodePtr image = nodeGraph->addNode("image", "image1", "color3");
+    mx::NodePtr multiply = nodeGraph->addNode("multiply", "multiply1", "color3");
+    multiply->setConnectedNode("in1", image);
+    mx::OutputPtr output = nodeGraph->addOutput("out", "color3");
+    output->setConnectedNode(multiply);
+    mx::NodeDefPtr imageNodeDef = image->getNodeDef();
+    REQUIRE(imageNodeDef == library->getNodeDef("ND_image_color3"));
+    REQUIRE(imageNodeDef->getImplementation());
+    REQUIRE(multiply->getNodeDef());
+    mx::NodePtr explicitNode = nodeGraph->addNode("add", "add1", "color3");
+    explicitNode->setNodeDefString("ND_add_color3");
+    REQUIRE(explicitNode->getNodeDef() == library->getNodeDef("ND_add_color3"));
+    REQUIRE(doc->validate());
+
+    // Localize a nodedef for editing, leaving the shared library unmodified.
+    mx::ElementPtr localElem = doc->localizeElement("ND_image_color3");
+    mx::NodeDefPtr localNodeDef = localElem->asA<mx::NodeDef>();
+    REQUIRE(localNodeDef);
+    REQUIRE(localNodeDef != imageNodeDef);
+    REQUIRE(*localNodeDef == *imageNodeDef);
+    REQUIRE(doc->localizeElement("ND_image_color3") == localElem);
+    localNodeDef->setDocString("Local image");
+    REQUIRE(doc->getNodeDef("ND_image_color3") == localNodeDef);
+    REQUIRE(image->getNodeDef() == localNodeDef);
+    REQUIRE(imageNodeDef->getDocString().empty());
+    REQUIRE(doc2->getNodeDef("ND_image_color3") == imageNodeDef);
+    REQUIRE(doc->getNodeDefs().size() == library->getNodeDefs().size());
+    REQUIRE(doc->getMatchingNodeDefs("image").size() == library->getMatchingNodeDefs("image").size());
+    REQUIRE(!doc->localizeElement("ND_missing"));
+    REQUIRE(library->getChildren().size() == libraryChildCount);
+    REQUIRE(doc->validate());
+
+    // Verify that copies preserve the data library.
+    mx::DocumentPtr docCopy = doc->copy();
+    REQUIRE(docCopy->getDataLibrary() == library);
+    REQUIRE(*docCopy == *doc);
+    mx::ObservedDocumentPtr observedDoc = mx::Document::createDocument<mx::ObservedDocument>();
+    observedDoc->setDataLibrary(library);
+    REQUIRE(observedDoc->copy()->getDataLibrary() == library);
+
+    // Verify that a shared library may not be modified in place.
+    REQUIRE(library->isSharedDataLibrary());
+    REQUIRE_THROWS_AS(imageNodeDef->setDocString("Shared image"), mx::Exception&);
+    REQUIRE_THROWS_AS(library->addNodeDef("ND_new", "color3", "new"), mx::Exception&);
+    REQUIRE(imageNodeDef->getDocString().empty());
+    REQUIRE(library->getChildren().size() == libraryChildCount);
+
+    // Release all references to the library, allowing it to be edited again.
+    doc->setDataLibrary(nullptr);
+    doc2->setDataLibrary(nullptr);
+    docCopy = nullptr;
+    observedDoc = nullptr;
+    REQUIRE(!library->isSharedDataLibrary());
+    imageNodeDef->setDocString("Shared image");
+    REQUIRE(imageNodeDef->getDocString() == "Shared image");
+}
+
+TEST_CASE("Document arena", "[document]")
+{
+    mx::FilePath searchPath = mx::FilePath::getCurrentPath() / mx::FilePath("libraries");
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "stdlib", "pbrlib" }, searchPath, doc);
+    REQUIRE(!doc->getElementArena());
+
+    // Load the same content into an arena-backed document.
+    mx::DocumentPtr arenaDoc = mx::createDocument(true);
+    mx::ElementArenaPtr arena = arenaDoc->getElementArena();
+    REQUIRE(arena);
+    mx::loadLibraries({ "stdlib", "pbrlib" }, searchPath, arenaDoc);
+    REQUIRE(*arenaDoc == *doc);
+    REQUIRE(arenaDoc->validate());
+    REQUIRE(arena->getAllocatedSize() > 0);
+
+    // Copies of an arena-backed document receive their own arena.
+    mx::DocumentPtr arenaCopy = arenaDoc->copy();
+    REQUIRE(arenaCopy->getElementArena());
+    REQUIRE(arenaCopy->getElementArena() != arena);
+    REQUIRE(*arenaCopy == *arenaDoc);
+
+    // The memory of removed elements is reused by new elements.
+    size_t allocatedSize = arena->getAllocatedSize();
+    size_t reservedSize = arena->getReservedSize();
+    REQUIRE(allocatedSize <= reservedSize);
+    for (int i = 0; i < 100; i++)
+    {
+        mx::NodeGraphPtr nodeGraph = arenaDoc->addNodeGraph("NG_arena");
+        nodeGraph->copyContentFrom(arenaDoc->getNodeGraph("NG_tiledimage_color3"));
+        arenaDoc->removeNodeGraph(nodeGraph->getName());
+    }
+    REQUIRE(arena->getAllocatedSize() == allocatedSize);
+    REQUIRE(arena->getReservedSize() == reservedSize);
+
+    // Elements remain valid after their document is released.
+    mx::NodeDefPtr nodeDef = arenaDoc->getNodeDef("ND_image_color3");
+    REQUIRE(nodeDef);
+    arenaDoc->removeNodeDef(nodeDef->getName());
+    REQUIRE(arena->getAllocatedSize() == allocatedSize);
+    arenaDoc = nullptr;
+    REQUIRE(nodeDef->getName() == "ND_image_color3");
+    REQUIRE_THROWS_AS(nodeDef->getDocument(), mx::ExceptionOrphanedElement&);
+}
+
+TEST_CASE("Parallel validation", "[document]")
+{
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::FilePath searchPath = mx::FilePath::getCurrentPath() / mx::FilePath("libraries");
+    mx::loadLibraries({ "stdlib", "pbrlib" }, searchPath, doc);
+
+    // Parallel validation of a valid document.
+    std::string serialMessage, parallelMessage;
+    REQUIRE(doc->validate(&serialMessage));
+    REQUIRE(doc->validate(&parallelMessage, 4));
+    REQUIRE(parallelMessage == serialMessage);
+    REQUIRE(doc->validate(nullptr, 0));
+
+    // Introduce errors in elements spread across the document.
+    for (int i = 0; i < 16; i++)
+    {
+        mx::NodeGraphPtr nodeGraph = doc->addNodeGraph();
+        mx::NodePtr node = nodeGraph->addNode("constant");
+        node->removeAttribute(mx::TypedElement::TYPE_ATTRIBUTE);
+        if (i % 4 == 0)
+        {
+            nodeGraph->setInheritString("missing_graph");
+        }
+    }
+    doc->removeAttribute(mx::Element::VERSION_ATTRIBUTE);
+
+    // Messages from parallel validation are merged in document order.
+    serialMessage.clear();
+    REQUIRE(!doc->validate(&serialMessage));
+    REQUIRE(!serialMessage.empty());
+    for (unsigned int threadCount : { 1u, 2u, 3u, 8u })
+    {
+        parallelMessage.clear();
+        REQUIRE(!doc->validate(&parallelMessage, threadCount));
+        REQUIRE(parallelMessage == serialMessage);
+    }
+}
@@ -7,8 +7,84 @@
 
 #include <MaterialXCore/Document.h>
 
+#include <MaterialXGenShader/Util.h>
+
+#include <fstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
 namespace mx = MaterialX;
 
+namespace
+{
+
+// The number of bytes currently held by containers using CountingAllocator.
+size_t countedBytes = 0;
+
+// An allocator that tracks the heap usage of the containers that use it.
+template <class T> struct CountingAllocator
+{
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template <class U> CountingAllocator(const CountingAllocator<U>&) { }
+
+    T* allocate(size_t n)
+    {
+        countedBytes += n * sizeof(T);
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n)
+    {
+        countedBytes -= n * sizeof(T);
+        ::operator delete(ptr);
+    }
+};
+
+template <class T, class U> bool operator==(const CountingAllocator<T>&, const CountingAllocator<U>&)
+{
+    return true;
+}
+
+template <class T, class U> bool operator!=(const CountingAllocator<T>&, const CountingAllocator<U>&)
+{
+    return false;
+}
+
+using CountedString = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+struct CountedStringHash
+{
+    size_t operator()(const CountedString& str) const
+    {
+        size_t hash = 0;
+        for (char c : str)
+        {
+            hash = hash * 31 + (size_t) c;
+        }
+        return hash;
+    }
+};
+
+template <class T> using CountedVector = std::vector<T, CountingAllocator<T>>;
+
+// Attribute storage with a map of names to values and a separate vector of
+// names to preserve their order, each holding its own copy of every name.
+struct MappedAttributes
+{
+    std::unordered_map<CountedString, CountedString, CountedStringHash, std::equal_to<CountedString>,
+                       CountingAllocator<std::pair<const CountedString, CountedString>>> values;
+    CountedVector<CountedString> order;
+};
+
+// Attribute storage with a single ordered vector of values, whose names
+// point into a shared table of interned names.
+using InternedAttributes = CountedVector<std::pair<const CountedString*, CountedString>>;
+
+} // anonymous namespace
+
 TEST_CASE("Element", "[element]")
 {
     // Create a document.
@@ -66,3 +142,197 @@ TEST_CASE("Element", "[element]")
     }
     REQUIRE_THROWS_AS(orphan->getDocument(), mx::ExceptionOrphanedElement&);    
 }
+
+TEST_CASE("Content hash", "[element]")
+{
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph("graph");
+    mx::NodePtr constant = nodeGraph->addNode("constant", "node1", "color3");
+    constant->setInputValue("value", mx::Color3(0.5f));
+    mx::OutputPtr output = nodeGraph->addOutput("out", "color3");
+    output->setConnectedNode(constant);
+
+    // Equal documents have equal hashes.
+    mx::DocumentPtr doc2 = doc->copy();
+    REQUIRE(*doc2 == *doc);
+    REQUIRE(doc2->getContentHash() == doc->getContentHash());
+
+    // Modifying a descendant invalidates the hashes of its ancestors.
+    uint64_t docHash = doc2->getContentHash();
+    uint64_t graphHash = doc2->getNodeGraph("graph")->getContentHash();
+    uint64_t outputHash = doc2->getDescendant("graph/out")->getContentHash();
+    mx::InputPtr input = doc2->getDescendant("graph/node1")->asA<mx::Node>()->getInput("value");
+    input->setValue(mx::Color3(0.25f));
+    REQUIRE(doc2->getContentHash() != docHash);
+    REQUIRE(doc2->getNodeGraph("graph")->getContentHash() != graphHash);
+    REQUIRE(doc2->getDescendant("graph/out")->getContentHash() == outputHash);
+    REQUIRE(*doc2 != *doc);
+    input->setValue(mx::Color3(0.5f));
+    REQUIRE(doc2->getContentHash() == docHash);
+    REQUIRE(*doc2 == *doc);
+
+    // Attribute order, child order, names and categories contribute to the hash.
+    input->setAttribute("uiname", "Value");
+    uint64_t attrHash = doc2->getContentHash();
+    input->removeAttribute("uiname");
+    REQUIRE(doc2->getContentHash() == docHash);
+    input->setAttribute("uiname", "Value");
+    REQUIRE(doc2->getContentHash() == attrHash);
+    input->removeAttribute("uiname");
+    mx::NodeGraphPtr graph2 = doc2->getNodeGraph("graph");
+    graph2->setChildIndex("out", 0);
+    REQUIRE(doc2->getContentHash() != docHash);
+    graph2->setChildIndex("node1", 0);
+    REQUIRE(doc2->getContentHash() == docHash);
+    graph2->getNode("node1")->setName("node2");
+    REQUIRE(doc2->getContentHash() != docHash);
+    graph2->getNode("node2")->setName("node1");
+    graph2->getNode("node1")->setCategory("dot");
+    REQUIRE(doc2->getContentHash() != docHash);
+    graph2->getNode("node1")->setCategory("constant");
+    REQUIRE(doc2->getContentHash() == docHash);
+
+    // Adding, removing and clearing elements invalidates hashes.
+    graph2->addNode("constant", "node3", "color3");
+    REQUIRE(doc2->getContentHash() != docHash);
+    graph2->removeNode("node3");
+    REQUIRE(doc2->getContentHash() == docHash);
+    graph2->clearContent();
+    REQUIRE(doc2->getContentHash() != docHash);
+    graph2->copyContentFrom(doc->getNodeGraph("graph"));
+    REQUIRE(doc2->getContentHash() == docHash);
+    REQUIRE(*doc2 == *doc);
+}
+
+TEST_CASE("Attributes", "[element]")
+{
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::ElementPtr elem1 = doc->addChildOfCategory("generic", "elem1");
+    mx::ElementPtr elem2 = doc->addChildOfCategory("generic", "elem2");
+
+    // Attribute names are returned in the order they were set.
+    elem1->setAttribute("attr1", "value1");
+    elem1->setAttribute("attr2", "value2");
+    elem1->setAttribute("attr3", "value3");
+    elem1->setAttribute("attr1", "value4");
+    REQUIRE(elem1->getAttributeNames() == mx::StringVec({ "attr1", "attr2", "attr3" }));
+    REQUIRE(elem1->getAttribute("attr1") == "value4");
+    REQUIRE(elem1->getAttribute("attr4").empty());
+    REQUIRE(elem1->hasAttribute("attr2"));
+    REQUIRE(!elem1->hasAttribute("attr4"));
+    elem1->removeAttribute("attr2");
+    REQUIRE(elem1->getAttributeNames() == mx::StringVec({ "attr1", "attr3" }));
+    REQUIRE(!elem1->hasAttribute("attr2"));
+
+    // Stored attributes give access to names and values in order.
+    const std::vector<mx::Element::Attribute>& attributes = elem1->getAttributes();
+    REQUIRE(attributes.size() == 2);
+    REQUIRE(attributes[0].getName() == "attr1");
+    REQUIRE(attributes[0].getValue() == "value4");
+    REQUIRE(attributes[1].getName() == "attr3");
+    REQUIRE(attributes[1].getValue() == "value3");
+
+    // Shared attribute names are independent across elements.
+    elem2->setAttribute("attr3", "value3");
+    elem2->setAttribute("attr1", "value4");
+    REQUIRE(elem2->getAttribute("attr3") == elem1->getAttribute("attr3"));
+    elem2->setAttribute("attr3", "value5");
+    REQUIRE(elem1->getAttribute("attr3") == "value3");
+
+    // Attribute order contributes to equality.
+    mx::DocumentPtr doc2 = mx::createDocument();
+    mx::ElementPtr elem3 = doc2->addChildOfCategory("generic", "elem1");
+    elem3->setAttribute("attr3", "value3");
+    elem3->setAttribute("attr1", "value4");
+    REQUIRE(*elem3 != *elem1);
+    elem3->removeAttribute("attr3");
+    elem3->setAttribute("attr3", "value3");
+    REQUIRE(*elem3 == *elem1);
+}
+
+TEST_CASE("Attribute memory benchmark", "[element]")
+{
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::FilePath searchPath = mx::FilePath::getCurrentPath() / mx::FilePath("libraries");
+    mx::loadLibraries({ "stdlib", "pbrlib", "bxdf" }, searchPath, doc);
+
+    // Measure the heap usage of the attributes of the loaded libraries, for
+    // separately stored names and for names shared through an interned table.
+    std::vector<mx::ElementPtr> elements;
+    for (mx::ElementPtr elem : doc->traverseTree())
+    {
+        elements.push_back(elem);
+    }
+    size_t attributeCount = 0;
+    size_t mappedBytes = 0;
+    size_t internedBytes = 0;
+    {
+        CountedVector<MappedAttributes> mapped;
+        mapped.reserve(elements.size());
+        size_t startBytes = countedBytes;
+        for (mx::ElementPtr elem : elements)
+        {
+            mapped.emplace_back();
+            for (const std::string& name : elem->getAttributeNames())
+            {
+                CountedString countedName(name.c_str());
+                mapped.back().values[countedName] = elem->getAttribute(name).c_str();
+                mapped.back().order.push_back(countedName);
+                attributeCount++;
+            }
+        }
+        mappedBytes = countedBytes - startBytes;
+    }
+    {
+        std::unordered_set<CountedString, CountedStringHash, std::equal_to<CountedString>,
+                           CountingAllocator<CountedString>> internedNames;
+        CountedVector<InternedAttributes> interned;
+        interned.reserve(elements.size());
+        size_t startBytes = countedBytes;
+        for (mx::ElementPtr elem : elements)
+        {
+            interned.emplace_back();
+            for (const std::string& name : elem->getAttributeNames())
+            {
+                const CountedString* internedName = &*internedNames.insert(name.c_str()).first;
+                interned.back().emplace_back(internedName, elem->getAttribute(name).c_str());
+            }
+        }
+        internedBytes = countedBytes - startBytes;
+    }
+    REQUIRE(internedBytes < mappedBytes);
+
+    std::ofstream benchmarkLog;
+    benchmarkLog.open("attribute_memory_benchmark.txt");
+    benchmarkLog << "Elements: " << elements.size() << std::endl;
+    benchmarkLog << "Attributes: " << attributeCount << std::endl;
+    benchmarkLog << "Mapped attribute storage: " << mappedBytes << " bytes" << std::endl;
+    benchmarkLog << "Interned attribute storage: " << internedBytes << " bytes" << std::endl;
+    benchmarkLog << "Reduction: " << 100.0 * (1.0 - (double) internedBytes / (double) mappedBytes) << "%" << std::endl;
+
+    // Verify that attributes set concurrently on separate documents are
+    // interned consistently.
+    std::vector<mx::DocumentPtr> docs(4);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < docs.size(); i++)
+    {
+        docs[i] = mx::createDocument();
+        threads.emplace_back([&docs, i]()
+        {
+            for (int j = 0; j < 100; j++)
+            {
+                mx::ElementPtr elem = docs[i]->addChildOfCategory("generic", "elem" + std::to_string(j));
+                elem->setAttribute("type", "float");
+                elem->setAttribute("custom" + std::to_string(j), "value");
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    for (size_t i = 1; i < docs.size(); i++)
+    {
+        REQUIRE(*docs[i] == *docs[0]);
+    }
+}
@@ -44,6 +44,9 @@ TEST_CASE("File system operations", "[file]")
         REQUIRE(path.exists());
         REQUIRE(mx::FileSearchPath().find(path).exists());
     }
+
+    REQUIRE(mx::FilePath::getCurrentPath().isDirectory());
+    REQUIRE(mx::FilePath::getTempPath().isDirectory());
 }
 
 TEST_CASE("File search path operations", "[file]")
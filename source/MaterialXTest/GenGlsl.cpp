@@ -9,13 +9,25 @@
 #include <MaterialXTest/GenShaderUtil.h>
 
 #include <MaterialXCore/Document.h>
+#include <MaterialXCore/Observer.h>
 
 #include <MaterialXFormat/File.h>
 
+#include <MaterialXGenShader/GenProfiler.h>
+#include <MaterialXGenShader/Shader.h>
+#include <MaterialXGenShader/ShaderCache.h>
+#include <MaterialXGenShader/ShaderChangeObserver.h>
+#include <MaterialXGenShader/SourceCodeCache.h>
+#include <MaterialXGenShader/UnitSystem.h>
 #include <MaterialXGenShader/Util.h>
 #include <MaterialXGenGlsl/GlslShaderGenerator.h>
 #include <MaterialXGenGlsl/GlslSyntax.h>
 
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
 namespace mx = MaterialX;
 
 TEST_CASE("GenShader: GLSL Syntax Check", "[genglsl]")
@@ -118,6 +130,37 @@ TEST_CASE("GenShader: Bind Light Shaders", "[genglsl]")
     REQUIRE_NOTHROW(mx::HwShaderGenerator::bindLightShader(*pointLightShader, 66, context));
     mx::HwShaderGenerator::unbindLightShaders(context);
     REQUIRE_NOTHROW(mx::HwShaderGenerator::bindLightShader(*spotLightShader, 66, context));
+
+    // Inputs of light shaders implemented by graphs are renamed to light
+    // struct members, without renaming the inputs of cached implementations.
+    mx::NodeDefPtr graphLightShader = doc->addNodeDef("ND_graph_light", "lightshader", "graph_light");
+    graphLightShader->addInput("color", "color3");
+    mx::NodeGraphPtr lightGraph = doc->addNodeGraph("NG_graph_light");
+    lightGraph->setNodeDef(graphLightShader);
+    mx::NodePtr pointLight = lightGraph->addNode("point_light", "point", "lightshader");
+    pointLight->addInput("color", "color3")->setInterfaceName("color");
+    lightGraph->addOutput("out", "lightshader")->setConnectedNode(pointLight);
+
+    mx::ShaderNodeImplCachePtr implCache = mx::ShaderNodeImplCache::create();
+    context.setNodeImplementationCache(implCache);
+    mx::ShaderNodeImplPtr cachedImpl = context.getShaderGenerator().getImplementation(*lightGraph, context);
+    const std::string colorVariable = cachedImpl->getGraph()->getInputSocket("color")->getVariable();
+    for (unsigned int lightTypeId : { 1, 2 })
+    {
+        mx::HwShaderGenerator::bindLightShader(*graphLightShader, lightTypeId, context);
+        mx::HwLightShadersPtr lightShaders = context.getUserData<mx::HwLightShaders>(mx::HW::USER_DATA_LIGHT_SHADERS);
+        const mx::ShaderNode* boundShader = lightShaders->get(lightTypeId);
+        REQUIRE(boundShader->getImplementation().getGraph()->getInputSocket("color")->getVariable() == "light." + colorVariable);
+    }
+    REQUIRE(implCache->find("NG_graph_light", context) == cachedImpl);
+    REQUIRE(cachedImpl->getGraph()->getInputSocket("color")->getVariable() == colorVariable);
+
+    // Generators with a different unit system do not share the cached
+    // implementation.
+    context.getShaderGenerator().setUnitSystem(mx::UnitSystem::create(mx::GlslShaderGenerator::LANGUAGE));
+    REQUIRE(!implCache->find("NG_graph_light", context));
+    context.getShaderGenerator().setUnitSystem(nullptr);
+    REQUIRE(implCache->find("NG_graph_light", context) == cachedImpl);
 }
 
 static void generateGlslCode()
@@ -144,3 +187,628 @@ TEST_CASE("GenShader: GLSL Shader Generation", "[genglsl]")
 {
     generateGlslCode();
 }
+
+// Generate pixel shaders for the given elements from multiple threads, each
+// thread using its own shader generator and context.  The error message of
+// each element that fails to generate is returned in place of its shader.
+static mx::StringVec generateGlslFromThreads(const std::vector<mx::TypedElementPtr>& elements,
+                                             unsigned int threadCount,
+                                             mx::ShaderNodeImplCachePtr implCache,
+                                             const mx::GenOptions& options = mx::GenOptions())
+{
+    const mx::FilePath libSearchPath = mx::FilePath::getCurrentPath() / mx::FilePath("libraries");
+    mx::StringVec results(elements.size());
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            mx::GenContext context(mx::GlslShaderGenerator::create());
+            context.registerSourceCodeSearchPath(libSearchPath);
+            context.setNodeImplementationCache(implCache);
+            context.getOptions() = options;
+            for (size_t i = t; i < elements.size(); i += threadCount)
+            {
+                try
+                {
+                    mx::ShaderPtr shader = context.getShaderGenerator().generate(elements[i]->getName(), elements[i], context);
+                    results[i] = shader->getSourceCode(mx::Stage::PIXEL);
+                }
+                catch (mx::Exception& e)
+                {
+                    results[i] = "Error: " + std::string(e.what());
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    return results;
+}
+
+// Load the documents of the stdlib test suite, returning their renderable elements.
+static std::vector<mx::TypedElementPtr> getStdlibTestElements(std::vector<mx::DocumentPtr>& documents)
+{
+    const mx::FilePath libSearchPath = mx::FilePath::getCurrentPath() / mx::FilePath("libraries");
+    mx::DocumentPtr libDoc = mx::createDocument();
+    mx::loadLibraries({ "stdlib", "pbrlib", "bxdf" }, libSearchPath, libDoc);
+
+    mx::StringVec documentPaths, errors;
+    mx::loadDocuments(mx::FilePath::getCurrentPath() / mx::FilePath("resources/Materials/TestSuite/stdlib"),
+                      mx::FileSearchPath(libSearchPath), {}, {}, documents, documentPaths, mx::XmlReadOptions(), errors);
+
+    std::vector<mx::TypedElementPtr> elements;
+    for (mx::DocumentPtr doc : documents)
+    {
+        doc->importLibrary(libDoc);
+        mx::findRenderableElements(doc, elements);
+    }
+    return elements;
+}
+
+TEST_CASE("GenShader: GLSL Shared Implementation Cache", "[genglsl]")
+{
+    std::vector<mx::DocumentPtr> documents;
+    std::vector<mx::TypedElementPtr> elements = getStdlibTestElements(documents);
+    REQUIRE(!elements.empty());
+    elements.resize(std::min(elements.size(), (size_t) 40));
+
+    // Shaders generated with a shared cache match those generated with
+    // private contexts.
+    mx::StringVec privateResults = generateGlslFromThreads(elements, 1, nullptr);
+    mx::ShaderNodeImplCachePtr implCache = mx::ShaderNodeImplCache::create();
+    mx::StringVec sharedResults = generateGlslFromThreads(elements, 4, implCache);
+    REQUIRE(implCache->size() > 0);
+    REQUIRE(sharedResults == privateResults);
+
+    for (const std::string& result : sharedResults)
+    {
+        REQUIRE(result.find("Error: ") != 0);
+    }
+
+    // A warm cache produces the same results.
+    size_t cacheSize = implCache->size();
+    REQUIRE(generateGlslFromThreads(elements, 2, implCache) == privateResults);
+    REQUIRE(implCache->size() == cacheSize);
+
+    // Contexts with different generation options receive their own
+    // implementations from the cache.
+    mx::GenOptions flipOptions;
+    flipOptions.fileTextureVerticalFlip = true;
+    mx::StringVec flipResults = generateGlslFromThreads(elements, 4, implCache, flipOptions);
+    REQUIRE(implCache->size() > cacheSize);
+    REQUIRE(flipResults == generateGlslFromThreads(elements, 1, nullptr, flipOptions));
+    REQUIRE(flipResults != privateResults);
+}
+
+TEST_CASE("GenShader: GLSL Batch Generation", "[genglsl]")
+{
+    std::vector<mx::DocumentPtr> documents;
+    std::vector<mx::TypedElementPtr> elements = getStdlibTestElements(documents);
+    REQUIRE(!elements.empty());
+
+    mx::GenContext context(mx::GlslShaderGenerator::create());
+    context.registerSourceCodeSearchPath(mx::FilePath::getCurrentPath() / mx::FilePath("libraries"));
+    context.getOptions().fileTextureVerticalFlip = true;
+
+    // Shaders are returned in element order, and match those generated serially.
+    std::vector<mx::ShaderPtr> shaders = mx::generateBatch(elements, context, 4);
+    REQUIRE(shaders.size() == elements.size());
+    for (size_t i = 0; i < elements.size(); i++)
+    {
+        mx::ShaderPtr shader = context.getShaderGenerator().generate(elements[i]->getName(), elements[i], context);
+        REQUIRE(shaders[i]->getName() == shader->getName());
+        REQUIRE(shaders[i]->getSourceCode(mx::Stage::VERTEX) == shader->getSourceCode(mx::Stage::VERTEX));
+        REQUIRE(shaders[i]->getSourceCode(mx::Stage::PIXEL) == shader->getSourceCode(mx::Stage::PIXEL));
+    }
+
+    // Results are independent of the number of threads.
+    std::vector<mx::ShaderPtr> serialShaders = mx::generateBatch(elements, context, 1);
+    for (size_t i = 0; i < elements.size(); i++)
+    {
+        REQUIRE(serialShaders[i]->getSourceCode(mx::Stage::PIXEL) == shaders[i]->getSourceCode(mx::Stage::PIXEL));
+    }
+
+    // Errors are reported for failing elements, without affecting the
+    // shaders of other elements.
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::OutputPtr output = doc->addOutput("out", "float");
+    output->setConnectedNode(doc->addNode("unknown_node", "node1", "float"));
+    elements.insert(elements.begin(), output);
+    mx::StringVec errors;
+    std::vector<mx::ShaderPtr> partialShaders = mx::generateBatch(elements, context, 4, &errors);
+    REQUIRE(partialShaders.size() == elements.size());
+    REQUIRE(errors.size() == elements.size());
+    REQUIRE(!partialShaders[0]);
+    REQUIRE(!errors[0].empty());
+    for (size_t i = 1; i < elements.size(); i++)
+    {
+        REQUIRE(errors[i].empty());
+        REQUIRE(partialShaders[i]->getSourceCode(mx::Stage::PIXEL) == shaders[i - 1]->getSourceCode(mx::Stage::PIXEL));
+    }
+}
+
+TEST_CASE("GenShader: GLSL Shader Cache", "[genglsl]")
+{
+    const mx::FilePath libSearchPath = mx::FilePath::getCurrentPath() / mx::FilePath("libraries");
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "stdlib" }, libSearchPath, doc);
+
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph("shadercache_graph");
+    mx::NodePtr noise = nodeGraph->addNode("noise2d", "noise1", "color3");
+    mx::NodePtr multiply = nodeGraph->addNode("multiply", "multiply1", "color3");
+    multiply->setConnectedNode("in1", noise);
+    multiply->setInputValue("in2", mx::Color3(0.25f, 0.5f, 0.75f));
+    mx::OutputPtr output = nodeGraph->addOutput("out", "color3");
+    output->setConnectedNode(multiply);
+
+    mx::GenContext context(mx::GlslShaderGenerator::create());
+    context.registerSourceCodeSearchPath(libSearchPath);
+
+    const mx::FilePath cachePath = mx::FilePath::getTempPath() / mx::FilePath("materialx_shadercache_test");
+    mx::ShaderCachePtr cache = mx::ShaderCache::create(cachePath);
+    cache->clear();
+
+    // The first request generates the shader, and the second restores it
+    // from the cache without constructing a shader graph.
+    const std::string key = cache->computeKey("shadercache", output, context);
+    REQUIRE(!cache->read(key, context));
+    mx::ShaderPtr generated = cache->generate("shadercache", output, context);
+    REQUIRE(!generated->getGraph().getNodes().empty());
+    mx::ShaderPtr cached = cache->generate("shadercache", output, context);
+    REQUIRE(cached->getGraph().getNodes().empty());
+
+    REQUIRE(cached->getName() == generated->getName());
+    REQUIRE(cached->numStages() == generated->numStages());
+    for (size_t i = 0; i < generated->numStages(); i++)
+    {
+        const mx::ShaderStage& generatedStage = generated->getStage(i);
+        const mx::ShaderStage& cachedStage = cached->getStage(i);
+        REQUIRE(cachedStage.getName() == generatedStage.getName());
+        REQUIRE(cachedStage.getFunctionName() == generatedStage.getFunctionName());
+        REQUIRE(cachedStage.getSourceCode() == generatedStage.getSourceCode());
+        REQUIRE(cachedStage.getUniformBlocks().size() == generatedStage.getUniformBlocks().size());
+        for (const auto& it : generatedStage.getUniformBlocks())
+        {
+            const mx::VariableBlock& generatedBlock = *it.second;
+            const mx::VariableBlock& cachedBlock = cachedStage.getUniformBlock(it.first);
+            REQUIRE(cachedBlock.getInstance() == generatedBlock.getInstance());
+            REQUIRE(cachedBlock.size() == generatedBlock.size());
+            for (size_t j = 0; j < generatedBlock.size(); j++)
+            {
+                REQUIRE(cachedBlock[j]->getType() == generatedBlock[j]->getType());
+                REQUIRE(cachedBlock[j]->getVariable() == generatedBlock[j]->getVariable());
+                REQUIRE(cachedBlock[j]->getPath() == generatedBlock[j]->getPath());
+                REQUIRE(!cachedBlock[j]->getValue() == !generatedBlock[j]->getValue());
+                if (generatedBlock[j]->getValue())
+                {
+                    REQUIRE(cachedBlock[j]->getValue()->getValueString() == generatedBlock[j]->getValue()->getValueString());
+                }
+            }
+        }
+        REQUIRE(cachedStage.getInputBlocks().size() == generatedStage.getInputBlocks().size());
+        REQUIRE(cachedStage.getOutputBlocks().size() == generatedStage.getOutputBlocks().size());
+    }
+
+    // Truncated or corrupt entries are ignored.
+    const mx::FilePath entryPath = cachePath / mx::FilePath(key + "." + mx::ShaderCache::FILE_EXTENSION);
+    std::string entryHeader;
+    std::getline(std::ifstream(entryPath.asString(), std::ios::binary), entryHeader);
+    std::ofstream(entryPath.asString(), std::ios::binary) << entryHeader << "\n1000000000000 " << key;
+    REQUIRE(!cache->read(key, context));
+    std::ofstream(entryPath.asString(), std::ios::binary) << entryHeader << "\n";
+    REQUIRE(!cache->read(key, context));
+
+    // Shaders are returned even when they cannot be written to the cache.
+    const mx::FilePath blockingFile = mx::FilePath::getTempPath() / mx::FilePath("materialx_shadercache_blocked");
+    std::ofstream(blockingFile.asString()) << "blocked";
+    mx::ShaderCachePtr blockedCache = mx::ShaderCache::create(blockingFile / mx::FilePath("cache"));
+    REQUIRE(blockedCache->generate("shadercache", output, context));
+    std::remove(blockingFile.asString().c_str());
+
+    // Changes to the unit converters of the generator change the key.  The
+    // converter registry is shared with other tests, so its distance
+    // converter is restored afterwards.
+    mx::UnitConverterRegistryPtr unitRegistry = mx::UnitConverterRegistry::create();
+    mx::UnitTypeDefPtr distanceTypeDef = doc->getUnitTypeDef("distance");
+    mx::UnitConverterPtr distanceConverter = unitRegistry->getUnitConverter(distanceTypeDef);
+    unitRegistry->removeUnitConverter(distanceTypeDef);
+    mx::UnitSystemPtr unitSystem = mx::UnitSystem::create(mx::GlslShaderGenerator::LANGUAGE);
+    unitSystem->setUnitConverterRegistry(unitRegistry);
+    context.getShaderGenerator().setUnitSystem(unitSystem);
+    const std::string unitKey = cache->computeKey("shadercache", output, context);
+    REQUIRE(unitKey != key);
+    unitRegistry->addUnitConverter(distanceTypeDef, mx::LinearUnitConverter::create(distanceTypeDef));
+    REQUIRE(cache->computeKey("shadercache", output, context) != unitKey);
+    unitRegistry->removeUnitConverter(distanceTypeDef);
+    if (distanceConverter)
+    {
+        unitRegistry->addUnitConverter(distanceTypeDef, distanceConverter);
+    }
+    context.getShaderGenerator().setUnitSystem(nullptr);
+    REQUIRE(cache->computeKey("shadercache", output, context) == key);
+
+    // Changes to the element graph or the generation options change the key.
+    multiply->setInputValue("in2", mx::Color3(1.0f, 0.5f, 0.75f));
+    const std::string editedKey = cache->computeKey("shadercache", output, context);
+    REQUIRE(editedKey != key);
+    context.getOptions().fileTextureVerticalFlip = true;
+    REQUIRE(cache->computeKey("shadercache", output, context) != editedKey);
+    context.getOptions().fileTextureVerticalFlip = false;
+    REQUIRE(cache->computeKey("shadercache", output, context) == editedKey);
+
+    // Changes to definitions, geometric properties and root attributes of
+    // the document change the key.
+    std::string previousKey = editedKey;
+    doc->getNodeDef("ND_multiply_color3")->setDocString("Edited");
+    std::string currentKey = cache->computeKey("shadercache", output, context);
+    REQUIRE(currentKey != previousKey);
+    previousKey = currentKey;
+    doc->addGeomPropDef("shadercache_geomprop", "texcoord")->setIndex("1");
+    currentKey = cache->computeKey("shadercache", output, context);
+    REQUIRE(currentKey != previousKey);
+    previousKey = currentKey;
+    doc->setColorSpace("lin_rec709");
+    currentKey = cache->computeKey("shadercache", output, context);
+    REQUIRE(currentKey != previousKey);
+    previousKey = currentKey;
+
+    // Changes to the source files of implementations in the graph change
+    // the key.
+    const mx::FilePath sourceFile = mx::FilePath::getTempPath() / mx::FilePath("materialx_shadercache_test.glsl");
+    std::ofstream(sourceFile.asString()) << "void mx_shadercache_test(vec3 in, out vec3 result) { result = in; }\n";
+    mx::NodeDefPtr nodeDef = doc->addNodeDef("ND_shadercache_test", "color3", "shadercache_test");
+    nodeDef->addInput("in", "color3");
+    mx::ImplementationPtr impl = doc->addImplementation("IM_shadercache_test_genglsl");
+    impl->setNodeDef(nodeDef);
+    impl->setFile(sourceFile.asString());
+    impl->setFunction("mx_shadercache_test");
+    impl->setLanguage(mx::GlslShaderGenerator::LANGUAGE);
+    mx::NodePtr custom = nodeGraph->addNode("shadercache_test", "custom1", "color3");
+    custom->setConnectedNode("in", multiply);
+    output->setConnectedNode(custom);
+    previousKey = cache->computeKey("shadercache", output, context);
+    std::remove(sourceFile.asString().c_str());
+    REQUIRE(cache->computeKey("shadercache", output, context) != previousKey);
+
+    cache->clear();
+    REQUIRE(!cache->read(key, context));
+    std::remove(cachePath.asString().c_str());
+}
+
+TEST_CASE("GenShader: Source Code Cache", "[genglsl]")
+{
+    const mx::FilePath testPath = mx::FilePath::getTempPath() / mx::FilePath("materialx_sourcecodecache_test");
+    testPath.createDirectory();
+    const mx::FilePath mainFile = testPath / mx::FilePath("main.glsl");
+    const mx::FilePath includeFile = testPath / mx::FilePath("include.glsl");
+    std::ofstream(mainFile.asString()) << "float a;\n#include \"include.glsl\"\n\n#include \"\"\nfloat c;";
+    std::ofstream(includeFile.asString()) << "float b;\n";
+
+    // Preprocessing groups lines into runs of code separated by includes,
+    // dropping include statements without a filename.
+    mx::SyntaxPtr syntax = mx::GlslSyntax::create();
+    mx::SourceCodeCache::SegmentVec segments = mx::SourceCodeCache::preprocess("float a;\n#include \"include.glsl\"\n\n#include \"\"\nfloat c;", *syntax);
+    REQUIRE(segments.size() == 3);
+    REQUIRE(segments[0].code == "float a;\n");
+    REQUIRE(segments[1].include == "include.glsl");
+    REQUIRE(segments[2].code == "\nfloat c;\n");
+
+    mx::SourceCodeCache& cache = mx::SourceCodeCache::get();
+    cache.clear();
+    mx::SourceCodeCache::ContentPtr content = cache.getContent(includeFile);
+    REQUIRE(content);
+    REQUIRE(*content == "float b;\n");
+    REQUIRE(cache.getContent(includeFile) == content);
+    REQUIRE(cache.size() == 1);
+    REQUIRE(!cache.getContent(testPath / mx::FilePath("missing.glsl")));
+
+    // Includes expand to the same code at any scope.
+    mx::GenContext context(mx::GlslShaderGenerator::create());
+    context.registerSourceCodeSearchPath(testPath);
+    const mx::ShaderGenerator& shadergen = context.getShaderGenerator();
+    mx::ShaderStage stage(mx::Stage::PIXEL, syntax);
+    shadergen.emitInclude("main.glsl", context, stage);
+    REQUIRE(stage.getSourceCode() == "float a;\nfloat b;\n\nfloat c;\n");
+    shadergen.emitInclude("main.glsl", context, stage);
+    REQUIRE(stage.getSourceCode() == "float a;\nfloat b;\n\nfloat c;\n");
+
+    mx::ShaderStage scopedStage(mx::Stage::PIXEL, syntax);
+    shadergen.emitScopeBegin(scopedStage);
+    shadergen.emitBlock("float a;\n#include \"main.glsl\"", context, scopedStage);
+    shadergen.emitScopeEnd(scopedStage);
+    const std::string& indent = syntax->getIndentation();
+    REQUIRE(scopedStage.getSourceCode() == "{\n" + indent + "float a;\n" + indent + "float a;\n" + indent + "float b;\n" +
+                                           indent + "\n" + indent + "float c;\n}\n");
+
+    cache.clear();
+    REQUIRE(cache.size() == 0);
+    std::remove(mainFile.asString().c_str());
+    std::remove(includeFile.asString().c_str());
+    std::remove(testPath.asString().c_str());
+}
+
+TEST_CASE("GenShader: GLSL Common Subexpressions", "[genglsl]")
+{
+    const mx::FilePath libSearchPath = mx::FilePath::getCurrentPath() / mx::FilePath("libraries");
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "stdlib" }, libSearchPath, doc);
+
+    // Build two identical branches sampling the same image, and sum them.
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph("cse_graph");
+    mx::NodePtr add = nodeGraph->addNode("add", "add1", "color3");
+    for (int i = 1; i <= 2; i++)
+    {
+        const std::string index = std::to_string(i);
+        mx::NodePtr texcoord = nodeGraph->addNode("texcoord", "texcoord" + index, "vector2");
+        mx::NodePtr image = nodeGraph->addNode("image", "image" + index, "color3");
+        image->setParameterValue("file", std::string("resources/Images/grid.png"), mx::FILENAME_TYPE_STRING);
+        image->setConnectedNode("texcoord", texcoord);
+        mx::NodePtr multiply = nodeGraph->addNode("multiply", "multiply" + index, "color3");
+        multiply->setConnectedNode("in1", image);
+        multiply->setInputValue("in2", 0.5f);
+        add->setConnectedNode("in" + index, multiply);
+    }
+    mx::OutputPtr output = nodeGraph->addOutput("out", "color3");
+    output->setConnectedNode(add);
+
+    mx::GenContext context(mx::GlslShaderGenerator::create());
+    context.registerSourceCodeSearchPath(libSearchPath);
+
+    // With a reduced interface, the duplicate branch is merged into the first.
+    context.getOptions().shaderInterfaceType = mx::SHADER_INTERFACE_REDUCED;
+    mx::ShaderPtr reduced = context.getShaderGenerator().generate("cse_reduced", output, context);
+    const mx::ShaderGraph& reducedGraph = reduced->getGraph();
+    REQUIRE(reducedGraph.getNode("image1"));
+    REQUIRE(reducedGraph.getNode("multiply1"));
+    REQUIRE(!reducedGraph.getNode("texcoord2"));
+    REQUIRE(!reducedGraph.getNode("image2"));
+    REQUIRE(!reducedGraph.getNode("multiply2"));
+    const mx::ShaderNode* reducedAdd = reducedGraph.getNode("add1");
+    REQUIRE(reducedAdd->getInput("in1")->getConnection() == reducedAdd->getInput("in2")->getConnection());
+
+    // With a complete interface, the images publish their own uniforms
+    // and are kept apart.
+    context.getOptions().shaderInterfaceType = mx::SHADER_INTERFACE_COMPLETE;
+    mx::ShaderPtr complete = context.getShaderGenerator().generate("cse_complete", output, context);
+    const mx::ShaderGraph& completeGraph = complete->getGraph();
+    REQUIRE(completeGraph.getNode("image1"));
+    REQUIRE(completeGraph.getNode("image2"));
+    REQUIRE(complete->getSourceCode(mx::Stage::PIXEL).size() > reduced->getSourceCode(mx::Stage::PIXEL).size());
+}
+
+TEST_CASE("GenShader: GLSL Constant Folding", "[genglsl]")
+{
+    const mx::FilePath libSearchPath = mx::FilePath::getCurrentPath() / mx::FilePath("libraries");
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "stdlib" }, libSearchPath, doc);
+
+    // Build a chain of math nodes on a constant, feeding a noise multiplier.
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph("folding_graph");
+    mx::NodePtr constant = nodeGraph->addNode("constant", "constant1", "color3");
+    constant->setParameterValue("value", mx::Color3(0.2f, 0.4f, 0.6f));
+    mx::NodePtr multiply = nodeGraph->addNode("multiply", "multiply1", "color3");
+    multiply->setConnectedNode("in1", constant);
+    multiply->setInputValue("in2", 0.5f);
+    mx::NodePtr add = nodeGraph->addNode("add", "add1", "color3");
+    add->setConnectedNode("in1", multiply);
+    add->setInputValue("in2", 0.1f);
+    mx::NodePtr mix = nodeGraph->addNode("mix", "mix1", "color3");
+    mix->setConnectedNode("fg", add);
+    mix->setInputValue("bg", mx::Color3(1.0f));
+    mix->setInputValue("mix", 0.5f);
+    mx::NodePtr clamp = nodeGraph->addNode("clamp", "clamp1", "color3");
+    clamp->setConnectedNode("in", mix);
+    clamp->setParameterValue("low", 0.0f);
+    clamp->setParameterValue("high", 0.68f);
+    mx::NodePtr power = nodeGraph->addNode("power", "power1", "color3");
+    power->setConnectedNode("in1", clamp);
+    power->setInputValue("in2", 2.0f);
+    mx::NodePtr swizzle = nodeGraph->addNode("swizzle", "swizzle1", "color3");
+    swizzle->setConnectedNode("in", power);
+    swizzle->setParameterValue("channels", std::string("bgr"));
+    mx::NodePtr convert = nodeGraph->addNode("convert", "convert1", "color4");
+    convert->setConnectedNode("in", swizzle);
+    mx::NodePtr noise = nodeGraph->addNode("noise2d", "noise1", "color4");
+    mx::NodePtr scale = nodeGraph->addNode("multiply", "scale1", "color4");
+    scale->setConnectedNode("in1", noise);
+    scale->setConnectedNode("in2", convert);
+    mx::OutputPtr output = nodeGraph->addOutput("out", "color4");
+    output->setConnectedNode(scale);
+
+    mx::GenContext context(mx::GlslShaderGenerator::create());
+    context.registerSourceCodeSearchPath(libSearchPath);
+
+    // With a reduced interface, the whole chain is evaluated on the CPU.
+    context.getOptions().shaderInterfaceType = mx::SHADER_INTERFACE_REDUCED;
+    mx::ShaderPtr reduced = context.getShaderGenerator().generate("folding_reduced", output, context);
+    const mx::ShaderGraph& reducedGraph = reduced->getGraph();
+    for (const char* name : { "constant1", "multiply1", "add1", "mix1", "clamp1", "power1", "swizzle1", "convert1" })
+    {
+        REQUIRE(!reducedGraph.getNode(name));
+    }
+    const mx::ShaderNode* reducedScale = reducedGraph.getNode("scale1");
+    REQUIRE(reducedScale);
+    const mx::ShaderInput* folded = reducedScale->getInput("in2");
+    REQUIRE(!folded->getConnection());
+    REQUIRE(folded->getValue()->isA<mx::Color4>());
+    const mx::Color4 expected(0.68f * 0.68f, 0.65f * 0.65f, 0.6f * 0.6f, 1.0f);
+    const mx::Color4 result = folded->getValue()->asA<mx::Color4>();
+    for (size_t i = 0; i < 4; i++)
+    {
+        REQUIRE(std::abs(result[i] - expected[i]) < 1e-5f);
+    }
+
+    // With a complete interface, the editable inputs of the chain are
+    // published as uniforms and the nodes are kept.
+    context.getOptions().shaderInterfaceType = mx::SHADER_INTERFACE_COMPLETE;
+    mx::ShaderPtr complete = context.getShaderGenerator().generate("folding_complete", output, context);
+    REQUIRE(complete->getGraph().getNode("add1"));
+    REQUIRE(complete->getGraph().getNode("power1"));
+}
+
+TEST_CASE("GenShader: GLSL Shader Change Classification", "[genglsl]")
+{
+    const mx::FilePath libSearchPath = mx::FilePath::getCurrentPath() / mx::FilePath("libraries");
+    mx::ObservedDocumentPtr doc = mx::Document::createDocument<mx::ObservedDocument>();
+    mx::loadLibraries({ "stdlib" }, libSearchPath, doc);
+
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph("change_graph");
+    mx::NodePtr noise = nodeGraph->addNode("noise2d", "noise1", "color3");
+    mx::NodePtr multiply = nodeGraph->addNode("multiply", "multiply1", "color3");
+    multiply->setConnectedNode("in1", noise);
+    mx::InputPtr in2 = multiply->setInputValue("in2", mx::Color3(0.25f, 0.5f, 0.75f));
+    mx::OutputPtr output = nodeGraph->addOutput("out", "color3");
+    output->setConnectedNode(multiply);
+    mx::NodeGraphPtr otherGraph = doc->addNodeGraph("other_graph");
+
+    mx::GenContext context(mx::GlslShaderGenerator::create());
+    context.registerSourceCodeSearchPath(libSearchPath);
+    mx::ShaderPtr shader = context.getShaderGenerator().generate("change", output, context);
+
+    mx::ShaderChangeObserverPtr observer = mx::ShaderChangeObserver::create(shader, output);
+    doc->addObserver("shaderChange", observer);
+
+    // Setting the value of a published input is a uniform update.
+    multiply->setInputValue("in2", mx::Color3(1.0f, 0.0f, 0.0f));
+    REQUIRE(!observer->requiresRegeneration());
+    REQUIRE(observer->getChanges().size() == 1);
+    const mx::ShaderChange& valueChange = observer->getChanges()[0];
+    REQUIRE(valueChange.type == mx::SHADER_CHANGE_UNIFORM);
+    REQUIRE(valueChange.path == in2->getNamePath());
+    REQUIRE(valueChange.value->asA<mx::Color3>() == mx::Color3(1.0f, 0.0f, 0.0f));
+    observer->clearChanges();
+
+    // So is adding an input holding a value for a nodedef default.
+    mx::ParameterPtr amplitude = noise->setParameterValue("amplitude", 2.0f);
+    REQUIRE(!observer->requiresRegeneration());
+    REQUIRE(observer->getChanges().size() == 1);
+    REQUIRE(observer->getChanges()[0].type == mx::SHADER_CHANGE_UNIFORM);
+    REQUIRE(observer->getChanges()[0].path == amplitude->getNamePath());
+    observer->clearChanges();
+
+    // Metadata and unrelated elements do not affect the shader.
+    in2->setAttribute(mx::ValueElement::UI_NAME_ATTRIBUTE, "Scale");
+    mx::NodePtr otherNode = otherGraph->addNode("constant", "constant1", "color3");
+    otherNode->setParameterValue("value", mx::Color3(1.0f));
+    doc->addLook("look1");
+    REQUIRE(observer->getChanges().empty());
+    mx::ShaderChange none = observer->classifySetAttribute(otherNode, mx::TypedElement::TYPE_ATTRIBUTE, "float");
+    REQUIRE(none.type == mx::SHADER_CHANGE_NONE);
+
+    // Changes to the connections of the graph require regeneration.
+    multiply->setConnectedNode("in2", noise);
+    REQUIRE(observer->requiresRegeneration());
+    REQUIRE(observer->getChanges().back().type == mx::SHADER_CHANGE_REGENERATE);
+    observer->clearChanges();
+
+    // As do changes to definitions.
+    doc->getNodeDef("ND_multiply_color3")->getInput("in2")->setValueString("2.0, 2.0, 2.0");
+    REQUIRE(observer->requiresRegeneration());
+}
+
+TEST_CASE("GenShader: GLSL Generation Profiler", "[genglsl]")
+{
+    const mx::FilePath libSearchPath = mx::FilePath::getCurrentPath() / mx::FilePath("libraries");
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "stdlib", "pbrlib" }, libSearchPath, doc);
+
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph("profiler_graph");
+    mx::NodePtr image = nodeGraph->addNode("image", "image1", "color3");
+    image->setParameterValue("file", std::string("resources/Images/grid.png"), mx::FILENAME_TYPE_STRING);
+    mx::NodePtr multiply = nodeGraph->addNode("multiply", "multiply1", "color3");
+    multiply->setConnectedNode("in1", image);
+    multiply->setInputValue("in2", 0.5f);
+    mx::OutputPtr output = nodeGraph->addOutput("out", "color3");
+    output->setConnectedNode(multiply);
+
+    mx::GenContext context(mx::GlslShaderGenerator::create());
+    context.registerSourceCodeSearchPath(libSearchPath);
+
+    // Without a profiler, nothing is recorded.
+    REQUIRE(!context.getProfiler());
+    REQUIRE(context.getShaderGenerator().generate("profiler_off", output, context));
+
+    mx::GenProfilerPtr profiler = mx::GenProfiler::create();
+    context.setProfiler(profiler);
+    context.clearNodeImplementations();
+    mx::ShaderPtr shader = context.getShaderGenerator().generate("profiler_first", output, context);
+    REQUIRE(shader);
+
+    // Implementations are created on the first generation.
+    REQUIRE(profiler->getEventCount("generate") == 1);
+    REQUIRE(profiler->getEventCount("finalize") == 1);
+    REQUIRE(profiler->getEventCount("optimize") == 1);
+    REQUIRE(profiler->getEventCount("topologicalSort") == 1);
+    REQUIRE(profiler->getEventCount("calculateScopes") == 1);
+    REQUIRE(profiler->getEventCount("setVariableNames") == 1);
+    REQUIRE(profiler->getEventCount("addUpstreamDependencies") >= 1);
+    REQUIRE(profiler->getEventCount("createConnectedNodes") >= 2);
+    REQUIRE(profiler->getEventCount("emitFunctionDefinition") > 0);
+    REQUIRE(profiler->getEventCount("emitFunctionCall") > 0);
+    REQUIRE(profiler->getEventCount("replaceTokens") == 2);
+    REQUIRE(profiler->getTotalTime("generate") >= profiler->getTotalTime("finalize"));
+    REQUIRE(profiler->getCounter(mx::GenProfiler::NODES) == (int64_t) shader->getGraph().getNodes().size());
+    REQUIRE(profiler->getCounter(mx::GenProfiler::INCLUDE_FILES) > 0);
+    REQUIRE(profiler->getCounter(mx::GenProfiler::BYTES_EMITTED) ==
+            (int64_t) (shader->getSourceCode(mx::Stage::VERTEX).size() + shader->getSourceCode(mx::Stage::PIXEL).size()));
+    const int64_t misses = profiler->getCounter(mx::GenProfiler::IMPL_CACHE_MISSES);
+    REQUIRE(misses > 0);
+
+    // Implementations are found in the context on the second generation.
+    profiler->clear();
+    REQUIRE(profiler->getEvents().empty());
+    REQUIRE(context.getShaderGenerator().generate("profiler_second", output, context));
+    REQUIRE(profiler->getCounter(mx::GenProfiler::IMPL_CACHE_MISSES) == 0);
+    REQUIRE(profiler->getCounter(mx::GenProfiler::IMPL_CACHE_HITS) >= misses);
+
+    // Write the trace.
+    const mx::FilePath tracePath("genglsl_profiler_trace.json");
+    profiler->writeChromeTrace(tracePath);
+    std::ifstream traceStream(tracePath.asString());
+    std::string trace((std::istreambuf_iterator<char>(traceStream)), std::istreambuf_iterator<char>());
+    REQUIRE(trace.find("{\"traceEvents\":[") == 0);
+    REQUIRE(trace.find("\"name\":\"finalize\"") != std::string::npos);
+    REQUIRE(trace.find("\"name\":\"implCacheHits\"") != std::string::npos);
+}
+
+TEST_CASE("GenShader: GLSL Threaded Generation benchmark", "[genglsl]")
+{
+    std::vector<mx::DocumentPtr> documents;
+    std::vector<mx::TypedElementPtr> elements = getStdlibTestElements(documents);
+    REQUIRE(!elements.empty());
+
+    std::ofstream benchmarkLog;
+    benchmarkLog.open("genglsl_threaded_generation_benchmark.txt");
+
+    // Generate all elements serially, then from multiple threads with
+    // private and shared implementations, verifying that the results agree.
+    auto timeGeneration = [&](const std::string& label, unsigned int threadCount, mx::ShaderNodeImplCachePtr implCache)
+    {
+        auto start = std::chrono::steady_clock::now();
+        mx::StringVec results = generateGlslFromThreads(elements, threadCount, implCache);
+        std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+        benchmarkLog << label << ": " << duration.count() << "s" << std::endl;
+        return results;
+    };
+    mx::StringVec serialResults = timeGeneration("Serial generation", 1, nullptr);
+    mx::StringVec privateResults = timeGeneration("Threaded generation", 4, nullptr);
+    mx::StringVec sharedResults = timeGeneration("Threaded generation with shared implementations", 4, mx::ShaderNodeImplCache::create());
+    REQUIRE(privateResults == serialResults);
+    REQUIRE(sharedResults == serialResults);
+
+    size_t errorCount = 0;
+    for (const std::string& result : serialResults)
+    {
+        REQUIRE(!result.empty());
+        if (result.find("Error: ") == 0)
+        {
+            benchmarkLog << result << std::endl;
+            errorCount++;
+        }
+    }
+    benchmarkLog << "Elements: " << elements.size() << ", errors: " << errorCount << std::endl;
+    REQUIRE(errorCount == 0);
+}
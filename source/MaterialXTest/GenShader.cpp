@@ -18,6 +18,7 @@
 
 #include <MaterialXTest/GenShaderUtil.h>
 
+#include <chrono>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
@@ -52,6 +53,188 @@ TEST_CASE("GenShader: Utilities", "[genshader]")
     REQUIRE(test2 == result2);
 }
 
+TEST_CASE("GenShader: Token Substitution", "[genshader]")
+{
+    mx::StringMap substitutions =
+    {
+        { "$threeheaded", "mighty" },
+        { "$three", "3" },
+        { "$monkey", "pirate" },
+        { "$", "dollar" },
+        { "$not-a-token", "never" },
+        { "plain", "never" }
+    };
+
+    // Tokens extend over all following alphanumeric characters, so that
+    // unknown tokens and tokens extending past a substitution are kept.
+    const std::vector<std::pair<std::string, std::string>> tests =
+    {
+        { "", "" },
+        { "no tokens here", "no tokens here" },
+        { "Look behind you, a $threeheaded $monkey!", "Look behind you, a mighty pirate!" },
+        { "$three$threeheaded$monkeys $monkey", "3mighty$monkeys pirate" },
+        { "$threeheadedmonkey $thr $unknown $not-a-token plain", "$threeheadedmonkey $thr $unknown $not-a-token plain" },
+        { "cost: $ 5, $$monkey, trailing $", "cost: dollar 5, dollarpirate, trailing $" },
+        { "$monkey", "pirate" }
+    };
+    for (const auto& test : tests)
+    {
+        std::string result = test.first;
+        mx::tokenSubstitution(substitutions, result);
+        REQUIRE(result == test.second);
+    }
+}
+
+namespace
+{
+
+// Reference implementation of token substitution, which builds the result
+// one token and one segment at a time.
+void referenceTokenSubstitution(const mx::StringMap& substitutions, std::string& source)
+{
+    std::string buffer;
+    size_t pos = 0, len = source.length();
+    while (pos < len)
+    {
+        size_t p1 = source.find_first_of('$', pos);
+        if (p1 != std::string::npos && p1 + 1 < len)
+        {
+            buffer += source.substr(pos, p1 - pos);
+            pos = p1 + 1;
+            std::string token = { '$' };
+            while (pos < len && isalnum(source[pos]))
+            {
+                token += source[pos++];
+            }
+            auto it = substitutions.find(token);
+            buffer += (it != substitutions.end() ? it->second : token);
+        }
+        else
+        {
+            buffer += source.substr(pos);
+            break;
+        }
+    }
+    source = buffer;
+}
+
+} // anonymous namespace
+
+TEST_CASE("GenShader: Token Substitution benchmark", "[genshader]")
+{
+    std::ofstream benchmarkLog;
+    benchmarkLog.open("genshader_token_substitution_benchmark.txt");
+
+    using Clock = std::chrono::steady_clock;
+    auto elapsed = [](Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    mx::StringMap substitutions =
+    {
+        { mx::HW::T_POSITION_WORLD, mx::HW::POSITION_WORLD },
+        { mx::HW::T_NORMAL_WORLD, mx::HW::NORMAL_WORLD },
+        { mx::HW::T_TANGENT_WORLD, mx::HW::TANGENT_WORLD },
+        { mx::HW::T_TEXCOORD, mx::HW::TEXCOORD },
+        { mx::HW::T_WORLD_MATRIX, mx::HW::WORLD_MATRIX },
+        { mx::HW::T_WORLD_INVERSE_TRANSPOSE_MATRIX, mx::HW::WORLD_INVERSE_TRANSPOSE_MATRIX },
+        { mx::HW::T_VIEW_PROJECTION_MATRIX, mx::HW::VIEW_PROJECTION_MATRIX },
+        { mx::HW::T_VIEW_POSITION, mx::HW::VIEW_POSITION },
+        { mx::HW::T_ENV_MATRIX, mx::HW::ENV_MATRIX },
+        { mx::HW::T_ENV_RADIANCE, mx::HW::ENV_RADIANCE },
+        { mx::HW::T_ENV_RADIANCE_MIPS, mx::HW::ENV_RADIANCE_MIPS },
+        { mx::HW::T_ENV_IRRADIANCE, mx::HW::ENV_IRRADIANCE },
+        { mx::HW::T_VERTEX_DATA_INSTANCE, mx::HW::VERTEX_DATA_INSTANCE },
+        { mx::HW::T_LIGHT_DATA_INSTANCE, mx::HW::LIGHT_DATA_INSTANCE }
+    };
+
+    // A block of pixel shader code, sparsely populated with tokens
+    // as in generated GLSL.
+    const std::string block =
+        "    vec3 N = normalize(" + mx::HW::T_VERTEX_DATA_INSTANCE + "." + mx::HW::T_NORMAL_WORLD + ");\n"
+        "    vec3 V = normalize(" + mx::HW::T_VIEW_POSITION + " - " + mx::HW::T_VERTEX_DATA_INSTANCE + "." + mx::HW::T_POSITION_WORLD + ");\n"
+        "    vec2 uv = " + mx::HW::T_VERTEX_DATA_INSTANCE + "." + mx::HW::T_TEXCOORD + "_0.xy;\n"
+        "    float NdotV = clamp(dot(N, V), M_FLOAT_EPS, 1.0);\n"
+        "    vec3 L = (" + mx::HW::T_ENV_MATRIX + " * vec4(reflect(-V, N), 0.0)).xyz;\n"
+        "    vec3 radiance = textureLod(" + mx::HW::T_ENV_RADIANCE + ", mx_latlong_projection(L), float(" + mx::HW::T_ENV_RADIANCE_MIPS + ")).rgb;\n"
+        "    vec3 irradiance = texture(" + mx::HW::T_ENV_IRRADIANCE + ", mx_latlong_projection(N)).rgb;\n"
+        "    // Accumulate the diffuse and specular contributions of the environment.\n"
+        "    mx_roughness_anisotropy(roughness, anisotropy, roughnessOut);\n"
+        "    vec3 result = mix(irradiance * base_color, radiance * specular_color, fresnel) * occlusion;\n";
+
+    for (size_t size : { 16 * 1024, 128 * 1024, 1024 * 1024 })
+    {
+        std::string source;
+        source.reserve(size + block.size());
+        while (source.size() < size)
+        {
+            source += block;
+        }
+
+        // Substitute the same total amount of source code at each size.
+        const size_t iterations = (32 * 1024 * 1024) / size;
+        std::string expected;
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < iterations; i++)
+        {
+            expected = source;
+            referenceTokenSubstitution(substitutions, expected);
+        }
+        const double referenceTime = elapsed(start);
+        REQUIRE(expected.find('$') == std::string::npos);
+
+        std::string result;
+        start = Clock::now();
+        for (size_t i = 0; i < iterations; i++)
+        {
+            result = source;
+            mx::tokenSubstitution(substitutions, result);
+        }
+        benchmarkLog << "Source " << source.size() << " bytes x " << iterations << ": " <<
+            referenceTime << "s reference, " << elapsed(start) << "s" << std::endl;
+        REQUIRE(result == expected);
+    }
+}
+
+TEST_CASE("GenShader: Code Buffer", "[genshader]")
+{
+    // Use small chunks to append across chunk boundaries.
+    mx::CodeBuffer buffer(8);
+    REQUIRE(buffer.empty());
+
+    std::string expected;
+    for (int i = 0; i < 100; i++)
+    {
+        const std::string line = "float v" + std::to_string(i) + " = " + std::to_string(i * 0.5f) + ";\n";
+        buffer += line;
+        expected += line;
+        REQUIRE(buffer.size() == expected.size());
+    }
+    buffer += "// A line longer than a chunk\n";
+    expected += "// A line longer than a chunk\n";
+    REQUIRE(buffer.str() == expected);
+
+    // Code appended after joining is joined on the next request.
+    buffer.append(std::string("}\n"));
+    expected += "}\n";
+    REQUIRE(buffer.size() == expected.size());
+    const mx::CodeBuffer& constBuffer = buffer;
+    REQUIRE(constBuffer.str() == expected);
+
+    // Edits to the joined string are reflected in the buffer.
+    buffer.str().replace(0, 5, "int  ");
+    buffer += "\n";
+    REQUIRE(buffer.str().compare(0, 5, "int  ") == 0);
+    REQUIRE(buffer.size() == expected.size() + 1);
+
+    buffer.assign("void main()");
+    REQUIRE(buffer.str() == "void main()");
+    buffer.clear();
+    REQUIRE(buffer.empty());
+    REQUIRE(buffer.str().empty());
+}
+
 TEST_CASE("GenShader: Valid Libraries", "[genshader]")
 {
     mx::DocumentPtr doc = mx::createDocument();
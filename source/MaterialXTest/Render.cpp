@@ -7,6 +7,8 @@
 
 #include <MaterialXTest/RenderUtil.h>
 
+#include <MaterialXGenShader/Nodes/ConvolutionNode.h>
+
 #include <MaterialXRender/ShaderRenderer.h>
 #include <MaterialXRender/StbImageLoader.h>
 #include <MaterialXRender/TinyObjLoader.h>
@@ -19,6 +21,7 @@
 #include <MaterialXContrib/Handlers/TinyEXRImageLoader.h>
 #endif
 
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <limits>
@@ -224,3 +227,535 @@ TEST_CASE("Render: Image Handler Load", "[rendercore]")
     CHECK(imagesLoaded);
     imageHandlerLog.close();
 }
+
+TEST_CASE("Render: Image Cache Budget", "[rendercore]")
+{
+    mx::ImageHandlerPtr imageHandler = mx::ImageHandler::create(mx::StbImageLoader::create());
+    imageHandler->setSearchPath(mx::FileSearchPath(mx::FilePath::getCurrentPath() / mx::FilePath("resources/Images")));
+    REQUIRE(imageHandler->getCacheBudget() == 0);
+
+    // Images are cached without limit by default.
+    mx::ImagePtr cloth = imageHandler->acquireImage("cloth.png", false);
+    mx::ImagePtr grid = imageHandler->acquireImage("grid.png", false);
+    mx::ImagePtr marble = imageHandler->acquireImage("marble.png", false);
+    REQUIRE((cloth && grid && marble));
+    REQUIRE(imageHandler->acquireImage("cloth.png", false) == cloth);
+    mx::ImageCacheStatistics stats = imageHandler->getCacheStatistics();
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.misses == 3);
+    REQUIRE(stats.evictions == 0);
+    REQUIRE(stats.imageCount == 3);
+    REQUIRE(stats.byteCount == cloth->getResourceBufferSize() + grid->getResourceBufferSize() + marble->getResourceBufferSize());
+
+    // The least recently used image that is not pinned is evicted first.
+    imageHandler->setImagePinned(marble, true);
+    REQUIRE(imageHandler->isImagePinned(marble));
+    imageHandler->setCacheBudget(cloth->getResourceBufferSize() + marble->getResourceBufferSize());
+    stats = imageHandler->getCacheStatistics();
+    REQUIRE(stats.evictions == 1);
+    REQUIRE(stats.imageCount == 2);
+    REQUIRE(stats.byteCount <= imageHandler->getCacheBudget());
+    REQUIRE(imageHandler->acquireImage("cloth.png", false) == cloth);
+    REQUIRE(imageHandler->acquireImage("marble.png", false) == marble);
+
+    // Pinned images are kept when the budget cannot be met.
+    imageHandler->setCacheBudget(1);
+    stats = imageHandler->getCacheStatistics();
+    REQUIRE(stats.evictions == 2);
+    REQUIRE(stats.imageCount == 1);
+    REQUIRE(stats.byteCount == marble->getResourceBufferSize());
+
+    // A newly acquired image is kept in place of unpinned images.
+    imageHandler->setImagePinned(marble, false);
+    imageHandler->resetCacheStatistics();
+    mx::ImagePtr grid2 = imageHandler->acquireImage("grid.png", false);
+    REQUIRE((grid2 && grid2 != grid));
+    REQUIRE(imageHandler->acquireImage("grid.png", false) == grid2);
+    stats = imageHandler->getCacheStatistics();
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.misses == 1);
+    REQUIRE(stats.evictions == 1);
+    REQUIRE(stats.imageCount == 1);
+    REQUIRE(stats.byteCount == grid2->getResourceBufferSize());
+
+    // Mip levels requested on acquisition are generated on the CPU and
+    // counted against the budget, including for images already cached.
+    imageHandler->setCacheBudget(0);
+    mx::ImagePtr mipmapped = imageHandler->acquireImage("cloth.png", true);
+    REQUIRE(mipmapped->getMips().size() == mipmapped->getMaxMipCount() - 1);
+    size_t mipmappedBytes = mipmapped->getResourceBufferSize();
+    for (mx::ImagePtr mip : mipmapped->getMips())
+    {
+        mipmappedBytes += mip->getResourceBufferSize();
+    }
+    stats = imageHandler->getCacheStatistics();
+    REQUIRE(stats.byteCount == grid2->getResourceBufferSize() + mipmappedBytes);
+    REQUIRE(imageHandler->acquireImage("grid.png", true) == grid2);
+    REQUIRE(!grid2->getMips().empty());
+    REQUIRE(imageHandler->getCacheStatistics().byteCount > stats.byteCount);
+
+    // Clearing the cache unpins all images.
+    class ClearableImageHandler : public mx::ImageHandler
+    {
+      public:
+        ClearableImageHandler() : mx::ImageHandler(mx::StbImageLoader::create()) { }
+        using mx::ImageHandler::clearImageCache;
+    };
+    ClearableImageHandler clearableHandler;
+    clearableHandler.setImagePinned(cloth, true);
+    clearableHandler.clearImageCache();
+    REQUIRE(!clearableHandler.isImagePinned(cloth));
+}
+
+TEST_CASE("Render: Image Prefetch", "[rendercore]")
+{
+    const mx::FileSearchPath searchPath(mx::FilePath::getCurrentPath() / mx::FilePath("resources/Images"));
+    mx::ImageHandlerPtr imageHandler = mx::ImageHandler::create(mx::StbImageLoader::create());
+    imageHandler->setSearchPath(searchPath);
+
+    // Requests for the same image share a single load.
+    mx::FilePathVec filePaths = { "cloth.png", "grid.png", "cloth.png", "missing.png" };
+    std::vector<mx::ImageFuture> futures = imageHandler->prefetchImages(filePaths);
+    REQUIRE(futures.size() == 4);
+    REQUIRE(imageHandler->getPendingImageCount() == 3);
+    REQUIRE(futures[0].get() == futures[2].get());
+    mx::ImagePtr cloth = futures[0].get();
+    mx::ImagePtr grid = futures[1].get();
+    REQUIRE((cloth && grid));
+    REQUIRE(!futures[3].get());
+
+    // Completed prefetches are counted as pending until the next call to
+    // the handler moves them into the cache, dropping failed loads.
+    mx::ImageCacheStatistics stats = imageHandler->getCacheStatistics();
+    REQUIRE(stats.imageCount == 0);
+    REQUIRE(stats.pendingByteCount == cloth->getResourceBufferSize() + grid->getResourceBufferSize());
+    REQUIRE(imageHandler->prefetchImages({ "grid.png" })[0].get() == grid);
+    REQUIRE(imageHandler->getPendingImageCount() == 0);
+    stats = imageHandler->getCacheStatistics();
+    REQUIRE(stats.imageCount == 2);
+    REQUIRE(stats.pendingByteCount == 0);
+    REQUIRE(stats.byteCount == cloth->getResourceBufferSize() + grid->getResourceBufferSize());
+    REQUIRE(imageHandler->acquireImage("cloth.png", false) == cloth);
+    REQUIRE(!imageHandler->acquireImage("missing.png", false));
+    stats = imageHandler->getCacheStatistics();
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.misses == 1);
+
+    // Cached images are returned as ready futures.
+    std::vector<mx::ImageFuture> cached = imageHandler->prefetchImages({ "cloth.png" });
+    REQUIRE(cached[0].wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    REQUIRE(cached[0].get() == cloth);
+    REQUIRE(imageHandler->getPendingImageCount() == 0);
+
+    // Acquiring an image that is being prefetched returns the prefetched
+    // image, and caches it.
+    mx::ImageHandlerPtr waitingHandler = mx::ImageHandler::create(mx::StbImageLoader::create());
+    waitingHandler->setSearchPath(searchPath);
+    futures = waitingHandler->prefetchImages({ "cloth.png", "grid.png" });
+    mx::ImagePtr waitedCloth = waitingHandler->acquireImage("cloth.png", false);
+    REQUIRE(waitedCloth == futures[0].get());
+    REQUIRE(waitingHandler->acquireImage("grid.png", false) == futures[1].get());
+    REQUIRE(waitingHandler->getPendingImageCount() == 0);
+    REQUIRE(waitingHandler->getCacheStatistics().imageCount == 2);
+
+    // Prefetched images are held to the cache budget.
+    mx::ImageHandlerPtr budgetHandler = mx::ImageHandler::create(mx::StbImageLoader::create());
+    budgetHandler->setSearchPath(searchPath);
+    budgetHandler->setCacheBudget(1);
+    futures = budgetHandler->prefetchImages({ "cloth.png", "grid.png", "marble.png" });
+    for (const mx::ImageFuture& future : futures)
+    {
+        future.wait();
+    }
+    budgetHandler->prefetchImages({});
+    stats = budgetHandler->getCacheStatistics();
+    REQUIRE(budgetHandler->getPendingImageCount() == 0);
+    REQUIRE(stats.imageCount == 1);
+    REQUIRE(stats.evictions == 2);
+    REQUIRE(stats.pendingByteCount == 0);
+
+    // Prefetches whose loader throws are treated as failed loads.
+    class ThrowingImageLoader : public mx::ImageLoader
+    {
+      public:
+        ThrowingImageLoader()
+        {
+            _extensions.insert(PNG_EXTENSION);
+        }
+        bool saveImage(const mx::FilePath&, mx::ConstImagePtr, bool) override
+        {
+            return false;
+        }
+        mx::ImagePtr loadImage(const mx::FilePath&) override
+        {
+            throw std::bad_alloc();
+        }
+    };
+    mx::ImageHandlerPtr throwingHandler = mx::ImageHandler::create(std::make_shared<ThrowingImageLoader>());
+    throwingHandler->setSearchPath(searchPath);
+    futures = throwingHandler->prefetchImages({ "cloth.png" });
+    futures[0].wait();
+    REQUIRE(throwingHandler->getCacheStatistics().pendingByteCount == 0);
+    REQUIRE(throwingHandler->prefetchImages({}).empty());
+    REQUIRE(throwingHandler->getPendingImageCount() == 0);
+    REQUIRE(throwingHandler->getCacheStatistics().imageCount == 0);
+}
+
+TEST_CASE("Render: Image Compression", "[rendercore]")
+{
+    // Create a smooth two-channel image with partial edge blocks.
+    mx::ImagePtr image = mx::Image::create(13, 7, 2, mx::Image::BaseType::FLOAT);
+    image->createResourceBuffer();
+    for (unsigned int y = 0; y < image->getHeight(); y++)
+    {
+        for (unsigned int x = 0; x < image->getWidth(); x++)
+        {
+            float t = (x + y) / 18.0f;
+            image->setTexelColor(x, y, mx::Color4(t, 1.0f - t, 0.0f, 1.0f));
+        }
+    }
+
+    for (mx::Image::CompressionFormat format : { mx::Image::CompressionFormat::BC1,
+                                                 mx::Image::CompressionFormat::BC4,
+                                                 mx::Image::CompressionFormat::BC5 })
+    {
+        // BC1 quantizes each block to four colors, where BC4 and BC5
+        // quantize each channel to eight values.
+        const float maxError = format == mx::Image::CompressionFormat::BC1 ? 0.1f : 0.05f;
+        mx::ImagePtr compressed = image->compress(format);
+        REQUIRE(compressed->isCompressed());
+        REQUIRE(compressed->getCompressionFormat() == format);
+        size_t blockBytes = format == mx::Image::CompressionFormat::BC5 ? 16 : 8;
+        REQUIRE(compressed->getResourceBufferSize() == 4 * 2 * blockBytes);
+        REQUIRE_THROWS(compressed->setTexelColor(0, 0, mx::Color4(0.0f)));
+        REQUIRE_THROWS(compressed->compress(format));
+
+        // Decoding single texels matches decoding the full image.
+        mx::ImagePtr decompressed = compressed->decompress();
+        REQUIRE(!decompressed->isCompressed());
+        REQUIRE(decompressed->getBaseType() == mx::Image::BaseType::UINT8);
+        REQUIRE(decompressed->getChannelCount() == compressed->getChannelCount());
+        for (unsigned int y = 0; y < image->getHeight(); y++)
+        {
+            for (unsigned int x = 0; x < image->getWidth(); x++)
+            {
+                mx::Color4 texel = compressed->getTexelColor(x, y);
+                REQUIRE(texel == decompressed->getTexelColor(x, y));
+                mx::Color4 original = image->getTexelColor(x, y);
+                REQUIRE(std::abs(texel[0] - original[0]) < maxError);
+                if (format != mx::Image::CompressionFormat::BC4)
+                {
+                    REQUIRE(std::abs(texel[1] - original[1]) < maxError);
+                }
+            }
+        }
+    }
+
+    // Constant images are encoded without error.
+    mx::Color4 color(0.0f, 1.0f, 0.0f, 1.0f);
+    mx::ImagePtr constant = mx::Image::createConstantColor(5, 5, color);
+    REQUIRE(constant->compress(mx::Image::CompressionFormat::BC1)->getTexelColor(4, 4) == color);
+}
+
+TEST_CASE("Render: HDR Image Base Type", "[rendercore]")
+{
+    mx::ImagePtr image = mx::Image::create(4, 3, 3, mx::Image::BaseType::FLOAT);
+    image->createResourceBuffer();
+    for (unsigned int y = 0; y < image->getHeight(); y++)
+    {
+        for (unsigned int x = 0; x < image->getWidth(); x++)
+        {
+            image->setTexelColor(x, y, mx::Color4(x * 4.0f, y * 0.25f, 1.0f, 1.0f));
+        }
+    }
+
+    // Half-float images are saved through their float equivalent.
+    mx::ImagePtr halfImage = image->convert(mx::Image::BaseType::HALF);
+    REQUIRE(halfImage->getBaseType() == mx::Image::BaseType::HALF);
+    REQUIRE(halfImage->getResourceBufferSize() * 2 == image->getResourceBufferSize());
+    mx::StbImageLoaderPtr loader = mx::StbImageLoader::create();
+    mx::FilePath filePath = mx::FilePath::getCurrentPath() / mx::FilePath("hdrBaseType.hdr");
+    REQUIRE(loader->saveImage(filePath, halfImage));
+
+    // HDR images may be loaded as half-float images.
+    REQUIRE(loader->loadImage(filePath)->getBaseType() == mx::Image::BaseType::FLOAT);
+    loader->setHdrBaseType(mx::Image::BaseType::HALF);
+    mx::ImagePtr loaded = loader->loadImage(filePath);
+    REQUIRE(loaded->getBaseType() == mx::Image::BaseType::HALF);
+    REQUIRE(loaded->getWidth() == image->getWidth());
+    REQUIRE(loaded->getHeight() == image->getHeight());
+    for (unsigned int y = 0; y < image->getHeight(); y++)
+    {
+        for (unsigned int x = 0; x < image->getWidth(); x++)
+        {
+            mx::Color4 original = image->getTexelColor(x, y);
+            mx::Color4 texel = loaded->getTexelColor(x, y);
+            for (unsigned int c = 0; c < 3; c++)
+            {
+                REQUIRE(std::abs(texel[c] - original[c]) <= original[c] * 0.01f);
+            }
+        }
+    }
+}
+
+TEST_CASE("Render: Image Mips", "[rendercore]")
+{
+    // Box-filtered mips preserve the mean of images with odd dimensions.
+    mx::ImagePtr image = mx::Image::create(37, 11, 4, mx::Image::BaseType::FLOAT);
+    image->createResourceBuffer();
+    mx::Color4 mean;
+    for (unsigned int y = 0; y < image->getHeight(); y++)
+    {
+        for (unsigned int x = 0; x < image->getWidth(); x++)
+        {
+            mx::Color4 color((x + y) % 2 ? 1.0f : 0.0f, x / 36.0f, y / 10.0f, 1.0f);
+            image->setTexelColor(x, y, color);
+            mean += color;
+        }
+    }
+    mean /= (float) (image->getWidth() * image->getHeight());
+
+    image->generateMips();
+    const std::vector<mx::ImagePtr>& mips = image->getMips();
+    REQUIRE(mips.size() == image->getMaxMipCount() - 1);
+    unsigned int width = image->getWidth();
+    unsigned int height = image->getHeight();
+    for (mx::ImagePtr mip : mips)
+    {
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+        REQUIRE(mip->getWidth() == width);
+        REQUIRE(mip->getHeight() == height);
+        REQUIRE(mip->getChannelCount() == 4);
+        REQUIRE(mip->getBaseType() == mx::Image::BaseType::FLOAT);
+        REQUIRE(mip->getMips().empty());
+    }
+    mx::Color4 top = mips.back()->getTexelColor(0, 0);
+    REQUIRE((width == 1 && height == 1));
+    for (unsigned int c = 0; c < 4; c++)
+    {
+        REQUIRE(std::abs(top[c] - mean[c]) < 1.0e-4f);
+    }
+    image->clearMips();
+    REQUIRE(image->getMips().empty());
+
+    // Mips of loaded and compressed images keep their storage format.
+    mx::ImagePtr cloth = mx::StbImageLoader::create()->loadImage(
+        mx::FilePath::getCurrentPath() / mx::FilePath("resources/Images/cloth.png"));
+    REQUIRE(cloth);
+    mx::ImagePtr compressed = cloth->compress(mx::Image::CompressionFormat::BC1);
+    for (mx::ImagePtr source : { cloth, compressed })
+    {
+        source->generateMips();
+        REQUIRE(source->getMips().size() == source->getMaxMipCount() - 1);
+        for (mx::ImagePtr mip : source->getMips())
+        {
+            REQUIRE(mip->getBaseType() == source->getBaseType());
+            REQUIRE(mip->getCompressionFormat() == source->getCompressionFormat());
+            REQUIRE(mip->getChannelCount() == source->getChannelCount());
+        }
+    }
+    mx::Color4 clothTop = cloth->getMips().back()->getTexelColor(0, 0);
+    mx::Color4 compressedTop = compressed->getMips().back()->getTexelColor(0, 0);
+    for (unsigned int c = 0; c < 3; c++)
+    {
+        REQUIRE(std::abs(clothTop[c] - compressedTop[c]) < 0.05f);
+    }
+}
+
+namespace
+{
+
+// Per-texel reference implementations of the image filters.
+
+mx::ImagePtr referenceBoxBlur(mx::ImagePtr image)
+{
+    mx::ImagePtr blurImage = mx::Image::create(image->getWidth(), image->getHeight(), image->getChannelCount(), image->getBaseType());
+    blurImage->createResourceBuffer();
+    for (int y = 0; y < (int) image->getHeight(); y++)
+    {
+        for (int x = 0; x < (int) image->getWidth(); x++)
+        {
+            mx::Color4 blurColor;
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                int sy = std::min(std::max(y + dy, 0), (int) image->getHeight() - 1);
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    int sx = std::min(std::max(x + dx, 0), (int) image->getWidth() - 1);
+                    blurColor += image->getTexelColor(sx, sy);
+                }
+            }
+            blurColor /= 9.0f;
+            blurImage->setTexelColor(x, y, blurColor);
+        }
+    }
+    return blurImage;
+}
+
+mx::ImagePtr referenceGaussianBlur(mx::ImagePtr image)
+{
+    const std::array<float, 7>& kernel = mx::GAUSSIAN_KERNEL_7;
+    mx::ImagePtr blurImage1 = mx::Image::create(image->getWidth(), image->getHeight(), image->getChannelCount(), image->getBaseType());
+    mx::ImagePtr blurImage2 = mx::Image::create(image->getWidth(), image->getHeight(), image->getChannelCount(), image->getBaseType());
+    blurImage1->createResourceBuffer();
+    blurImage2->createResourceBuffer();
+    for (int y = 0; y < (int) image->getHeight(); y++)
+    {
+        for (int x = 0; x < (int) image->getWidth(); x++)
+        {
+            mx::Color4 blurColor;
+            for (int dy = -3; dy <= 3; dy++)
+            {
+                int sy = std::min(std::max(y + dy, 0), (int) image->getHeight() - 1);
+                blurColor += image->getTexelColor(x, sy) * kernel[dy + 3];
+            }
+            blurImage1->setTexelColor(x, y, blurColor);
+        }
+    }
+    for (int y = 0; y < (int) image->getHeight(); y++)
+    {
+        for (int x = 0; x < (int) image->getWidth(); x++)
+        {
+            mx::Color4 blurColor;
+            for (int dx = -3; dx <= 3; dx++)
+            {
+                int sx = std::min(std::max(x + dx, 0), (int) image->getWidth() - 1);
+                blurColor += blurImage1->getTexelColor(sx, y) * kernel[dx + 3];
+            }
+            blurImage2->setTexelColor(x, y, blurColor);
+        }
+    }
+    return blurImage2;
+}
+
+mx::ImagePair referenceSplitByLuminance(mx::ImagePtr image, float luminance)
+{
+    mx::ImagePtr underflowImage = mx::Image::create(image->getWidth(), image->getHeight(), image->getChannelCount(), image->getBaseType());
+    mx::ImagePtr overflowImage = mx::Image::create(image->getWidth(), image->getHeight(), image->getChannelCount(), image->getBaseType());
+    underflowImage->createResourceBuffer();
+    overflowImage->createResourceBuffer();
+    for (unsigned int y = 0; y < image->getHeight(); y++)
+    {
+        for (unsigned int x = 0; x < image->getWidth(); x++)
+        {
+            mx::Color4 envColor = image->getTexelColor(x, y);
+            mx::Color4 underflowColor(
+                std::min(envColor[0], luminance),
+                std::min(envColor[1], luminance),
+                std::min(envColor[2], luminance), 1.0f);
+            mx::Color4 overflowColor(
+                std::max(envColor[0] - underflowColor[0], 0.0f),
+                std::max(envColor[1] - underflowColor[1], 0.0f),
+                std::max(envColor[2] - underflowColor[2], 0.0f), 1.0f);
+            underflowImage->setTexelColor(x, y, underflowColor);
+            overflowImage->setTexelColor(x, y, overflowColor);
+        }
+    }
+    return std::make_pair(underflowImage, overflowImage);
+}
+
+bool compareImages(mx::ImagePtr image1, mx::ImagePtr image2, float tolerance)
+{
+    if (image1->getWidth() != image2->getWidth() ||
+        image1->getHeight() != image2->getHeight() ||
+        image1->getChannelCount() != image2->getChannelCount() ||
+        image1->getBaseType() != image2->getBaseType())
+    {
+        return false;
+    }
+    for (unsigned int y = 0; y < image1->getHeight(); y++)
+    {
+        for (unsigned int x = 0; x < image1->getWidth(); x++)
+        {
+            mx::Color4 color1 = image1->getTexelColor(x, y);
+            mx::Color4 color2 = image2->getTexelColor(x, y);
+            for (unsigned int c = 0; c < 4; c++)
+            {
+                if (std::abs(color1[c] - color2[c]) > tolerance)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Render: Image Filter benchmark", "[rendercore]")
+{
+    std::ofstream benchmarkLog;
+    benchmarkLog.open("render_image_filter_benchmark.txt");
+
+    using Clock = std::chrono::steady_clock;
+    auto elapsed = [](Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    // Test each base type and channel count supported by the filters,
+    // including an environment-sized float image.
+    struct ImageSpec
+    {
+        unsigned int width;
+        unsigned int height;
+        unsigned int channelCount;
+        mx::Image::BaseType baseType;
+    };
+    std::vector<ImageSpec> specs =
+    {
+        { 5, 2, 1, mx::Image::BaseType::FLOAT },
+        { 67, 33, 2, mx::Image::BaseType::HALF },
+        { 128, 64, 4, mx::Image::BaseType::UINT8 },
+        { 1024, 512, 3, mx::Image::BaseType::FLOAT }
+    };
+    for (const ImageSpec& spec : specs)
+    {
+        mx::ImagePtr image = mx::Image::create(spec.width, spec.height, spec.channelCount, spec.baseType);
+        image->createResourceBuffer();
+        for (unsigned int y = 0; y < image->getHeight(); y++)
+        {
+            for (unsigned int x = 0; x < image->getWidth(); x++)
+            {
+                float value = (float) ((x * 7 + y * 13) % 17) / 16.0f;
+                image->setTexelColor(x, y, mx::Color4(value, 1.0f - value, value * 2.0f, 0.5f));
+            }
+        }
+        if (spec.baseType == mx::Image::BaseType::FLOAT)
+        {
+            // Add texels above the luminance threshold.
+            image->setTexelColor(0, 0, mx::Color4(4.0f, 8.0f, 16.0f, 1.0f));
+        }
+
+        // Results match to within the precision of the base type.
+        const float tolerance = spec.baseType == mx::Image::BaseType::UINT8 ? 1.5f / 255.0f : 1.0e-3f;
+        benchmarkLog << "Image " << spec.width << "x" << spec.height << "x" << spec.channelCount << std::endl;
+
+        Clock::time_point start = Clock::now();
+        mx::ImagePtr referenceBox = referenceBoxBlur(image);
+        double referenceTime = elapsed(start);
+        start = Clock::now();
+        mx::ImagePtr box = image->applyBoxBlur();
+        benchmarkLog << "  Box blur: " << referenceTime << "s reference, " << elapsed(start) << "s" << std::endl;
+        REQUIRE(compareImages(box, referenceBox, tolerance));
+
+        start = Clock::now();
+        mx::ImagePtr referenceGaussian = referenceGaussianBlur(image);
+        referenceTime = elapsed(start);
+        start = Clock::now();
+        mx::ImagePtr gaussian = image->applyGaussianBlur();
+        benchmarkLog << "  Gaussian blur: " << referenceTime << "s reference, " << elapsed(start) << "s" << std::endl;
+        REQUIRE(compareImages(gaussian, referenceGaussian, tolerance));
+
+        start = Clock::now();
+        mx::ImagePair referenceSplit = referenceSplitByLuminance(image, 1.0f);
+        referenceTime = elapsed(start);
+        start = Clock::now();
+        mx::ImagePair split = image->splitByLuminance(1.0f);
+        benchmarkLog << "  Luminance split: " << referenceTime << "s reference, " << elapsed(start) << "s" << std::endl;
+        REQUIRE(compareImages(split.first, referenceSplit.first, tolerance));
+        REQUIRE(compareImages(split.second, referenceSplit.second, tolerance));
+    }
+}
@@ -6,9 +6,65 @@
 #include <MaterialXTest/Catch/catch.hpp>
 
 #include <MaterialXCore/Document.h>
+#include <MaterialXFormat/File.h>
+#include <MaterialXGenShader/Util.h>
+
+#include <chrono>
+#include <fstream>
+#include <set>
 
 namespace mx = MaterialX;
 
+namespace
+{
+
+// Reference upstream walk, tracking the current path in a std::set as
+// GraphIterator did before ElementPathSet.  Returns the number of edges
+// visited upstream of the given element.
+size_t referenceGraphWalk(mx::ElementPtr elem, std::set<mx::ElementPtr>& pathElems)
+{
+    if (!pathElems.insert(elem).second)
+    {
+        throw mx::ExceptionFoundCycle("Encountered cycle at element: " + elem->asString());
+    }
+    size_t count = 0;
+    for (size_t i = 0; i < elem->getUpstreamEdgeCount(); i++)
+    {
+        mx::Edge edge = elem->getUpstreamEdge(nullptr, i);
+        if (edge && edge.getUpstreamElement())
+        {
+            count += 1 + referenceGraphWalk(edge.getUpstreamElement(), pathElems);
+        }
+    }
+    pathElems.erase(elem);
+    return count;
+}
+
+// Reference inheritance walk, tracking visited elements in a std::set as
+// InheritanceIterator did before ElementPathSet.
+size_t referenceInheritanceWalk(mx::ElementPtr elem)
+{
+    std::set<mx::ElementPtr> pathElems;
+    size_t count = 0;
+    while (elem)
+    {
+        count++;
+        mx::ElementPtr super = elem->getInheritsFrom();
+        if (super && super->getCategory() != elem->getCategory())
+        {
+            super = nullptr;
+        }
+        if (super && !pathElems.insert(super).second)
+        {
+            throw mx::ExceptionFoundCycle("Encountered cycle at element: " + super->asString());
+        }
+        elem = super;
+    }
+    return count;
+}
+
+} // anonymous namespace
+
 TEST_CASE("Traversal", "[traversal]")
 {
     // Test null iterators.
@@ -171,3 +227,142 @@ TEST_CASE("Traversal", "[traversal]")
     REQUIRE(!output->hasUpstreamCycle());
     REQUIRE(doc->validate());
 }
+
+TEST_CASE("Element path set", "[traversal]")
+{
+    mx::DocumentPtr doc = mx::createDocument();
+    std::vector<mx::ElementPtr> elements;
+    for (int i = 0; i < 100; i++)
+    {
+        elements.push_back(doc->addChildOfCategory("generic"));
+    }
+
+    // Fill the set past its inline capacity, then remove every other element.
+    mx::ElementPathSet pathSet;
+    for (mx::ElementPtr elem : elements)
+    {
+        REQUIRE(pathSet.insert(elem.get()));
+        REQUIRE(!pathSet.insert(elem.get()));
+    }
+    for (size_t i = 0; i < elements.size(); i += 2)
+    {
+        pathSet.erase(elements[i].get());
+    }
+    for (size_t i = 0; i < elements.size(); i++)
+    {
+        REQUIRE(pathSet.contains(elements[i].get()) == (i % 2 == 1));
+    }
+    REQUIRE(!pathSet.contains(doc.get()));
+}
+
+TEST_CASE("Traversal benchmark", "[traversal]")
+{
+    std::ofstream benchmarkLog;
+    benchmarkLog.open("traversal_benchmark.txt");
+
+    using Clock = std::chrono::steady_clock;
+    auto elapsed = [](Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::FilePath searchPath = mx::FilePath::getCurrentPath() / mx::FilePath("libraries");
+    mx::loadLibraries({ "stdlib", "pbrlib", "bxdf" }, searchPath, doc);
+
+    // Add a deep chain of nodes alongside the library graphs.
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph();
+    mx::NodePtr first = nodeGraph->addNode("add", "", "color3");
+    mx::NodePtr last = first;
+    for (int i = 0; i < 1000; i++)
+    {
+        mx::NodePtr node = nodeGraph->addNode("add", "", "color3");
+        node->setConnectedNode("in1", last);
+        last = node;
+    }
+    mx::OutputPtr output = nodeGraph->addOutput("out", "color3");
+    output->setConnectedNode(last);
+    REQUIRE(!output->hasUpstreamCycle());
+
+    std::vector<mx::OutputPtr> graphOutputs;
+    for (mx::NodeGraphPtr graph : doc->getNodeGraphs())
+    {
+        for (mx::OutputPtr graphOutput : graph->getOutputs())
+        {
+            graphOutputs.push_back(graphOutput);
+        }
+    }
+    const int iterations = 100;
+
+    // Traverse the upstream graphs of all outputs.
+    Clock::time_point start = Clock::now();
+    size_t referenceEdgeCount = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        for (mx::OutputPtr graphOutput : graphOutputs)
+        {
+            std::set<mx::ElementPtr> pathElems;
+            referenceEdgeCount += referenceGraphWalk(graphOutput, pathElems);
+        }
+    }
+    double referenceTime = elapsed(start);
+    start = Clock::now();
+    size_t edgeCount = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        for (mx::OutputPtr graphOutput : graphOutputs)
+        {
+            for (mx::Edge edge : graphOutput->traverseGraph())
+            {
+                edgeCount++;
+            }
+        }
+    }
+    benchmarkLog << "Graph traversal, " << graphOutputs.size() << " outputs x " << iterations << ": " <<
+        referenceTime << "s reference, " << elapsed(start) << "s" << std::endl;
+    REQUIRE(edgeCount == referenceEdgeCount);
+
+    // Traverse the inheritance chains of all top-level elements.
+    start = Clock::now();
+    size_t referenceInheritanceCount = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        for (mx::ElementPtr elem : doc->getChildren())
+        {
+            referenceInheritanceCount += referenceInheritanceWalk(elem);
+        }
+    }
+    referenceTime = elapsed(start);
+    start = Clock::now();
+    size_t inheritanceCount = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        for (mx::ElementPtr elem : doc->getChildren())
+        {
+            for (mx::ConstElementPtr inherited : elem->traverseInheritance())
+            {
+                inheritanceCount++;
+            }
+        }
+    }
+    benchmarkLog << "Inheritance traversal, " << doc->getChildren().size() << " elements x " << iterations << ": " <<
+        referenceTime << "s reference, " << elapsed(start) << "s" << std::endl;
+    REQUIRE(inheritanceCount == referenceInheritanceCount);
+
+    // Cycle detection across the deep chain.
+    first->setConnectedNode("in1", last);
+    start = Clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        std::set<mx::ElementPtr> pathElems;
+        REQUIRE_THROWS_AS(referenceGraphWalk(output, pathElems), mx::ExceptionFoundCycle&);
+    }
+    referenceTime = elapsed(start);
+    start = Clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        REQUIRE(output->hasUpstreamCycle());
+    }
+    benchmarkLog << "Cycle detection, " << nodeGraph->getNodes().size() << " nodes x " << iterations << ": " <<
+        referenceTime << "s reference, " << elapsed(start) << "s" << std::endl;
+}
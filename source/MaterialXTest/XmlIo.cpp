@@ -9,6 +9,8 @@
 #include <MaterialXFormat/File.h>
 #include <MaterialXFormat/XmlIo.h>
 
+#include <atomic>
+
 namespace mx = MaterialX;
 
 TEST_CASE("Load content", "[xmlio]")
@@ -261,3 +263,115 @@ TEST_CASE("Load content", "[xmlio]")
         REQUIRE(nullptr != parentDoc->getNodeDef("ND_TestMetal"));
     }
 }
+
+TEST_CASE("Write content", "[xmlio]")
+{
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph("NG_escape");
+    nodeGraph->setDocString("Quote \" amp & angle <tag> newline \n tab \t end");
+    mx::NodePtr constant = nodeGraph->addNode("constant", "constant1", "color3");
+    constant->setInputValue("value", mx::Color3(0.5f));
+    nodeGraph->addOutput("out", "color3")->setConnectedNode(constant);
+    nodeGraph->addNode("dot", "skipped", "float");
+    mx::NodeDefPtr nodeDef1 = doc->addNodeDef("ND_lib1", "float", "lib1");
+    nodeDef1->setSourceUri("libraries/lib.mtlx");
+    mx::NodeDefPtr nodeDef2 = doc->addNodeDef("ND_lib2", "float", "lib2");
+    nodeDef2->setSourceUri("libraries/lib.mtlx");
+    doc->addNodeDef("ND_empty", mx::MULTI_OUTPUT_TYPE_STRING, "empty");
+
+    // Verify the exact formatting of escaped attributes, XIncludes and
+    // filtered elements.
+    mx::XmlWriteOptions writeOptions;
+    writeOptions.elementPredicate = [](mx::ConstElementPtr elem)
+    {
+        return elem->getName() != "skipped";
+    };
+    const std::string expected =
+        "<?xml version=\"1.0\"?>\n"
+        "<materialx version=\"1.37\" xmlns:xi=\"http://www.w3.org/2001/XInclude\">\n"
+        "  <nodegraph name=\"NG_escape\" doc=\"Quote &quot; amp &amp; angle <tag> newline &#10; tab \t end\">\n"
+        "    <constant name=\"constant1\" type=\"color3\">\n"
+        "      <input name=\"value\" type=\"color3\" value=\"0.5, 0.5, 0.5\" />\n"
+        "    </constant>\n"
+        "    <output name=\"out\" type=\"color3\" nodename=\"constant1\" />\n"
+        "  </nodegraph>\n"
+        "  <xi:include href=\"libraries/lib.mtlx\" />\n"
+        "  <nodedef name=\"ND_empty\" node=\"empty\" />\n"
+        "</materialx>\n";
+    REQUIRE(mx::writeToXmlString(doc, &writeOptions) == expected);
+
+    // Verify that the written content reads back identically.  Note that
+    // literal tabs in attributes are normalized to spaces when read.
+    nodeGraph->setDocString("Quote \" amp & angle <tag> newline \n end");
+    writeOptions.writeXIncludeEnable = false;
+    writeOptions.elementPredicate = nullptr;
+    mx::DocumentPtr writtenDoc = mx::createDocument();
+    mx::readFromXmlString(writtenDoc, mx::writeToXmlString(doc, &writeOptions));
+    for (mx::ElementPtr elem : doc->traverseTree())
+    {
+        elem->setSourceUri(mx::EMPTY_STRING);
+    }
+    REQUIRE(*writtenDoc == *doc);
+    REQUIRE(mx::writeToXmlString(mx::createDocument()) == "<?xml version=\"1.0\"?>\n<materialx version=\"1.37\" />\n");
+}
+
+TEST_CASE("Parallel XIncludes", "[xmlio]")
+{
+    mx::FileSearchPath searchPath("libraries/stdlib");
+    mx::StringVec filenames =
+    {
+        "resources/Materials/TestSuite/libraries/sd/floor.mtlx",
+        "resources/Materials/Examples/StandardSurface/standard_surface_look_brass_tiled.mtlx",
+        "resources/Materials/Examples/Syntax/PostShaderComposite.mtlx"
+    };
+    for (const std::string& filename : filenames)
+    {
+        // Verify that concurrent reads of XIncludes match a serial read.
+        mx::XmlReadOptions readOptions;
+        mx::DocumentPtr serialDoc = mx::createDocument();
+        mx::readFromXmlFile(serialDoc, filename, searchPath, &readOptions);
+        readOptions.parallelXIncludes = true;
+        mx::DocumentPtr parallelDoc = mx::createDocument();
+        mx::readFromXmlFile(parallelDoc, filename, searchPath, &readOptions);
+        REQUIRE(*parallelDoc == *serialDoc);
+        REQUIRE(mx::writeToXmlString(parallelDoc) == mx::writeToXmlString(serialDoc));
+    }
+
+    // Verify that nested XIncludes are read serially.
+    std::atomic<bool> nestedParallel(false);
+    mx::XmlReadOptions nestedOptions;
+    nestedOptions.parallelXIncludes = true;
+    nestedOptions.readXIncludeFunction = [&nestedParallel](mx::DocumentPtr doc, const mx::FilePath& filename,
+                                                          const mx::FileSearchPath& searchPath, const mx::XmlReadOptions* options)
+    {
+        if (options->parallelXIncludes)
+        {
+            nestedParallel = true;
+        }
+        mx::readFromXmlFile(doc, filename, searchPath, options);
+    };
+    mx::DocumentPtr nestedDoc = mx::createDocument();
+    mx::readFromXmlFile(nestedDoc, filenames[0], searchPath, &nestedOptions);
+    REQUIRE(!nestedParallel);
+
+    // Verify that errors in concurrent reads are reported.
+    mx::XmlReadOptions readOptions;
+    readOptions.parallelXIncludes = true;
+    readOptions.readXIncludeFunction = [](mx::DocumentPtr doc, const mx::FilePath& filename,
+                                          const mx::FileSearchPath& searchPath, const mx::XmlReadOptions* options)
+    {
+        if (filename.getBaseName() == "missing.mtlx")
+        {
+            throw mx::ExceptionFileMissing("Failed to open file for reading: " + filename.asString());
+        }
+        mx::readFromXmlFile(doc, filename, searchPath, options);
+    };
+    mx::DocumentPtr doc = mx::createDocument();
+    const std::string xmlString =
+        "<?xml version=\"1.0\"?>\n"
+        "<materialx version=\"1.37\" xmlns:xi=\"http://www.w3.org/2001/XInclude\">\n"
+        "  <xi:include href=\"libraries/stdlib/stdlib_defs.mtlx\" />\n"
+        "  <xi:include href=\"missing.mtlx\" />\n"
+        "</materialx>\n";
+    REQUIRE_THROWS_AS(mx::readFromXmlString(doc, xmlString, &readOptions), mx::ExceptionFileMissing&);
+}
@@ -12,7 +12,7 @@ namespace mx = MaterialX;
 
 void bindPyDocument(py::module& mod)
 {
-    mod.def("createDocument", &mx::createDocument);
+    mod.def("createDocument", &mx::createDocument, py::arg("useArena") = false);
 
     py::class_<mx::Document, mx::DocumentPtr, mx::GraphElement>(mod, "Document")
         .def("initialize", &mx::Document::initialize)
@@ -20,6 +20,11 @@ void bindPyDocument(py::module& mod)
         .def("importLibrary", &mx::Document::importLibrary,
             py::arg("library"), py::arg("copyOptions") = (const mx::CopyOptions*) nullptr)
         .def("getReferencedSourceUris", &mx::Document::getReferencedSourceUris)
+        .def("setDataLibrary", &mx::Document::setDataLibrary)
+        .def("getDataLibrary", &mx::Document::getDataLibrary)
+        .def("hasDataLibrary", &mx::Document::hasDataLibrary)
+        .def("isSharedDataLibrary", &mx::Document::isSharedDataLibrary)
+        .def("localizeElement", &mx::Document::localizeElement)
         .def("addNodeGraph", &mx::Document::addNodeGraph,
             py::arg("name") = mx::EMPTY_STRING)
         .def("getNodeGraph", &mx::Document::getNodeGraph)
@@ -93,6 +98,12 @@ void bindPyDocument(py::module& mod)
         .def("getUnitTypeDefs", &mx::Document::getUnitTypeDefs)
         .def("removeUnitTypeDef", &mx::Document::removeUnitTypeDef)
         .def("upgradeVersion", &mx::Document::upgradeVersion)
+        .def("validate", [](mx::Document& doc, unsigned int threadCount)
+            {
+                std::string message;
+                bool res = doc.validate(&message, threadCount);
+                return std::pair<bool, std::string>(res, message);
+            }, py::arg("threadCount") = 1)
         .def("setColorManagementSystem", &mx::Document::setColorManagementSystem)
         .def("hasColorManagementSystem", &mx::Document::hasColorManagementSystem)
         .def("getColorManagementSystem", &mx::Document::getColorManagementSystem)
@@ -30,9 +30,14 @@ void bindPyElement(py::module& mod)
         .def(py::init())
         .def_readwrite("skipConflictingElements", &mx::CopyOptions::skipConflictingElements);
 
+    py::class_<mx::Element::Attribute>(mod, "Attribute")
+        .def("getName", &mx::Element::Attribute::getName)
+        .def("getValue", &mx::Element::Attribute::getValue);
+
     py::class_<mx::Element, mx::ElementPtr>(mod, "Element")
         .def(py::self == py::self)
         .def(py::self != py::self)
+        .def("getContentHash", &mx::Element::getContentHash)
         .def("setCategory", &mx::Element::setCategory)
         .def("getCategory", &mx::Element::getCategory)
         .def("setName", &mx::Element::setName)
@@ -83,6 +88,7 @@ void bindPyElement(py::module& mod)
         .def("setAttribute", &mx::Element::setAttribute)
         .def("hasAttribute", &mx::Element::hasAttribute)
         .def("getAttribute", &mx::Element::getAttribute)
+        .def("getAttributes", &mx::Element::getAttributes)
         .def("getAttributeNames", &mx::Element::getAttributeNames)
         .def("removeAttribute", &mx::Element::removeAttribute)
         .def("getSelf", static_cast<mx::ElementPtr (mx::Element::*)()>(&mx::Element::getSelf))
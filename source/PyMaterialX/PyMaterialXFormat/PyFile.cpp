@@ -39,10 +39,12 @@ void bindPyFile(py::module& mod)
         .def("getExtension", &mx::FilePath::getExtension)
         .def("exists", &mx::FilePath::exists)
         .def("isDirectory", &mx::FilePath::isDirectory)
+        .def("getModificationTime", &mx::FilePath::getModificationTime)
         .def("getFilesInDirectory", &mx::FilePath::getFilesInDirectory)
         .def("getSubDirectories", &mx::FilePath::getSubDirectories)
         .def("createDirectory", &mx::FilePath::createDirectory)
-        .def_static("getCurrentPath", &mx::FilePath::getCurrentPath);
+        .def_static("getCurrentPath", &mx::FilePath::getCurrentPath)
+        .def_static("getTempPath", &mx::FilePath::getTempPath);
 
     py::class_<mx::FileSearchPath>(mod, "FileSearchPath")
         .def(py::init<>())
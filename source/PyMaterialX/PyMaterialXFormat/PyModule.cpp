@@ -9,6 +9,7 @@ namespace py = pybind11;
 
 void bindPyFile(py::module& mod);
 void bindPyXmlIo(py::module& mod);
+void bindPyBinaryIo(py::module& mod);
 
 PYBIND11_MODULE(PyMaterialXFormat, mod)
 {
@@ -16,4 +17,5 @@ PYBIND11_MODULE(PyMaterialXFormat, mod)
 
     bindPyFile(mod);
     bindPyXmlIo(mod);
+    bindPyBinaryIo(mod);
 }
@@ -16,7 +16,8 @@ void bindPyXmlIo(py::module& mod)
     py::class_<mx::XmlReadOptions, mx::CopyOptions>(mod, "XmlReadOptions")
         .def(py::init())
         .def_readwrite("readXIncludeFunction", &mx::XmlReadOptions::readXIncludeFunction)
-        .def_readwrite("parentXIncludes", &mx::XmlReadOptions::parentXIncludes);
+        .def_readwrite("parentXIncludes", &mx::XmlReadOptions::parentXIncludes)
+        .def_readwrite("parallelXIncludes", &mx::XmlReadOptions::parallelXIncludes);
 
     py::class_<mx::XmlWriteOptions>(mod, "XmlWriteOptions")
         .def(py::init())
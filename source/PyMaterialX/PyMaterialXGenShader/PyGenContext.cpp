@@ -13,11 +13,36 @@ namespace mx = MaterialX;
 
 void bindPyGenContext(py::module& mod)
 {
+    py::class_<mx::ShaderNodeImplCache, mx::ShaderNodeImplCachePtr>(mod, "ShaderNodeImplCache")
+        .def_static("create", &mx::ShaderNodeImplCache::create)
+        .def("size", &mx::ShaderNodeImplCache::size)
+        .def("clear", &mx::ShaderNodeImplCache::clear);
+
+    py::class_<mx::GenProfiler, mx::GenProfilerPtr>(mod, "GenProfiler")
+        .def_static("create", &mx::GenProfiler::create)
+        .def("incrementCounter", &mx::GenProfiler::incrementCounter,
+            py::arg("name"), py::arg("amount") = 1)
+        .def("getCounter", &mx::GenProfiler::getCounter)
+        .def("getCounters", &mx::GenProfiler::getCounters)
+        .def("getEventCount", &mx::GenProfiler::getEventCount)
+        .def("getTotalTime", &mx::GenProfiler::getTotalTime)
+        .def("writeChromeTrace", static_cast<void (mx::GenProfiler::*)(const mx::FilePath&) const>(&mx::GenProfiler::writeChromeTrace))
+        .def("clear", &mx::GenProfiler::clear)
+        .def_readonly_static("NODES", &mx::GenProfiler::NODES)
+        .def_readonly_static("INCLUDE_FILES", &mx::GenProfiler::INCLUDE_FILES)
+        .def_readonly_static("BYTES_EMITTED", &mx::GenProfiler::BYTES_EMITTED)
+        .def_readonly_static("IMPL_CACHE_HITS", &mx::GenProfiler::IMPL_CACHE_HITS)
+        .def_readonly_static("IMPL_CACHE_MISSES", &mx::GenProfiler::IMPL_CACHE_MISSES);
+
     py::class_<mx::GenContext, mx::GenContextPtr>(mod, "GenContext")
         .def(py::init<mx::ShaderGeneratorPtr>())
         .def("getShaderGenerator", &mx::GenContext::getShaderGenerator)
         .def("getOptions", static_cast<mx::GenOptions& (mx::GenContext::*)()>(&mx::GenContext::getOptions), py::return_value_policy::reference)
         .def("registerSourceCodeSearchPath", static_cast<void (mx::GenContext::*)(const mx::FilePath&)>(&mx::GenContext::registerSourceCodeSearchPath))
         .def("registerSourceCodeSearchPath", static_cast<void (mx::GenContext::*)(const mx::FileSearchPath&)>(&mx::GenContext::registerSourceCodeSearchPath))
-        .def("resolveSourceFile", &mx::GenContext::resolveSourceFile);
+        .def("resolveSourceFile", &mx::GenContext::resolveSourceFile)
+        .def("setNodeImplementationCache", &mx::GenContext::setNodeImplementationCache)
+        .def("getNodeImplementationCache", &mx::GenContext::getNodeImplementationCache)
+        .def("setProfiler", &mx::GenContext::setProfiler)
+        .def("getProfiler", &mx::GenContext::getProfiler);
 }
@@ -10,6 +10,8 @@ namespace py = pybind11;
 void bindPyColorManagement(py::module& mod);
 void bindPyShaderPort(py::module& mod);
 void bindPyShader(py::module& mod);
+void bindPyShaderCache(py::module& mod);
+void bindPyShaderChangeObserver(py::module& mod);
 void bindPyShaderGenerator(py::module& mod);
 void bindPyGenContext(py::module& mod);
 void bindPyHwShaderGenerator(py::module& mod);
@@ -27,6 +29,8 @@ PYBIND11_MODULE(PyMaterialXGenShader, mod)
     bindPyColorManagement(mod);
     bindPyShaderPort(mod);
     bindPyShader(mod);
+    bindPyShaderCache(mod);
+    bindPyShaderChangeObserver(mod);
     bindPyShaderGenerator(mod);
     bindPyGenContext(mod);
     bindPyHwShaderGenerator(mod);
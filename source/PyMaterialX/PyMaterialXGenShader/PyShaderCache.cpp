@@ -0,0 +1,25 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <PyMaterialX/PyMaterialX.h>
+
+#include <MaterialXGenShader/GenContext.h>
+#include <MaterialXGenShader/Shader.h>
+#include <MaterialXGenShader/ShaderCache.h>
+
+namespace py = pybind11;
+namespace mx = MaterialX;
+
+void bindPyShaderCache(py::module& mod)
+{
+    py::class_<mx::ShaderCache, mx::ShaderCachePtr>(mod, "ShaderCache")
+        .def_static("create", &mx::ShaderCache::create)
+        .def("getDirectory", &mx::ShaderCache::getDirectory)
+        .def("generate", &mx::ShaderCache::generate)
+        .def("computeKey", &mx::ShaderCache::computeKey)
+        .def("read", &mx::ShaderCache::read)
+        .def("write", &mx::ShaderCache::write)
+        .def("clear", &mx::ShaderCache::clear);
+}
@@ -0,0 +1,39 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <PyMaterialX/PyMaterialX.h>
+
+#include <MaterialXGenShader/Shader.h>
+#include <MaterialXGenShader/ShaderChangeObserver.h>
+
+namespace py = pybind11;
+namespace mx = MaterialX;
+
+void bindPyShaderChangeObserver(py::module& mod)
+{
+    py::enum_<mx::ShaderChangeType>(mod, "ShaderChangeType")
+        .value("SHADER_CHANGE_NONE", mx::ShaderChangeType::SHADER_CHANGE_NONE)
+        .value("SHADER_CHANGE_UNIFORM", mx::ShaderChangeType::SHADER_CHANGE_UNIFORM)
+        .value("SHADER_CHANGE_REGENERATE", mx::ShaderChangeType::SHADER_CHANGE_REGENERATE)
+        .export_values();
+
+    py::class_<mx::ShaderChange>(mod, "ShaderChange")
+        .def(py::init<mx::ShaderChangeType>(), py::arg("type") = mx::SHADER_CHANGE_NONE)
+        .def_readwrite("type", &mx::ShaderChange::type)
+        .def_readwrite("path", &mx::ShaderChange::path)
+        .def_readwrite("value", &mx::ShaderChange::value);
+
+    py::class_<mx::ShaderChangeObserver, mx::ShaderChangeObserverPtr, mx::Observer>(mod, "ShaderChangeObserver")
+        .def_static("create", &mx::ShaderChangeObserver::create)
+        .def("getShader", &mx::ShaderChangeObserver::getShader)
+        .def("classifySetAttribute", &mx::ShaderChangeObserver::classifySetAttribute)
+        .def("classifyRemoveAttribute", &mx::ShaderChangeObserver::classifyRemoveAttribute)
+        .def("classifyAddElement", &mx::ShaderChangeObserver::classifyAddElement)
+        .def("classifyRemoveElement", &mx::ShaderChangeObserver::classifyRemoveElement)
+        .def("classifyContentChange", &mx::ShaderChangeObserver::classifyContentChange)
+        .def("getChanges", &mx::ShaderChangeObserver::getChanges)
+        .def("requiresRegeneration", &mx::ShaderChangeObserver::requiresRegeneration)
+        .def("clearChanges", &mx::ShaderChangeObserver::clearChanges);
+}
@@ -89,5 +89,6 @@ void bindPyUnitConverters(py::module& mod)
         .def("addUnitConverter", &mx::UnitConverterRegistry::addUnitConverter)
         .def("removeUnitConverter", &mx::UnitConverterRegistry::removeUnitConverter)
         .def("getUnitConverter", &mx::UnitConverterRegistry::getUnitConverter)
-        .def("clearUnitConverters", &mx::UnitConverterRegistry::clearUnitConverters);
+        .def("clearUnitConverters", &mx::UnitConverterRegistry::clearUnitConverters)
+        .def("getUnitConverters", &mx::UnitConverterRegistry::getUnitConverters);
 }
@@ -6,6 +6,8 @@
 #include <PyMaterialX/PyMaterialX.h>
 
 #include <MaterialXGenShader/Util.h>
+#include <MaterialXGenShader/GenContext.h>
+#include <MaterialXGenShader/Shader.h>
 #include <MaterialXGenShader/ShaderGenerator.h>
 
 namespace py = pybind11;
@@ -14,4 +16,12 @@ namespace mx = MaterialX;
 void bindPyUtil(py::module& mod)
 {
     mod.def("isTransparentSurface", &mx::isTransparentSurface);
+    mod.def("generateBatch", [](const std::vector<mx::TypedElementPtr>& elements, const mx::GenContext& context,
+                                unsigned int threadCount)
+        {
+            mx::StringVec errors;
+            std::vector<mx::ShaderPtr> shaders = mx::generateBatch(elements, context, threadCount, &errors);
+            return std::make_pair(shaders, errors);
+        },
+        py::arg("elements"), py::arg("context"), py::arg("threadCount") = 0);
 }
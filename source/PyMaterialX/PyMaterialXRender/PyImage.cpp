@@ -14,20 +14,45 @@ void bindPyImage(py::module& mod)
 {
     py::class_<mx::ImageBufferDeallocator>(mod, "ImageBufferDeallocator");
 
-    py::class_<mx::Image>(mod, "Image")
+    py::class_<mx::Image, mx::ImagePtr> image(mod, "Image");
+
+    py::enum_<mx::Image::BaseType>(image, "BaseType")
+        .value("UINT8", mx::Image::BaseType::UINT8)
+        .value("HALF", mx::Image::BaseType::HALF)
+        .value("FLOAT", mx::Image::BaseType::FLOAT)
+        .export_values();
+
+    py::enum_<mx::Image::CompressionFormat>(image, "CompressionFormat")
+        .value("NONE", mx::Image::CompressionFormat::NONE)
+        .value("BC1", mx::Image::CompressionFormat::BC1)
+        .value("BC4", mx::Image::CompressionFormat::BC4)
+        .value("BC5", mx::Image::CompressionFormat::BC5)
+        .export_values();
+
+    image
         .def_static("create", &mx::Image::create)
         .def_static("createConstantColor", &mx::Image::createConstantColor)
         .def("getWidth", &mx::Image::getWidth)
         .def("getHeight", &mx::Image::getHeight)
         .def("getChannelCount", &mx::Image::getChannelCount)
         .def("getBaseType", &mx::Image::getBaseType)
+        .def("getCompressionFormat", &mx::Image::getCompressionFormat)
+        .def("isCompressed", &mx::Image::isCompressed)
         .def("getBaseStride", &mx::Image::getBaseStride)
         .def("getMaxMipCount", &mx::Image::getMaxMipCount)
+        .def("getResourceBufferSize", &mx::Image::getResourceBufferSize)
         .def("setResourceBuffer", &mx::Image::setResourceBuffer)
         .def("getResourceBuffer", &mx::Image::getResourceBuffer)
         .def("createResourceBuffer", &mx::Image::createResourceBuffer)
         .def("releaseResourceBuffer", &mx::Image::releaseResourceBuffer)
         .def("setResourceBufferDeallocator", &mx::Image::setResourceBufferDeallocator)
         .def("getResourceBufferDeallocator", &mx::Image::getResourceBufferDeallocator)
-        .def("getTexelColor", &mx::Image::getTexelColor);
+        .def("getTexelColor", &mx::Image::getTexelColor)
+        .def("setTexelColor", &mx::Image::setTexelColor)
+        .def("convert", &mx::Image::convert)
+        .def("compress", &mx::Image::compress)
+        .def("decompress", &mx::Image::decompress)
+        .def("generateMips", &mx::Image::generateMips)
+        .def("getMips", &mx::Image::getMips)
+        .def("clearMips", &mx::Image::clearMips);
 }
@@ -95,6 +95,14 @@ void bindPyImageHandler(py::module& mod)
         .def_readwrite("filterType", &mx::ImageSamplingProperties::filterType)
         .def_readwrite("defaultColor", &mx::ImageSamplingProperties::defaultColor);
 
+    py::class_<mx::ImageCacheStatistics>(mod, "ImageCacheStatistics")
+        .def_readonly("hits", &mx::ImageCacheStatistics::hits)
+        .def_readonly("misses", &mx::ImageCacheStatistics::misses)
+        .def_readonly("evictions", &mx::ImageCacheStatistics::evictions)
+        .def_readonly("imageCount", &mx::ImageCacheStatistics::imageCount)
+        .def_readonly("byteCount", &mx::ImageCacheStatistics::byteCount)
+        .def_readonly("pendingByteCount", &mx::ImageCacheStatistics::pendingByteCount);
+
     py::class_<mx::ImageLoader, PyImageLoader, mx::ImageLoaderPtr>(mod, "ImageLoader")
         .def_readonly_static("BMP_EXTENSION", &mx::ImageLoader::BMP_EXTENSION)
         .def_readonly_static("EXR_EXTENSION", &mx::ImageLoader::EXR_EXTENSION)
@@ -123,5 +131,16 @@ void bindPyImageHandler(py::module& mod)
         .def("bindImage", &mx::ImageHandler::bindImage)
         .def("unbindImage", &mx::ImageHandler::unbindImage)
         .def("setSearchPath", &mx::ImageHandler::setSearchPath)
-        .def("getSearchPath", &mx::ImageHandler::getSearchPath);
+        .def("getSearchPath", &mx::ImageHandler::getSearchPath)
+        .def("setCacheBudget", &mx::ImageHandler::setCacheBudget)
+        .def("getCacheBudget", &mx::ImageHandler::getCacheBudget)
+        .def("setImagePinned", &mx::ImageHandler::setImagePinned)
+        .def("isImagePinned", &mx::ImageHandler::isImagePinned)
+        .def("getCacheStatistics", &mx::ImageHandler::getCacheStatistics)
+        .def("resetCacheStatistics", &mx::ImageHandler::resetCacheStatistics)
+        .def("prefetchImages", [](mx::ImageHandler& handler, const mx::FilePathVec& filePaths)
+        {
+            handler.prefetchImages(filePaths);
+        })
+        .def("getPendingImageCount", &mx::ImageHandler::getPendingImageCount);
 }
@@ -16,5 +16,7 @@ void bindPyStbImageLoader(py::module& mod)
         .def_static("create", &mx::StbImageLoader::create)
         .def(py::init<>())
         .def("saveImage", &mx::StbImageLoader::saveImage)
-        .def("loadImage", &mx::StbImageLoader::loadImage);
+        .def("loadImage", &mx::StbImageLoader::loadImage)
+        .def("setHdrBaseType", &mx::StbImageLoader::setHdrBaseType)
+        .def("getHdrBaseType", &mx::StbImageLoader::getHdrBaseType);
 }